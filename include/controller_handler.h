@@ -1,15 +1,28 @@
-#ifndef MIDI_HANDLER_H
-#define MIDI_HANDLER_H
+#ifndef CONTROLLER_HANDLER_H
+#define CONTROLLER_HANDLER_H
 
 #include <vector>
 #include <chrono>
+#include <atomic>
 #include <iostream>           // For std::cout and std::cerr
 #include "input_reader_base.h"  // For matrix button checking functions
 #include "input_reader_knob.h"  // For knob input reading
 #include "input_reader_fader.h" // For fader input reading
 #include "input_reader_wheel.h"
+#include "controller_state_shm.h"
+#include "daemon_server.h"
+#include "event_reactor.h"
 #include "led_controller_base.h"
 #include "led_controller_display.h"
+#include "led_frame_encoder.h"
+#include "led_output_writer.h"
+#include "led_animation.h"
+#include "led_scene_cache.h"
+#include "led_layers.h"
+#include "led_reflex.h"
+#include "midi_handler.h"
+#include "osc_handler.h"
+#include "realtime_mode.h"
 #include "startup_sequence.h"
 
 
@@ -17,6 +30,9 @@
 const unsigned short VENDOR_ID = 0x17cc;
 const unsigned short PRODUCT_ID = 0x1120;
 
+// Default input polling period of runEventLoop() when the device has no hidraw node
+const int EVENT_LOOP_INPUT_POLL_MS = 1;
+
 // =============================================================================
 // STATE TRACKING STRUCTURES
 // =============================================================================
@@ -52,6 +68,12 @@ struct AnalogControlState {
     }
 };
 
+// Startup timing in milliseconds since the constructor started (-1 = not yet)
+struct StartupTiming {
+    double constructor_ms;      // Until the constructor returned
+    double first_event_ms;      // Until run() processed the first input report
+};
+
 class ControllerDelegate {
 public:
     virtual void onButtonPress(int index) = 0;
@@ -82,6 +104,41 @@ private:
     FaderInputReader fader_input_reader;
     // Declare display controller
     DisplayController display_controller;
+    // Declare LED writer thread (owns hid_write for LED reports)
+    LEDOutputWriter led_writer;
+    // Declare LED animation engine (fixed tick, one report per tick)
+    LEDAnimationEngine animation_engine;
+    // Startup wave playing in the background (0 = none)
+    std::atomic<int> startup_animation_id;
+    std::chrono::steady_clock::time_point construct_time;
+    StartupTiming startup_timing;
+    // Declare per-page LED scenes (opt-in, see enablePageScenes())
+    LEDSceneCache scene_cache;
+    std::atomic<bool> page_scenes_enabled;
+    // Declare driver-side press echo (FEEDBACK layer)
+    LEDReflexTable reflex_table;
+    // Declare MIDI ports (opt-in, see enableMIDI())
+    MidiHandler midi_handler;
+    // Declare OSC endpoint (opt-in, see enableOSC())
+    OSCHandler osc_handler;
+    // Declare shared memory state snapshot (opt-in, see enableStateSharing())
+    ControllerStatePublisher state_publisher;
+    ControllerStateData shared_state;
+    // Declare local event daemon (opt-in, see enableDaemon())
+    DaemonServer daemon_server;
+    // Declare single-threaded event loop (opt-in, see runEventLoop())
+    EventReactor reactor;
+    std::atomic<bool> event_loop_stop;
+    int hid_notify_fd;                      // Second handle on the hidraw node, only for readiness
+
+    bool cancelStartupAnimation();
+    static void onExternalLEDCommand(void* user_data);
+    void activatePageScene();
+    void publishState(const unsigned char* input_buffer, WheelDirection wheel_direction);
+    void processPendingInput();
+    static void onReactorHID(int fd, uint32_t events, void* user_data);
+    static void onReactorInputPoll(int fd, uint32_t count, void* user_data);
+    static void onReactorTick(int fd, uint32_t count, void* user_data);
 
     
 public:
@@ -102,12 +159,58 @@ public:
     void sendFaderChange(int fader_number, int value);
     void setDelegate(ControllerDelegate *delegate);
     bool run();
+    bool runEventLoop(int input_poll_ms = EVENT_LOOP_INPUT_POLL_MS);
+    void stopEventLoop();
+    EventReactorStats getEventLoopStats() const;
+    RealtimeStatus enableRealtime(const RealtimeConfig& config = RealtimeConfig());
     void close();
     void setStopButton(int index, float brightness);
     void setMatrixButton(int row, int col, LEDColor color, float brightness = 1.0);
     void setMatrixButton(int row, int col, BRGColor color, float brightness = 1.0);
     void setButton(LEDButton button, float brightness);
     void setPage(int page);
+    void setDisplayText(char left, char right);
+    void setDisplayHex(uint8_t code);
+    void setDisplayValue(int value, int step_ms = DISPLAY_SCROLL_DEFAULT_STEP_MS, int repeat = 0);
+    void scrollDisplayText(const std::string& text, int step_ms = DISPLAY_SCROLL_DEFAULT_STEP_MS, int repeat = 0);
+    bool flush();
+    void beginFrame();
+    bool commitFrame();
+    int playAnimation(const LEDAnimation& animation);
+    void cancelAnimation(int id);
+    StartupTiming getStartupTiming() const;
+    void setFlushPolicy(LEDFlushPolicy policy, int max_frame_rate = 0);
+    void setLEDFrameRate(int frame_rate);
+    void setLEDRefreshInterval(int refresh_ms);
+    void setBrightnessCurve(LEDGroup group, LEDBrightnessCurve curve, float gamma = 2.2f);
+    void setDithering(LEDGroup group, bool enabled);
+    int getDitherFrameRate() const;
+    void enablePageScenes(bool enabled);
+    void setPageMatrixButton(int page, int row, int col, LEDColor color, float brightness = 1.0);
+    void setPageButton(int page, LEDButton button, float brightness);
+    void setPageStopButton(int page, int index, float brightness);
+    void setLayerMatrixButton(LEDLayer layer, int row, int col, LEDColor color, float brightness = 1.0);
+    void setLayerButton(LEDLayer layer, LEDButton button, float brightness);
+    void setLayerStopButton(LEDLayer layer, int index, float brightness);
+    void clearLayer(LEDLayer layer);
+    void setLayerOpacity(LEDLayer layer, float opacity);
+    void setLayerBlendMode(LEDLayer layer, LEDBlendMode mode);
+    void setMatrixReflex(int row, int col, LEDReflex reflex);
+    void setButtonReflex(LEDButton button, LEDReflex reflex);
+    void setStopReflex(int index, LEDReflex reflex);
+    void clearReflexes();
+    void setMatrixButtonMode(int row, int col, LEDMode mode, float rate_hz = 2.0f, float phase = 0.0f, LEDModeSync sync = LEDModeSync::TIME);
+    void setButtonMode(LEDButton button, LEDMode mode, float rate_hz = 2.0f, float phase = 0.0f, LEDModeSync sync = LEDModeSync::TIME);
+    void setStopButtonMode(int index, LEDMode mode, float rate_hz = 2.0f, float phase = 0.0f, LEDModeSync sync = LEDModeSync::TIME);
+    bool enableMIDI(bool open_ports = true);
+    bool loadMIDILEDMap(const std::string& path);
+    void setMIDIAnalogMode(int control, MidiAnalogMode mode);
+    LEDLatencyStats getMIDILatency() const;
+    MidiClockStats getMIDIClockStats() const;
+    bool enableOSC(int listen_port = OSC_DEFAULT_LISTEN_PORT, int send_port = OSC_DEFAULT_SEND_PORT);
+    bool enableStateSharing(const std::string& name = CONTROLLER_STATE_SHM_NAME);
+    bool enableDaemon(const std::string& path = DAEMON_SOCKET_PATH, const std::string& group = "");
+    std::vector<DaemonClientStats> getDaemonClientStats();
 };
 
-#endif // MIDI_HANDLER_H
+#endif // CONTROLLER_HANDLER_H
@@ -0,0 +1,102 @@
+#ifndef CONTROLLER_STATE_SHM_H
+#define CONTROLLER_STATE_SHM_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// =============================================================================
+// CONSTANTS - Shared memory segment
+// =============================================================================
+
+const char CONTROLLER_STATE_SHM_NAME[] = "/f1_controller_state";
+const uint32_t CONTROLLER_STATE_MAGIC = 0x46315354;     // "F1ST"
+const uint32_t CONTROLLER_STATE_VERSION = 1;
+const int CONTROLLER_STATE_READ_ATTEMPTS = 64;          // Retries while the driver is mid-update
+
+// Bits of ControllerStateData::buttons
+const int CONTROLLER_STATE_MATRIX_BIT = 0;      // Matrix pads, bit row * 4 + col (0-15)
+const int CONTROLLER_STATE_SPECIAL_BIT = 16;    // Special inputs in input report order (16-24):
+                                                // SHIFT, REVERSE, TYPE, SIZE, BROWSE, WHEEL press, SYNC, QUANT, CAPTURE
+const int CONTROLLER_STATE_STOP_BIT = 25;       // Stop buttons 1-4 (25-28)
+
+// =============================================================================
+// CONTROLLER STATE - Decoded state of all controls after one input report
+// =============================================================================
+
+/*
+* Plain data with a fixed layout, so readers in other processes (and other
+* languages) can map it. Times are CLOCK_MONOTONIC (steady clock) and wall
+* clock nanoseconds.
+*/
+struct ControllerStateData {
+    uint64_t report_count;          // Input reports published so far
+    int64_t report_time_ns;         // Steady clock time the report was read
+    int64_t report_wall_time_ns;    // Wall clock time the report was read (Unix epoch)
+    uint32_t buttons;               // Pressed buttons, see CONTROLLER_STATE_*_BIT
+    int32_t wheel_position;         // Wheel steps since start, +1 per clockwise step
+    int32_t page;                   // Current effect page (1-99)
+    uint16_t analog[8];             // Raw 12-bit values: knobs 1-4, then faders 1-4
+    uint32_t reserved;
+};
+
+// The data is copied as 64-bit words so readers never race on plain memory
+const int CONTROLLER_STATE_WORDS = sizeof(ControllerStateData) / sizeof(uint64_t);
+static_assert(sizeof(ControllerStateData) % sizeof(uint64_t) == 0, "ControllerStateData must be a whole number of words");
+
+/*
+* Layout of the segment
+*
+* sequence is a seqlock: odd while the driver writes, incremented again when
+* the data is complete. A reader copies the data and retries if the
+* sequence was odd or changed meanwhile, no syscalls and no locks.
+*/
+struct ControllerStateSegment {
+    uint32_t magic;                 // CONTROLLER_STATE_MAGIC
+    uint32_t version;               // CONTROLLER_STATE_VERSION
+    uint32_t data_size;             // sizeof(ControllerStateData)
+    std::atomic<uint32_t> sequence;
+    std::atomic<uint64_t> words[CONTROLLER_STATE_WORDS];
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free,
+              "The seqlock needs address-free atomics to work across processes");
+
+// =============================================================================
+// CONTROLLER STATE PUBLISHER CLASS - The driver side, one writer
+// =============================================================================
+
+class ControllerStatePublisher {
+private:
+    ControllerStateSegment* segment;        // nullptr = not open
+    std::string name;
+
+public:
+    ControllerStatePublisher();
+    ~ControllerStatePublisher();
+
+    bool open(const std::string& name = CONTROLLER_STATE_SHM_NAME);
+    void close();
+    bool isOpen() const;
+    void publish(const ControllerStateData& data);
+};
+
+// =============================================================================
+// CONTROLLER STATE READER CLASS - Any number of local consumers
+// =============================================================================
+
+class ControllerStateReader {
+private:
+    const ControllerStateSegment* segment;  // nullptr = not open
+
+public:
+    ControllerStateReader();
+    ~ControllerStateReader();
+
+    bool open(const std::string& name = CONTROLLER_STATE_SHM_NAME);
+    void close();
+    bool isOpen() const;
+    bool read(ControllerStateData& data) const;
+};
+
+#endif // CONTROLLER_STATE_SHM_H
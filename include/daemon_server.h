@@ -0,0 +1,214 @@
+#ifndef DAEMON_SERVER_H
+#define DAEMON_SERVER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "event_reactor.h"
+#include "led_controller_base.h"
+#include "led_controller_display.h"
+
+// =============================================================================
+// CONSTANTS - Socket and buffers
+// =============================================================================
+
+const char DAEMON_SOCKET_PATH[] = "/tmp/f1_controller.sock";
+const unsigned int DAEMON_SOCKET_MODE = 0600;         // Owner only
+const unsigned int DAEMON_SOCKET_GROUP_MODE = 0660;   // Owner and the configured group
+const uint16_t DAEMON_PROTOCOL_VERSION = 1;
+const int DAEMON_MAX_CLIENTS = 32;
+const int DAEMON_CLIENT_BUFFER_EVENTS = 1024;   // Power of two, events a client may fall behind
+const int DAEMON_REPORT_MAX_EVENTS = 64;        // Events collected from one input report
+const int DAEMON_MAX_COMMANDS_PER_WAKEUP = 64;  // Commands read from one client per wakeup, the rest waits
+const int DAEMON_ANALOG_CONTROL_COUNT = 8;      // Knobs 0-3, faders 4-7
+const int DAEMON_ANALOG_DEADBAND = 2;           // Raw 12-bit steps ignored as ADC noise
+
+// =============================================================================
+// WIRE FORMAT - Fixed-size records in host byte order (local sockets only)
+// =============================================================================
+
+/*
+* Server -> client: 16-byte events. Events of one input report share
+* sequence and time_ns, the steady clock (CLOCK_MONOTONIC) time the report
+* was read, so a client can measure its own fan-out latency.
+*/
+enum class DaemonEventType : uint8_t {
+    HELLO = 0,              // On connect: index = client id, value = protocol version
+    MATRIX = 1,             // index = pad (row * 4 + col), value = pressed (0/1)
+    BUTTON = 2,             // index = special input (0-8, input report order), value = pressed
+    STOP = 3,               // index = stop button (0-3), value = pressed
+    ANALOG = 4,             // index = knob 0-3 / fader 4-7, value = raw 12-bit
+    WHEEL = 5,              // value = +1 clockwise, 0xFFFF (-1) counter-clockwise
+    PAGE = 6,               // value = current effect page
+    CLAIM_RESULT = 7,       // Reply to CLAIM/RELEASE: index = group, value = 1 granted, 0 denied
+    COMMAND_REJECTED = 8,   // index = command type, value = group (not owned or invalid)
+    OVERFLOW = 9            // The client fell behind, value = events it lost (max 65535)
+};
+
+struct DaemonEvent {
+    uint8_t type;           // DaemonEventType
+    uint8_t index;
+    uint16_t value;
+    uint32_t sequence;      // Input report number
+    int64_t time_ns;        // Report time, 0 for replies
+};
+
+/*
+* Client -> server: 8-byte commands. LED commands need the group to be
+* claimed first. A group has at most one owner, the owner keeps it until it
+* releases it or disconnects.
+*/
+enum class DaemonCommandType : uint8_t {
+    CLAIM = 1,              // index = DaemonLEDGroup
+    RELEASE = 2,            // index = DaemonLEDGroup
+    LED_MATRIX = 3,         // index = pad (row * 4 + col), color = LEDColor, level = 0-127
+    LED_BUTTON = 4,         // index = LEDButton, level = 0-127
+    LED_STOP = 5,           // index = stop button (0-3), level = 0-127
+    DISPLAY_VALUE = 6       // value = number shown (scrolls if it has more than two digits)
+};
+
+enum class DaemonLEDGroup : uint8_t {
+    MATRIX,
+    BUTTONS,
+    STOPS,
+    DISPLAY
+};
+
+const int DAEMON_LED_GROUP_COUNT = 4;
+
+struct DaemonCommand {
+    uint8_t type;           // DaemonCommandType
+    uint8_t index;
+    uint8_t color;
+    uint8_t level;
+    int32_t value;
+};
+
+static_assert(sizeof(DaemonEvent) == 16, "DaemonEvent is part of the wire format");
+static_assert(sizeof(DaemonCommand) == 8, "DaemonCommand is part of the wire format");
+
+// Per-client statistics, latency is report read -> event written to the socket
+struct DaemonClientStats {
+    int id;
+    uint64_t events_sent;
+    uint64_t events_dropped;        // Lost because the client's buffer was full
+    uint64_t commands_received;
+    uint64_t latency_samples;
+    double average_latency_us;
+    double max_latency_us;
+    double last_latency_us;
+};
+
+// =============================================================================
+// DAEMON SERVER CLASS - Event fan-out and LED commands over a Unix socket
+// =============================================================================
+
+/*
+* The input thread collects the events of a report (beginReport(), add*(),
+* endReport()) and copies them into every client's ring buffer, then tries a
+* non-blocking send. A client that does not keep up loses whole reports
+* (and is told with an OVERFLOW event), it never delays the other clients or
+* the input thread.
+*
+* A server thread accepts clients, sends what the input thread could not
+* and applies LED commands: all commands read in one wakeup make one LED
+* frame and one flush. With attachReactor() the reactor watches the sockets
+* instead of the server thread.
+*
+* Commands are read and checked with clients_mutex held, at most
+* DAEMON_MAX_COMMANDS_PER_WAKEUP per client, and painted after it is
+* released, so a client streaming commands never holds up endReport().
+*/
+class DaemonServer {
+private:
+    struct Client {
+        int fd;
+        int id;
+        DaemonEvent events[DAEMON_CLIENT_BUFFER_EVENTS];
+        uint32_t head;                  // Next event to fill
+        uint32_t tail;                  // Next event to send
+        int sent_bytes;                 // Bytes of the tail event already sent
+        uint8_t command_bytes[sizeof(DaemonCommand)];
+        int command_size;               // Bytes of a partial command
+        uint32_t lost_events;           // Not yet reported with OVERFLOW
+        DaemonClientStats stats;
+        double latency_sum_us;
+    };
+
+    std::string socket_path;
+    int listen_fd;                      // -1 = not serving
+    int wake_pipe[2];                   // Wakes the server thread (pending sends, cleanup)
+    DisplayController* display;
+    LEDCommandHook led_command_hook;    // Called before LED commands are painted, may be null
+    void* led_command_user_data;
+
+    std::unique_ptr<Client> clients[DAEMON_MAX_CLIENTS];
+    int owners[DAEMON_LED_GROUP_COUNT];     // Client id per group, 0 = free
+    int next_client_id;
+    std::mutex clients_mutex;           // Guards clients and owners, taken before the LED buffer lock
+
+    std::thread server_thread;
+    std::atomic<bool> running;
+    std::atomic<bool> thread_running;
+    EventReactor* reactor;              // Watches the sockets instead of the thread, guarded by clients_mutex
+
+    // Report being collected, input thread only
+    DaemonEvent report_events[DAEMON_REPORT_MAX_EVENTS];
+    int report_size;
+    std::atomic<uint32_t> report_sequence;  // Also read by the server thread for replies
+    int64_t report_time_ns;
+    int analog_raw[DAEMON_ANALOG_CONTROL_COUNT];
+
+    // Checked LED commands of one wakeup, server thread (or reactor) only
+    DaemonCommand pending_commands[DAEMON_MAX_CLIENTS * DAEMON_MAX_COMMANDS_PER_WAKEUP];
+    int pending_count;
+
+    // Helper functions
+    void addEvent(DaemonEventType type, int index, int value);
+    bool enqueue(Client& client, const DaemonEvent* events, int count);
+    bool sendPending(Client& client);
+    void acceptClient();
+    void removeClient(int slot);
+    bool readCommands(Client& client);
+    bool checkCommand(Client& client, const DaemonCommand& command);
+    void applyCommands(int64_t receive_ns);
+    bool handleClient(int slot, bool readable);
+    void wake();
+    void serverLoop();
+    void stopServerThread();
+    static void onReactorListen(int fd, uint32_t events, void* user_data);
+    static void onReactorClient(int fd, uint32_t events, void* user_data);
+
+public:
+    DaemonServer();
+    ~DaemonServer();
+
+    // Setup
+    bool start(const std::string& path = DAEMON_SOCKET_PATH, DisplayController* display = nullptr,
+               const std::string& group = "");
+    void stop();
+    bool isRunning() const;
+    bool attachReactor(EventReactor& reactor);
+    void detachReactor();
+    void setLEDCommandHook(LEDCommandHook hook, void* user_data);
+
+    // Input -> clients (call from the input thread)
+    void beginReport();
+    void addMatrixButton(int row, int col, bool pressed);
+    void addButton(int index, bool pressed);
+    void addStopButton(int index, bool pressed);
+    void addAnalogControl(int control, uint16_t raw_value);
+    void addWheel(bool clockwise);
+    void addPage(int page);
+    void endReport();
+
+    // Statistics
+    int getClientCount();
+    std::vector<DaemonClientStats> getClientStats();
+};
+
+#endif // DAEMON_SERVER_H
@@ -0,0 +1,109 @@
+#ifndef EVENT_REACTOR_H
+#define EVENT_REACTOR_H
+
+#include <atomic>
+#include <cstdint>
+
+// =============================================================================
+// CONSTANTS - Reactor limits
+// =============================================================================
+
+const int EVENT_REACTOR_MAX_WATCHES = 64;       // Descriptors one reactor can watch (preallocated)
+const int EVENT_REACTOR_MAX_EVENTS = 32;        // Events dispatched per wait
+
+// Event bits passed to callbacks (same values as EPOLLIN/EPOLLOUT/EPOLLERR/EPOLLHUP)
+const uint32_t EVENT_READABLE = 0x001;
+const uint32_t EVENT_WRITABLE = 0x004;
+const uint32_t EVENT_ERROR = 0x008;
+const uint32_t EVENT_HANGUP = 0x010;
+
+#ifdef __linux__
+const bool EVENT_REACTOR_SUPPORTED = true;
+#else
+const bool EVENT_REACTOR_SUPPORTED = false;     // epoll, timerfd and eventfd are Linux only
+#endif
+
+/*
+* Called on the reactor thread
+*
+* @param fd: Descriptor that is ready
+* @param events: EVENT_* bits for descriptors, for timers the number of
+*                expirations since the last call (> 1 = ticks were missed),
+*                for notifiers the number of notify() calls (coalesced)
+* @param user_data: Pointer given when the descriptor was added
+*/
+typedef void (*EventCallback)(int fd, uint32_t events, void* user_data);
+
+struct EventReactorStats {
+    uint64_t wakeups;               // Returns from epoll_wait()
+    uint64_t events_dispatched;     // Callbacks made
+    uint64_t timer_overruns;        // Timer expirations that were not handled in time
+};
+
+// =============================================================================
+// EVENT REACTOR CLASS - One thread waiting on all descriptors (epoll)
+// =============================================================================
+
+/*
+* Watches descriptors, timers (timerfd) and notifiers (eventfd) in one epoll
+* set and calls back on the thread that runs run(). Callbacks run one after
+* the other in the order epoll reports them, so they need no locks among
+* each other. Watches live in a fixed table, adding and removing them
+* (also from a callback) never allocates.
+*
+* Only stop() and notify() may be called from other threads.
+*/
+class EventReactor {
+private:
+    struct Watch {
+        int fd;                 // -1 = free slot
+        uint32_t generation;    // Bumped on removal, stale events are skipped
+        uint32_t interest;      // EVENT_READABLE / EVENT_WRITABLE currently watched
+        bool counter;           // Timer or notifier: read the count before calling back
+        bool owned;             // Created by the reactor, closed on removal
+        EventCallback callback;
+        void* user_data;
+    };
+
+    int epoll_fd;               // -1 = closed
+    int stop_fd;                // Notifier that ends run()
+    Watch watches[EVENT_REACTOR_MAX_WATCHES];
+    std::atomic<bool> stop_requested;
+    std::atomic<uint64_t> wakeups;
+    std::atomic<uint64_t> events_dispatched;
+    std::atomic<uint64_t> timer_overruns;
+
+    // Helper functions
+    Watch* findWatch(int fd);
+    bool addWatch(int fd, uint32_t interest, bool counter, bool owned, EventCallback callback, void* user_data);
+
+public:
+    EventReactor();
+    ~EventReactor();
+
+    // Setup
+    bool open();
+    void close();
+    bool isOpen() const;
+
+    // Descriptors owned by the caller
+    bool addReader(int fd, EventCallback callback, void* user_data);
+    bool setWriteInterest(int fd, bool enabled);
+    void remove(int fd);
+
+    // Descriptors owned by the reactor (removed and closed with remove())
+    int addTimer(int interval_ms, EventCallback callback, void* user_data);
+    bool setTimerInterval(int fd, int interval_ms);
+    int addNotifier(EventCallback callback, void* user_data);
+    static void notify(int fd);
+
+    // Dispatch
+    int runOnce(int timeout_ms);
+    void run();
+    void stop();
+
+    // Statistics
+    EventReactorStats getStats() const;
+};
+
+#endif // EVENT_REACTOR_H
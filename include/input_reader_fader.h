@@ -45,7 +45,7 @@ public:
     void updateFaderStates(const unsigned char* buffer);  // ==== UNUSED ====
     
     // Utility functions
-    uint16_t getRawFaderValue(const unsigned char* buffer, int fader_number);  // ==== UNUSED ====
+    uint16_t getRawFaderValue(const unsigned char* buffer, int fader_number);
     void printFaderValues(const unsigned char* buffer);
 };
 
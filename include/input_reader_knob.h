@@ -46,7 +46,7 @@ public:
     void updateKnobStates(const unsigned char* buffer); // ==== UNUSED ====
 
     // Debug/utility functions
-    uint16_t getRawKnobValue(const unsigned char* buffer, int knob_number); // ==== UNUSED ====
+    uint16_t getRawKnobValue(const unsigned char* buffer, int knob_number);
     void printKnobValues(const unsigned char* buffer);
 
 };
@@ -0,0 +1,139 @@
+#ifndef LED_ANIMATION_H
+#define LED_ANIMATION_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "led_controller_base.h"
+
+// =============================================================================
+// CONSTANTS - Animation timing
+// =============================================================================
+
+const int LED_ANIMATION_DEFAULT_TICK_MS = 10;    // 100 ticks per second
+
+// =============================================================================
+// ANIMATION TARGETS - Which LED an animation drives
+// =============================================================================
+
+enum class LEDTargetType {
+    MATRIX,      // Matrix pad, index = row * 4 + col (0-15)
+    BUTTON,      // Special/control button, index = (int)LEDButton
+    STOP         // Stop button, index 0-3
+};
+
+struct LEDTarget {
+    LEDTargetType type;
+    int index;
+};
+
+constexpr LEDTarget matrixTarget(int row, int col) { return {LEDTargetType::MATRIX, row * MATRIX_COLS + col}; }
+constexpr LEDTarget buttonTarget(LEDButton button) { return {LEDTargetType::BUTTON, (int)button}; }
+constexpr LEDTarget stopTarget(int index) { return {LEDTargetType::STOP, index}; }
+
+// =============================================================================
+// ANIMATION DEFINITIONS
+// =============================================================================
+
+enum class LEDAnimationType {
+    KEYFRAMES,   // Explicit LED changes per step
+    FADE,        // low_level -> high_level over period_ticks
+    PULSE,       // Triangle wave between low_level and high_level
+    BLINK,       // high_level for half the period, low_level for the other half
+    CHASE        // One target at high_level, moving every period_ticks
+};
+
+// One LED change of a keyframe animation
+struct LEDKeyframe {
+    int step;            // Keyframe step (0, 1, 2, ...)
+    LEDTarget target;
+    LEDColor color;      // Ignored for single-color LEDs
+    uint8_t level;       // Brightness level 0-127
+};
+
+/*
+* Animation description, plain data
+* Procedural animations (FADE, PULSE, BLINK, CHASE) drive all targets with
+* color and the level range. KEYFRAMES applies keyframes, one step every
+* period_ticks. repeat is the number of periods/passes, 0 = forever.
+*/
+struct LEDAnimation {
+    LEDAnimationType type = LEDAnimationType::KEYFRAMES;
+    std::vector<LEDTarget> targets;
+    std::vector<LEDKeyframe> keyframes;
+    LEDColor color = LEDColor::white;
+    uint8_t low_level = 0;
+    uint8_t high_level = 127;
+    int period_ticks = 1;
+    int repeat = 1;
+};
+
+// Helpers to build procedural animations
+LEDAnimation makeFadeAnimation(const std::vector<LEDTarget>& targets, LEDColor color, uint8_t from_level, uint8_t to_level, int duration_ticks);
+LEDAnimation makePulseAnimation(const std::vector<LEDTarget>& targets, LEDColor color, uint8_t low_level, uint8_t high_level, int period_ticks, int repeat = 0);
+LEDAnimation makeBlinkAnimation(const std::vector<LEDTarget>& targets, LEDColor color, uint8_t low_level, uint8_t high_level, int period_ticks, int repeat = 0);
+LEDAnimation makeChaseAnimation(const std::vector<LEDTarget>& targets, LEDColor color, uint8_t low_level, uint8_t high_level, int step_ticks, int repeat = 0);
+
+// Sets one LED target without storing state (used by animations)
+bool setLEDTargetLevel(LEDTarget target, LEDColor color, uint8_t level);
+
+// =============================================================================
+// LED ANIMATION ENGINE CLASS - Fixed tick scheduler
+// =============================================================================
+
+/*
+* Runs any number of animations on a fixed tick. Each tick evaluates all
+* active animations into the back buffer inside one beginLEDFrame() /
+* commitLEDFrame() pair and flushes once, so a tick costs at most one report.
+*
+* The engine either runs its own tick thread (start()), or tick() is called
+* by an external timer. Playing and stopping animations never waits for USB.
+*/
+class LEDAnimationEngine {
+private:
+    struct ActiveAnimation {
+        int id;
+        uint64_t start_tick;
+        LEDAnimation animation;
+        int cycle_ticks;         // Ticks of one period/pass
+        int total_ticks;         // 0 = runs until stopped
+    };
+
+    std::vector<ActiveAnimation> animations;
+    std::mutex animation_mutex;              // Guards animations, never held during USB I/O
+    std::atomic<uint64_t> tick_count;
+    int next_id;
+
+    std::thread tick_thread;
+    std::atomic<bool> running;
+    std::atomic<int> tick_ms;
+
+    // Helper functions
+    void evaluate(const ActiveAnimation& active, uint64_t tick);
+    void tickLoop();
+
+public:
+    LEDAnimationEngine();
+    ~LEDAnimationEngine();
+
+    // Tick thread control
+    bool start(int tick_ms = LED_ANIMATION_DEFAULT_TICK_MS);
+    void stop();
+    bool isRunning() const;
+    int getTickMs() const;
+
+    // Advance all animations by one tick (called by the tick thread or a timer)
+    void tick();
+
+    // Animation control
+    int play(const LEDAnimation& animation);
+    void cancel(int id);
+    void cancelAll();
+    bool isPlaying(int id);
+    bool isIdle();
+};
+
+#endif // LED_ANIMATION_H
@@ -1,9 +1,12 @@
 #ifndef LED_CONTROLLER_BASE_H
 #define LED_CONTROLLER_BASE_H
 
+#include <array>
 #include <cstdint>
 #include <hidapi/hidapi.h>
 
+class LEDOutputWriter;
+
 // =============================================================================
 // GLOBAL LED STATE BYTE BUFFER - Persistent byte buffer for all LED states
 // =============================================================================
@@ -12,11 +15,14 @@
 const int LED_REPORT_SIZE = 81;              // F1 always expects 81-byte LED reports
 const unsigned char LED_REPORT_ID = 0x80;    // First byte is always 0x80
 
-// This byte buffer holds the current state of all LEDs on the F1.
+// The LED buffer holds the current state of all LEDs on the F1.
 // It's persistent, so changing one LED does not affect the others.
-// The byte buffer is always ready to send to the F1 device.
-extern unsigned char led_buffer[LED_REPORT_SIZE];
-extern hid_device* current_device;
+// It holds linear levels, flushes encode it (brightness curves) before sending.
+// Write it through the setters or writeLEDBytes(), they serialize access.
+// It is the back buffer: flushes send the last committed copy of it, see
+// beginLEDFrame() / commitLEDFrame(). There is one per process, it lives
+// with the other output state in led_controller_base.cpp, and
+// initializeLEDController() points it at the F1 to drive.
 
 // =============================================================================
 // CONSTANTS - These define the structure of the F1's LED output reports
@@ -57,6 +63,10 @@ const int MATRIX_LEDS_PER_BUTTON = 3;    // Each matrix button has 3 LEDs (B, R,
 const int MATRIX_ROWS = 4;               // 4 rows in the matrix
 const int MATRIX_COLS = 4;               // 4 columns in the matrix
 
+// Button counts (LEDButton values, stop buttons)
+const int LED_BUTTON_COUNT = 8;          // 3 control + 5 special buttons
+const int LED_STOP_COUNT = 4;            // 4 stop buttons, 2 LEDs each
+
 
 // =============================================================================
 // COLOR SYSTEM - All available colors with BRG values
@@ -91,6 +101,25 @@ enum class LEDColor {
     white
 };
 
+// =============================================================================
+// COLOR LOOKUP TABLES - Integer color and brightness conversion
+// =============================================================================
+
+/*
+* Brightness is handled as a 7-bit level (0 = off, 127 = full brightness).
+* Float brightness values are converted to a level once per call with
+* brightnessToLevel(), everything after that is a table lookup.
+* Both tables are generated at compile time.
+*/
+const int LED_COLOR_COUNT = 18;              // Number of LEDColor values
+const int LED_BRIGHTNESS_LEVELS = 128;       // Brightness levels 0-127
+
+// [value_8bit][level] -> 8-bit color value scaled to 7 bits at brightness level/127
+extern const std::array<std::array<uint8_t, LED_BRIGHTNESS_LEVELS>, 256> LED_SCALE_TABLE;
+
+// [color][level] -> 7-bit BRG triple of an LEDColor at brightness level/127
+extern const std::array<std::array<BRGColor, LED_BRIGHTNESS_LEVELS>, LED_COLOR_COUNT> LED_COLOR_TABLE;
+
 // Special buttons enum (matches input_reader structure)
 enum class LEDButton {
     CAPTURE,
@@ -135,6 +164,116 @@ struct LEDState {
         float brightness;    // Original brightness
 };
 
+/*
+* LED Mode - How the driver animates an LED from its stored state
+*
+* BLINK switches between the stored brightness and off, PULSE ramps up and
+* down between them. The animation tick evaluates all modes.
+*/
+enum class LEDMode : uint8_t {
+    STEADY,      // Shows the stored state (default)
+    BLINK,       // On for the first half of each period, off for the second
+    PULSE        // Triangle wave, full brightness at mid-period
+};
+
+/*
+* What the rate of a mode counts in
+* BEAT modes follow the beat clock (see setLEDBeatClock()), e.g. a rate of
+* 1.0 blinks once per beat and 0.25 once per bar. Without a running clock
+* they show the stored state, like STEADY.
+*/
+enum class LEDModeSync : uint8_t {
+    TIME,        // rate_hz is in periods per second (default)
+    BEAT         // rate_hz is in periods per beat
+};
+
+struct LEDModeState {
+    LEDMode mode;
+    float rate_hz;       // Periods per second, or per beat for LEDModeSync::BEAT
+    float phase;         // Offset within the period (0.0 - 1.0)
+    LEDModeSync sync = LEDModeSync::TIME;
+};
+
+/*
+* LED Beat Clock - Source of the beat position for BEAT modes
+*
+* The animation tick asks for the position once per tick, before it takes the
+* LED buffer lock. Implementations must not call back into the LED setters.
+*/
+class LEDBeatClock {
+public:
+    virtual ~LEDBeatClock() = default;
+
+    /*
+    * @param time_ns: Point in time, from getLEDTimeNs()
+    * @param beats: Set to the beat position at that time (quarter notes)
+    * @return: true if the clock is running, false if beats was not set
+    */
+    virtual bool getBeatPosition(int64_t time_ns, double& beats) = 0;
+};
+
+/*
+* LED Command Hook - Called by the external LED paths (MIDI, OSC, the
+* daemon) on their thread, inside their open frame, before they paint an
+* LED command. ControllerHandler uses it to stop the startup wave, so the
+* wave's clear goes out with the command.
+*/
+typedef void (*LEDCommandHook)(void* user_data);
+
+
+
+// =============================================================================
+// FLUSH POLICY - When a dirty LED buffer is actually sent to the F1
+// =============================================================================
+
+/*
+* LED setters never talk to the device. They only change the LED buffer and mark
+* it dirty. One 81-byte report is then sent per frame, according to the policy:
+*
+* EXPLICIT:       Only flushLEDReport() sends the buffer
+* END_OF_RUN:     ControllerHandler::run() flushes once per iteration
+* MAX_FRAME_RATE: Like END_OF_RUN, but at most max_frame_rate reports per second
+*/
+enum class LEDFlushPolicy {
+    EXPLICIT,
+    END_OF_RUN,
+    MAX_FRAME_RATE
+};
+
+/*
+* What sendLEDFrame() did with a frame
+*/
+enum class LEDSendResult {
+    SENT,           // Written with hid_write()
+    SUPPRESSED,     // Identical to the frame the device shows, not written
+    FAILED          // Failed or partial hid_write(), or no device
+};
+
+/*
+* LED Write Statistics - Counts setter calls against actual USB writes
+*
+* Divide by the elapsed seconds to get changes and writes per second.
+*/
+struct LEDWriteStats {
+    uint64_t led_changes;           // Setter calls that marked the buffer dirty
+    uint64_t reports_sent;          // Successful hid_write() calls
+    uint64_t reports_suppressed;    // Frames identical to the last one sent, not written
+    uint64_t reports_failed;        // Failed or partial hid_write() calls
+    double elapsed_seconds;         // Time since the statistics were last reset
+};
+
+/*
+* LED Latency Statistics - From an input event to the report that shows it
+*
+* An input path (e.g. MIDI) marks the frame it painted with the time its
+* event arrived. The time is measured when hid_write() for that frame returns.
+*/
+struct LEDLatencyStats {
+    uint64_t samples;               // Frames that carried an origin time
+    double average_us;
+    double max_us;
+    double last_us;
+};
 
 
 // =============================================================================
@@ -144,20 +283,46 @@ struct LEDState {
 // Main LED system functions
 bool initializeLEDController(hid_device* device);
 bool sendLEDReport(hid_device* device);
+LEDSendResult sendLEDFrame(hid_device* device, const unsigned char* frame);
 void clearAllLEDs();
+bool writeLEDBytes(int start_byte, const uint8_t* bytes, int count);
+bool readLEDBytes(int start_byte, uint8_t* bytes, int count);
+
+// Frame flushing functions (setters only mark the buffer dirty)
+void markLEDBufferDirty();
+bool isLEDBufferDirty();
+bool flushLEDReport();
+void beginLEDFrame();
+bool commitLEDFrame();
+bool isLEDFrameOpen();
+bool flushLEDReportIfDue();
+void setLEDFlushPolicy(LEDFlushPolicy policy, int max_frame_rate = 0);
+LEDFlushPolicy getLEDFlushPolicy();
+void setLEDOutputWriter(LEDOutputWriter* writer);
+void setLEDRefreshInterval(int refresh_ms);
 
 // Matrix LED functions (RGB buttons)
 bool setMatrixButtonLED(int row, int col, BRGColor color, float brightness, bool store_led_state = true);
 bool setMatrixButtonLED(int row, int col, LEDColor color, float brightness, bool store_led_state = true);
+bool setMatrixButtonLEDLevel(int row, int col, LEDColor color, uint8_t level, bool store_led_state = true);
 
 // button LED functions (single brightness)
 bool setButtonLED(LEDButton button, float brightness, bool store_led_state = true);
+bool setButtonLEDLevel(LEDButton button, uint8_t level, bool store_led_state = true);
 
 // Stop button LED functions (each stop has 2 LEDs)
 bool setStopButtonLED(int index, float brightness, bool store_led_state = true);
+bool setStopButtonLEDLevel(int index, uint8_t level, bool store_led_state = true);
 
 // Color system functions
 BRGColor getColor(LEDColor color);
+LEDColor getNearestColor(BRGColor color);
+uint8_t brightnessToLevel(float brightness);
+
+// Byte positions of LEDs in the report (-1 if invalid)
+int getMatrixButtonByte(int row, int col);
+int getButtonByte(LEDButton button);
+int getStopButtonByte(int index);
 
 
 // =============================================================================
@@ -184,6 +349,25 @@ LEDStateMatrix getMatrixButtonState(int row, int col);
 // Get original state for special buttons  
 LEDState getButtonState(LEDButton button);
 
+// Per-LED modes - only stored, the animation tick paints them
+bool setMatrixButtonLEDMode(int row, int col, LEDMode mode, float rate_hz = 2.0f, float phase = 0.0f, LEDModeSync sync = LEDModeSync::TIME);
+bool setButtonLEDMode(LEDButton button, LEDMode mode, float rate_hz = 2.0f, float phase = 0.0f, LEDModeSync sync = LEDModeSync::TIME);
+bool setStopButtonLEDMode(int index, LEDMode mode, float rate_hz = 2.0f, float phase = 0.0f, LEDModeSync sync = LEDModeSync::TIME);
+LEDModeState getMatrixButtonLEDMode(int row, int col);
+LEDModeState getButtonLEDMode(LEDButton button);
+LEDModeState getStopButtonLEDMode(int index);
+bool hasActiveLEDModes();
+int updateLEDModes(uint64_t time_ms);
+void setLEDBeatClock(LEDBeatClock* clock);
+
+// Replace or copy all original states at once (e.g. when a page scene is swapped)
+void loadLEDStates(const LEDStateMatrix matrix[MATRIX_ROWS][MATRIX_COLS],
+                   const LEDState buttons[LED_BUTTON_COUNT],
+                   const LEDState stops[LED_STOP_COUNT]);
+void saveLEDStates(LEDStateMatrix matrix[MATRIX_ROWS][MATRIX_COLS],
+                   LEDState buttons[LED_BUTTON_COUNT],
+                   LEDState stops[LED_STOP_COUNT]);
+
 
 // =============================================================================
 // UTILITY FUNCTIONS - Testing and Debugging
@@ -193,4 +377,19 @@ void printLEDReport();
 void testAllLEDs();
 void printLEDStates();
 
+// Write statistics
+LEDWriteStats getLEDWriteStats();
+void resetLEDWriteStats();
+void printLEDWriteStats();
+
+// Latency statistics (times are steady clock nanoseconds, see getLEDTimeNs())
+int64_t getLEDTimeNs();
+void markLEDFrameOrigin(int64_t origin_ns);
+void recordLEDLatency(int64_t origin_ns);
+LEDLatencyStats getLEDLatencyStats();
+void resetLEDLatencyStats();
+
+// Benchmarks
+void benchmarkColorConversion(int repaints = 100000);
+
 #endif // LED_CONTROLLER_BASE_H
@@ -1,7 +1,10 @@
 #ifndef LED_CONTROLLER_DISPLAY_H
 #define LED_CONTROLLER_DISPLAY_H
 
+#include <array>
+#include <atomic>
 #include <cstdint>                  // For uint8_t type
+#include <string>
 #include "led_controller_base.h"
 
 // =============================================================================
@@ -12,19 +15,91 @@
 // 127 = full brightness, 0 = off
 extern const uint8_t DIGIT_PATTERNS[11][7]; // 0-9 + blank (index 10)
 
+// =============================================================================
+// GLYPH AND DISPLAY FRAME TABLES - Generated at compile time
+// =============================================================================
+
+const int DISPLAY_SEGMENT_COUNT = 7;                      // Segments per digit (dot not included)
+const int DISPLAY_GLYPH_COUNT = 128;                      // One glyph per ASCII character
+const int DISPLAY_FRAME_START = LED_BYTE_7SEG_RIGHT_START; // Byte 1
+const int DISPLAY_FRAME_SIZE = LED_BYTE_SPECIAL_START - LED_BYTE_7SEG_RIGHT_START; // Bytes 1-16
+const int DISPLAY_NUMBER_COUNT = 100;                     // Cached numbers 0-99
+const int DISPLAY_HEX_COUNT = 256;                        // Cached hex codes 00-FF
+
+using DisplayGlyph = std::array<uint8_t, DISPLAY_SEGMENT_COUNT>;
+
+/*
+* A display frame is bytes 1-16 of the LED report, both digits with their
+* dots, so showing it is one contiguous copy into the LED buffer:
+* [right dot, right segments x7, left dot, left segments x7]
+* Dots are off in the cached frames, the controller adds them when it copies.
+*/
+using DisplayFrame = std::array<uint8_t, DISPLAY_FRAME_SIZE>;
+
+// [ascii] -> segment pattern: digits, hex letters, a few more letters, '-', '_', '='
+// Characters that have no 7-segment shape are blank
+extern const std::array<DisplayGlyph, DISPLAY_GLYPH_COUNT> DISPLAY_GLYPHS;
+
+// [number] -> frame, numbers below 10 with a blank left digit
+extern const std::array<DisplayFrame, DISPLAY_NUMBER_COUNT> DISPLAY_NUMBER_FRAMES;
+
+// [code] -> frame, two hex digits (0-9, A b C d E F)
+extern const std::array<DisplayFrame, DISPLAY_HEX_COUNT> DISPLAY_HEX_FRAMES;
+
+// Both digits blank
+extern const DisplayFrame DISPLAY_BLANK_FRAME;
+
+// Glyph and frame helpers
+const DisplayGlyph& getDisplayGlyph(char character);
+DisplayFrame makeDisplayFrame(char left, char right);
+
+// =============================================================================
+// DISPLAY SCROLLING - Text longer than two digits, driven by the animation tick
+// =============================================================================
+
+const int DISPLAY_SCROLL_MAX_LENGTH = 32;         // Longer text is cut off
+const int DISPLAY_SCROLL_DEFAULT_STEP_MS = 300;   // Time each position is shown
+
+/*
+* One scroll runs at a time, the text moves in from the right and out to
+* the left. The animation engine calls updateDisplayScroll() inside its
+* frame, so a scroll step goes out with the tick's report and never costs
+* a report of its own. Only the segments are written, the dots are kept.
+*/
+void startDisplayScroll(const std::string& text, int step_ms, int repeat);
+void stopDisplayScroll();
+bool isDisplayScrolling();
+bool updateDisplayScroll(uint64_t time_ms);
+
 // =============================================================================
 // LED CONTROLLER DISPLAY CLASS
 // =============================================================================
 
 class DisplayController {
 private:
+    std::atomic<uint8_t> left_dot;      // Dot levels, kept so frame copies preserve them
+    std::atomic<uint8_t> right_dot;
+
     // Private helper function to set individual display segments
     void setDisplaySegment(int display, int digit);
 
 public:
+    DisplayController();
+
     // Main display functions
     void setDisplayNumber(int number);
     void setDisplayDot(int display, bool on);
+
+    // Cached frames - one copy into the LED buffer per update
+    void setDisplayFrame(const DisplayFrame& frame);
+    void setDisplayHex(uint8_t code);
+    void setDisplayText(char left, char right);
+    void clearDisplay();
+
+    // Values and text that may not fit on two digits are scrolled
+    void setDisplayValue(int value, int step_ms = DISPLAY_SCROLL_DEFAULT_STEP_MS, int repeat = 0);
+    void scrollDisplayText(const std::string& text, int step_ms = DISPLAY_SCROLL_DEFAULT_STEP_MS, int repeat = 0);
+    bool isScrolling() const;
 };
 
-#endif // LED_CONTROLLER_DISPLAY_H
\ No newline at end of file
+#endif // LED_CONTROLLER_DISPLAY_H
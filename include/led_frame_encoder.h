@@ -0,0 +1,59 @@
+#ifndef LED_FRAME_ENCODER_H
+#define LED_FRAME_ENCODER_H
+
+#include <cstdint>
+#include "led_controller_base.h"    // For LED_REPORT_SIZE and byte positions
+
+// =============================================================================
+// ENUMS - LED groups and brightness curves
+// =============================================================================
+
+// LED groups that can have their own brightness curve
+enum class LEDGroup {
+    DISPLAY,     // 7-segment displays and dots (bytes 1-16)
+    BUTTONS,     // Special and control buttons (bytes 17-24)
+    MATRIX,      // RGB matrix buttons (bytes 25-72)
+    STOP         // Stop buttons (bytes 73-80)
+};
+
+const int LED_GROUP_COUNT = 4;
+
+// Temporal dithering: 7-bit levels + 5 fraction bits = 12-bit brightness
+// (the fine levels of float setters and the dithered curve output)
+const int LED_DITHER_BITS = 5;
+const uint8_t LED_DITHER_MASK = (1 << LED_DITHER_BITS) - 1;
+
+// Brightness curves applied when a frame is encoded
+enum class LEDBrightnessCurve {
+    LINEAR,      // Output = level (hardware behaviour, default)
+    GAMMA,       // Output = 127 * (level/127)^gamma
+    PERCEPTUAL   // CIE 1931 lightness, evenly spaced perceived steps
+};
+
+// =============================================================================
+// FUNCTION DECLARATIONS - Frame encoding
+// =============================================================================
+
+/*
+* The LED buffer holds linear 7-bit levels. When a frame is flushed it is
+* encoded once: every byte goes through the 128-entry curve table of its
+* group. The tables are built when a curve is selected, so encoding is one
+* table lookup per byte and setters never do curve math.
+*/
+
+// Curve configuration
+void setLEDGroupCurve(LEDGroup group, LEDBrightnessCurve curve, float gamma = 2.2f);
+LEDBrightnessCurve getLEDGroupCurve(LEDGroup group);
+LEDGroup getLEDGroupForByte(int byte_position);
+
+// Temporal dithering (frame-rate modulation) per group, off by default
+void setLEDGroupDithering(LEDGroup group, bool enabled);
+bool isLEDGroupDithering(LEDGroup group);
+
+// Encoding - source and frame are complete 81-byte reports, source levels 0-127
+bool encodeLEDFrame(const unsigned char* source, unsigned char* frame, unsigned char* fractions = nullptr,
+                    const uint16_t* fine_source = nullptr);
+void ditherLEDFrame(const unsigned char* frame, const unsigned char* fractions,
+                    unsigned char* accumulators, unsigned char* output);
+
+#endif // LED_FRAME_ENCODER_H
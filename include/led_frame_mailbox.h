@@ -0,0 +1,57 @@
+#ifndef LED_FRAME_MAILBOX_H
+#define LED_FRAME_MAILBOX_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include "led_controller_base.h"    // For LED_REPORT_SIZE
+
+// =============================================================================
+// LED FRAME TYPE - One complete 81-byte LED report
+// =============================================================================
+
+using LEDFrame = std::array<unsigned char, LED_REPORT_SIZE>;
+
+// =============================================================================
+// LED FRAME MAILBOX CLASS - Lock-free latest-wins triple buffer
+// =============================================================================
+
+/*
+* Hands complete LED frames from the painting side to the writer thread.
+*
+* Three frame slots rotate between the producer (back), the mailbox (middle)
+* and the consumer (front). publish() and fetch() only swap slot indices with
+* one atomic exchange, so neither side ever waits for the other. If several
+* frames are published before the consumer fetches, only the newest survives.
+*
+* There must be only one producer and one consumer at a time.
+*/
+class LEDFrameMailbox {
+private:
+    static constexpr uint8_t FRESH_BIT = 0x04;     // Middle slot holds an unfetched frame
+    static constexpr uint8_t INDEX_MASK = 0x03;    // Middle slot index (0-2)
+
+    LEDFrame slots[3];
+    LEDFrame fraction_slots[3];               // Dither fractions that travel with each frame
+    bool has_fractions[3];
+    int64_t origins[3];                       // Event time each frame shows (0 = none), see markLEDFrameOrigin()
+    std::atomic<uint8_t> middle_state;        // Middle slot index + FRESH_BIT
+    std::atomic<uint32_t> sequence;           // Bumped on every publish, used to sleep/wake
+    uint8_t back_index;                       // Producer-owned slot
+    uint8_t front_index;                      // Consumer-owned slot
+
+public:
+    LEDFrameMailbox();
+
+    // Producer side
+    void publish(const unsigned char* frame, const unsigned char* fractions = nullptr, int64_t origin_ns = 0);
+
+    // Consumer side
+    const unsigned char* fetch();
+    const unsigned char* fetchedFractions() const;
+    int64_t fetchedOrigin() const;
+    uint32_t waitForPublish(uint32_t last_sequence) const;
+    void wake();
+};
+
+#endif // LED_FRAME_MAILBOX_H
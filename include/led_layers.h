@@ -0,0 +1,86 @@
+#ifndef LED_LAYERS_H
+#define LED_LAYERS_H
+
+#include <cstdint>
+#include "led_controller_base.h"    // For LED_REPORT_SIZE, LEDColor and LEDButton
+
+// =============================================================================
+// ENUMS - LED layers and blend modes
+// =============================================================================
+
+/*
+* Layers are stacked bottom to top. BASE is the LED buffer itself, everything the
+* existing setters paint. The other layers start out transparent: only bytes
+* that were written to a layer cover the layers below, and clearing them
+* shows the layers below again.
+*/
+enum class LEDLayer {
+    BASE,        // Application LEDs (the LED buffer, the setters)
+    OVERLAY,     // Transient overlays, e.g. a metronome
+    FEEDBACK     // Input feedback, e.g. pad presses
+};
+
+const int LED_LAYER_COUNT = 3;
+
+// How the covered bytes of a layer combine with the layers below
+enum class LEDBlendMode {
+    NORMAL,      // Replace, mixed by opacity
+    ADD,         // Add levels, saturating at 127
+    MAX,         // Keep the brighter level
+    MULTIPLY     // Scale the layers below (127 = unchanged, 0 = off)
+};
+
+/*
+* Copy of all layers above BASE, taken when a frame is committed
+* The flush composites the snapshot of the last commit, so layers reach the
+* device together with the BASE frame they were painted with.
+*/
+struct LEDLayerSnapshot {
+    unsigned char values[LED_LAYER_COUNT][LED_REPORT_SIZE];
+    unsigned char masks[LED_LAYER_COUNT][LED_REPORT_SIZE];      // 0xFF = covered
+    bool used[LED_LAYER_COUNT];
+    uint8_t opacity[LED_LAYER_COUNT];
+    LEDBlendMode modes[LED_LAYER_COUNT];
+};
+
+// =============================================================================
+// FUNCTION DECLARATIONS - Layer configuration, painting and compositing
+// =============================================================================
+
+/*
+* Layers are composited into one report only when a frame is flushed, right
+* before the brightness curves are applied. Painting a layer never touches
+* the other layers, so the app does not have to repaint what an overlay hid.
+* Inside beginLEDFrame() / commitLEDFrame() layer painting is kept with the
+* calling thread's frame, like the BASE setters.
+*/
+
+// Layer configuration (BASE ignores the blend mode, its opacity dims it)
+void setLEDLayerOpacity(LEDLayer layer, float opacity);
+float getLEDLayerOpacity(LEDLayer layer);
+void setLEDLayerBlendMode(LEDLayer layer, LEDBlendMode mode);
+LEDBlendMode getLEDLayerBlendMode(LEDLayer layer);
+const char* getLEDLayerName(LEDLayer layer);
+
+// Painting - BASE forwards to the regular setters
+bool writeLEDLayerBytes(LEDLayer layer, int start_byte, const uint8_t* bytes, int count);
+bool setLayerMatrixButtonLED(LEDLayer layer, int row, int col, LEDColor color, float brightness);
+bool setLayerButtonLED(LEDLayer layer, LEDButton button, float brightness);
+bool setLayerStopButtonLED(LEDLayer layer, int index, float brightness);
+
+// Uncovering - the layers below show through again
+bool clearLEDLayerBytes(LEDLayer layer, int start_byte, int count);
+bool clearLayerMatrixButtonLED(LEDLayer layer, int row, int col);
+bool clearLayerButtonLED(LEDLayer layer, LEDButton button);
+bool clearLayerStopButtonLED(LEDLayer layer, int index);
+void clearLEDLayer(LEDLayer layer);
+
+// Frames - called by commitLEDFrame() / the commit with led_buffer_mutex held
+bool mergeLEDLayerFrame();
+void snapshotLEDLayers(LEDLayerSnapshot& snapshot);
+
+// Compositing - base and frame are complete 81-byte reports
+void compositeLEDLayers(const LEDLayerSnapshot& layers, const unsigned char* base, unsigned char* frame,
+                        const uint16_t* base_fine = nullptr, uint16_t* fine = nullptr);
+
+#endif // LED_LAYERS_H
@@ -0,0 +1,72 @@
+#ifndef LED_OUTPUT_WRITER_H
+#define LED_OUTPUT_WRITER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <hidapi/hidapi.h>
+#include "led_frame_mailbox.h"
+#include "led_frame_encoder.h"
+#include "realtime_mode.h"
+
+// =============================================================================
+// CONSTANTS - Writer thread frame rate limits
+// =============================================================================
+
+const int LED_WRITER_DEFAULT_FRAME_RATE = 100;   // Reports per second by default
+const int LED_WRITER_MAX_FRAME_RATE = 1000;      // USB full-speed interrupt interval (1 ms)
+
+// =============================================================================
+// LED OUTPUT WRITER CLASS - Dedicated thread owning the device's write side
+// =============================================================================
+
+/*
+* Callers submit complete frames and return immediately. The writer thread
+* sleeps until a frame is published, sends the newest one with hid_write()
+* and then waits out the frame interval. Frames submitted in between are
+* collapsed into the latest one by the mailbox.
+*
+* A frame with dither fractions is not sent once but rendered anew and sent
+* on every frame interval (temporal dithering), until a frame without
+* fractions replaces it.
+*/
+class LEDOutputWriter {
+private:
+    LEDFrameMailbox mailbox;                  // Latest-wins handoff to the thread
+    hid_device* device;
+    std::thread writer_thread;
+    std::atomic<bool> running;
+    std::atomic<int64_t> frame_interval_ns;   // Minimum time between two reports
+
+    std::atomic<uint64_t> frames_submitted;   // Frames handed to submit()
+    std::atomic<uint64_t> frames_written;     // Frames the thread wrote with hid_write() (not suppressed ones)
+    std::atomic<int> dither_frame_rate;       // Dithered frames per second, measured over the last second
+
+    // Thread body
+    void writerLoop();
+
+public:
+    LEDOutputWriter();
+    ~LEDOutputWriter();
+
+    // Thread control
+    bool start(hid_device* device, int frame_rate = LED_WRITER_DEFAULT_FRAME_RATE);
+    void stop();
+    bool isRunning() const;
+
+    // Frame handoff - never blocks on USB
+    void submit(const unsigned char* frame, const unsigned char* fractions = nullptr, int64_t origin_ns = 0);
+
+    // Configuration
+    void setFrameRate(int frame_rate);
+    int getFrameRate() const;
+    bool setRealtime(int priority, int cpu, RealtimeStatus* status = nullptr);
+
+    // Statistics
+    uint64_t getFramesSubmitted() const;
+    uint64_t getFramesWritten() const;
+    int getDitherFrameRate() const;
+};
+
+#endif // LED_OUTPUT_WRITER_H
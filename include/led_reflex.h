@@ -0,0 +1,71 @@
+#ifndef LED_REFLEX_H
+#define LED_REFLEX_H
+
+#include <atomic>
+#include <cstdint>
+#include "led_controller_base.h"    // For LEDColor, LEDButton and counts
+
+// =============================================================================
+// REFLEX ENTRIES - What an LED does on its own input edge
+// =============================================================================
+
+// Reaction of an LED to its button being pressed
+enum class LEDReflexMode : uint8_t {
+    OFF,         // No reflex, only the app decides
+    COLOR,       // Show color at level while held (buttons: level only)
+    BRIGHTEN     // Show the LED's current color at level while held
+};
+
+struct LEDReflex {
+    LEDReflexMode mode;
+    LEDColor color;      // Used by COLOR, and by BRIGHTEN for dark pads
+    uint8_t level;       // Brightness level while held (0-127)
+};
+
+// =============================================================================
+// LED REFLEX TABLE CLASS - Driver-side echo of button presses
+// =============================================================================
+
+/*
+* Lets configured pads and buttons light up in the same run() iteration that
+* sees the press, without a round trip through the app. The echo is painted
+* on the FEEDBACK layer, so the release simply uncovers the app's LEDs again.
+*
+* Every entry is packed into one atomic word. The input path only does
+* atomic loads, so entries can be changed from any thread at any time
+* without a lock. The on*() functions are called by one input thread.
+*/
+class LEDReflexTable {
+private:
+    std::atomic<uint32_t> matrix_entries[MATRIX_ROWS][MATRIX_COLS];
+    std::atomic<uint32_t> button_entries[LED_BUTTON_COUNT];
+    std::atomic<uint32_t> stop_entries[LED_STOP_COUNT];
+
+    // LEDs currently lit by a reflex, only touched by the input path
+    bool matrix_lit[MATRIX_ROWS][MATRIX_COLS];
+    bool button_lit[LED_BUTTON_COUNT];
+    bool stop_lit[LED_STOP_COUNT];
+
+    static uint32_t pack(LEDReflex reflex);
+    static LEDReflex unpack(uint32_t entry);
+
+public:
+    LEDReflexTable();
+
+    // Configuration - safe to call while input is processed
+    bool setMatrixReflex(int row, int col, LEDReflex reflex);
+    bool setButtonReflex(LEDButton button, LEDReflex reflex);
+    bool setStopReflex(int index, LEDReflex reflex);
+    void clear();
+
+    LEDReflex getMatrixReflex(int row, int col) const;
+    LEDReflex getButtonReflex(LEDButton button) const;
+    LEDReflex getStopReflex(int index) const;
+
+    // Input edges - return true if an LED was changed
+    bool onMatrixButton(int row, int col, bool pressed);
+    bool onButton(LEDButton button, bool pressed);
+    bool onStopButton(int index, bool pressed);
+};
+
+#endif // LED_REFLEX_H
@@ -0,0 +1,75 @@
+#ifndef LED_SCENE_CACHE_H
+#define LED_SCENE_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include "led_controller_base.h"
+
+// =============================================================================
+// CONSTANTS - Pages and the part of the LED report a scene covers
+// =============================================================================
+
+const int LED_SCENE_FIRST_PAGE = 1;          // Effect pages selected with the wheel
+const int LED_SCENE_LAST_PAGE = 99;
+const int LED_SCENE_PAGE_COUNT = LED_SCENE_LAST_PAGE - LED_SCENE_FIRST_PAGE + 1;
+
+// A scene holds every button LED (bytes 17-80). The displays are left out,
+// they show the page number and are written by the page change itself.
+const int LED_SCENE_START_BYTE = LED_BYTE_SPECIAL_START;
+const int LED_SCENE_SIZE = LED_REPORT_SIZE - LED_SCENE_START_BYTE;
+
+// =============================================================================
+// LED SCENE - Precomputed button LEDs of one page
+// =============================================================================
+
+/*
+* The encoded report bytes plus the original states, so the state getters
+* (getMatrixButtonState(), getButtonState()) follow the active page.
+*/
+struct LEDScene {
+    uint8_t bytes[LED_SCENE_SIZE];                             // Report bytes 17-80, 7-bit levels
+    LEDStateMatrix matrix_states[MATRIX_ROWS][MATRIX_COLS];    // [row][col], 0-based
+    LEDState button_states[LED_BUTTON_COUNT];                  // Indexed by LEDButton
+    LEDState stop_states[LED_STOP_COUNT];                      // STOP1-STOP4
+};
+
+// =============================================================================
+// LED SCENE CACHE CLASS - One scene per page, O(1) page switching
+// =============================================================================
+
+/*
+* Pages can be updated at any time, from any thread. Updates to the active
+* page are also written through to the live LED buffer, and LEDs written to
+* the live buffer by other paths (MIDI, SysEx, OSC, the daemon) while a page
+* is shown are saved to that page when it is left. activatePage() swaps the
+* whole scene into the buffer as one frame and sends it with one report,
+* instead of one setter call (and report) per LED.
+*/
+class LEDSceneCache {
+private:
+    LEDScene scenes[LED_SCENE_PAGE_COUNT];
+    std::mutex scene_mutex;                   // Guards scenes, taken before the LED buffer lock
+    std::atomic<int> active_page;             // 0 = no page active, scenes are not shown
+
+    LEDScene* getScene(int page);
+    void saveActivePage();
+    void showScene(const LEDScene& scene);
+
+public:
+    LEDSceneCache();
+
+    // Page editing - changes to the active page show up immediately
+    bool setMatrixButton(int page, int row, int col, LEDColor color, float brightness);
+    bool setMatrixButton(int page, int row, int col, BRGColor color, float brightness);
+    bool setButton(int page, LEDButton button, float brightness);
+    bool setStopButton(int page, int index, float brightness);
+    void clearPage(int page);
+
+    // Page switching
+    bool activatePage(int page);
+    void deactivate();
+    int getActivePage() const;
+};
+
+#endif // LED_SCENE_CACHE_H
@@ -0,0 +1,107 @@
+#ifndef MIDI_CLOCK_H
+#define MIDI_CLOCK_H
+
+#include <cstdint>
+#include <mutex>
+#include "led_controller_base.h"    // For LEDBeatClock
+
+// =============================================================================
+// CONSTANTS - MIDI clock protocol and PLL tuning
+// =============================================================================
+
+// System real-time and common messages (MIDI 1.0 spec)
+const uint8_t MIDI_CLOCK_TICK = 0xF8;
+const uint8_t MIDI_CLOCK_START = 0xFA;
+const uint8_t MIDI_CLOCK_CONTINUE = 0xFB;
+const uint8_t MIDI_CLOCK_STOP = 0xFC;
+const uint8_t MIDI_SONG_POSITION = 0xF2;    // 14-bit position in 16th notes
+
+const int MIDI_CLOCK_PPQN = 24;             // Clock ticks per beat (quarter note)
+const int MIDI_CLOCK_TICKS_PER_16TH = 6;
+
+const double MIDI_CLOCK_MIN_BPM = 20.0;     // Tick periods outside this range are clamped
+const double MIDI_CLOCK_MAX_BPM = 300.0;
+
+// PLL gains: how much of a tick's timing error moves the phase and the period.
+// Small gains average out USB/ALSA jitter, tempo changes take a few beats.
+const double MIDI_CLOCK_PHASE_GAIN = 0.1;
+const double MIDI_CLOCK_PERIOD_GAIN = 0.01;
+
+const int MIDI_CLOCK_LOCK_TICKS = MIDI_CLOCK_PPQN;   // Ticks in the loop before it counts as locked
+
+// =============================================================================
+// MIDI CLOCK STATISTICS
+// =============================================================================
+
+/*
+* The phase error is the arrival time of a tick against the time the PLL
+* predicted for it. Positive = the tick came late.
+*/
+struct MidiClockStats {
+    bool running;               // Between Start/Continue and Stop
+    bool locked;                // The PLL follows the incoming ticks
+    double bpm;                 // Smoothed tempo, 0 = no tempo yet
+    double beat_position;       // Beats since Start, at the time of the call
+    uint64_t ticks;             // Clock ticks received
+    uint64_t resyncs;           // Times the PLL jumped to the incoming clock (tempo jumps, dropouts)
+    double phase_error_us;      // Error of the last tick
+    double average_error_us;    // Smoothed absolute error
+    double max_error_us;        // Largest absolute error while locked
+};
+
+// =============================================================================
+// MIDI CLOCK FOLLOWER CLASS - Beat position from incoming MIDI clock
+// =============================================================================
+
+/*
+* Follows 24 ppqn MIDI clock with a second order PLL: every tick corrects the
+* estimated tick time by a fraction of its error and the tick period by a
+* smaller fraction. The beat position between ticks is extrapolated from the
+* smoothed period, so LEDs move smoothly even though ticks arrive with jitter.
+*
+* The message handlers are called by the MIDI LED thread with the arrival
+* times from the event queue. getBeatPosition() is called by the animation
+* tick. Both only hold clock_mutex for a few arithmetic operations.
+*/
+class MidiClockFollower : public LEDBeatClock {
+private:
+    mutable std::mutex clock_mutex;
+
+    bool running;
+    int64_t last_arrival_ns;    // Raw arrival time of the last tick, 0 = none yet
+    double tick_time_ns;        // Smoothed time of the last tick
+    double period_ns;           // Smoothed tick period, 0 = unknown
+    int64_t tick_index;         // Ticks since Start of the last tick, -1 = waiting for the first
+
+    int locked_ticks;           // Ticks since the last resync
+    uint64_t ticks;
+    uint64_t resyncs;
+    double phase_error_us;
+    double average_error_us;
+    double max_error_us;
+
+    // Helper functions
+    void resync(int64_t time_ns, int64_t arrival_ns);
+    double getBeatsLocked(int64_t time_ns) const;
+
+public:
+    MidiClockFollower();
+
+    // Messages, with their arrival time from getLEDTimeNs()
+    bool handleMessage(uint8_t status, uint8_t data1, uint8_t data2, int64_t time_ns);
+    void onClock(int64_t time_ns);
+    void onStart();
+    void onContinue();
+    void onStop();
+    void onSongPosition(int sixteenths);
+    void reset();
+
+    // State
+    bool getBeatPosition(int64_t time_ns, double& beats) override;
+    bool isRunning() const;
+    double getBPM() const;
+    MidiClockStats getStats() const;
+    void resetStats();
+};
+
+#endif // MIDI_CLOCK_H
@@ -0,0 +1,80 @@
+#ifndef MIDI_EVENT_QUEUE_H
+#define MIDI_EVENT_QUEUE_H
+
+#include <atomic>
+#include <cstdint>
+
+// =============================================================================
+// CONSTANTS - Queue size
+// =============================================================================
+
+const int MIDI_EVENT_QUEUE_SIZE = 1024;     // Power of two, events the LED thread may fall behind
+const int MIDI_SYSEX_SLOT_COUNT = 16;       // Power of two, SysEx messages waiting at once
+const int MIDI_SYSEX_MAX_SIZE = 128;        // Longer SysEx messages are dropped
+
+// =============================================================================
+// MIDI EVENT - One channel message, as received
+// =============================================================================
+
+struct MidiEvent {
+    uint8_t status;         // Status byte incl. channel (e.g. 0x90), 0xF0 = SysEx in a payload slot
+    uint8_t data1;          // Note or controller number
+    uint8_t data2;          // Velocity or controller value
+    int64_t receive_ns;     // Arrival time, see getLEDTimeNs()
+};
+
+// Complete SysEx message (F0 ... F7) waiting for the consumer
+struct MidiSysExSlot {
+    uint8_t bytes[MIDI_SYSEX_MAX_SIZE];
+    int size;
+};
+
+// =============================================================================
+// MIDI EVENT QUEUE CLASS - Lock-free single producer / single consumer ring
+// =============================================================================
+
+/*
+* Hands MIDI events from RtMidi's callback thread to the MIDI LED thread.
+*
+* push() and pop() only move their own index, so the callback never waits
+* for the LED side (no locks, no allocation). A full queue drops the new
+* event and counts it, the callback thread is never blocked.
+*
+* SysEx messages are copied into one of a few payload slots and queued as
+* an 0xF0 event, so they stay in order with the channel messages.
+*
+* There must be only one producer and one consumer at a time.
+*/
+class MidiEventQueue {
+private:
+    static constexpr uint32_t INDEX_MASK = MIDI_EVENT_QUEUE_SIZE - 1;
+    static constexpr uint32_t SYSEX_MASK = MIDI_SYSEX_SLOT_COUNT - 1;
+
+    MidiEvent events[MIDI_EVENT_QUEUE_SIZE];
+    MidiSysExSlot sysex_slots[MIDI_SYSEX_SLOT_COUNT];
+    alignas(64) std::atomic<uint32_t> head;       // Next slot to write (producer)
+    std::atomic<uint32_t> sysex_head;
+    alignas(64) std::atomic<uint32_t> tail;       // Next slot to read (consumer)
+    std::atomic<uint32_t> sysex_tail;
+    alignas(64) std::atomic<uint32_t> sequence;   // Bumped on every push, used to sleep/wake
+    std::atomic<uint64_t> dropped;
+
+public:
+    MidiEventQueue();
+
+    // Producer side
+    bool push(const MidiEvent& event);
+    bool pushSysEx(const uint8_t* bytes, int size, int64_t receive_ns);
+
+    // Consumer side
+    bool pop(MidiEvent& event);
+    const MidiSysExSlot& sysExPayload() const;
+    void releaseSysEx();
+    uint32_t waitForPush(uint32_t last_sequence) const;
+    void wake();
+
+    // Statistics
+    uint64_t getDropped() const;
+};
+
+#endif // MIDI_EVENT_QUEUE_H
@@ -0,0 +1,179 @@
+#ifndef MIDI_HANDLER_H
+#define MIDI_HANDLER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <rtmidi/RtMidi.h>          // RtMidi library for MIDI handling
+#include "input_reader_knob.h"      // For KNOB_COUNT
+#include "led_controller_base.h"
+#include "led_controller_display.h"
+#include "midi_clock.h"
+#include "event_reactor.h"
+#include "midi_event_queue.h"
+#include "midi_led_map.h"
+#include "midi_sysex.h"
+
+// =============================================================================
+// CONSTANTS - Ports and MIDI protocol (see Project-planning)
+// =============================================================================
+
+const char MIDI_CLIENT_NAME[] = "F1_Controller";
+const char MIDI_OUT_PORT_NAME[] = "F1_Controller_Out";     // F1 -> external software
+const char MIDI_IN_PORT_NAME[] = "F1_Controller_In";       // External software -> F1 LEDs
+
+// Notes, input and LED share the same numbers
+const int MIDI_NOTE_MATRIX_FIRST = 36;      // Matrix (1,1) to (4,4) = notes 36-51
+const int MIDI_NOTE_BUTTON_FIRST = 60;      // Special buttons 60-64, control buttons 65-67
+const int MIDI_NOTE_STOP_FIRST = 68;        // Stop buttons 68-71
+
+// Controllers
+const int MIDI_CC_KNOB_FIRST = 1;           // Knobs 1-4 = CC 1-4
+const int MIDI_CC_FADER_FIRST = 5;          // Faders 1-4 = CC 5-8
+const int MIDI_CC_WHEEL = 10;               // Selector wheel, 1 = clockwise, 127 = counter-clockwise
+const int MIDI_CC_DISPLAY_NUMBER = 15;      // Display value 0-99
+const int MIDI_CC_DISPLAY_LEFT_DOT = 16;    // Dots, on at 64 and above
+const int MIDI_CC_DISPLAY_RIGHT_DOT = 17;
+
+// Button of each note 60-67
+extern const LEDButton MIDI_NOTE_BUTTONS[LED_BUTTON_COUNT];
+
+// High resolution controls: 14-bit CC pairs and NRPN (MIDI 1.0 spec numbers)
+const int MIDI_CC_LSB_OFFSET = 32;          // LSB of CC n is CC n + 32
+const int MIDI_CC_NRPN_MSB = 99;
+const int MIDI_CC_NRPN_LSB = 98;
+const int MIDI_CC_DATA_ENTRY_MSB = 6;
+const int MIDI_CC_DATA_ENTRY_LSB = 38;
+
+// Analog controls: knobs 0-3 are controls 0-3, faders 0-3 are controls 4-7
+const int MIDI_ANALOG_CONTROL_COUNT = 8;
+const int MIDI_ANALOG_DEADBAND = 2;         // Raw 12-bit steps ignored as ADC noise
+
+/*
+* How an analog control is sent
+* CC7:  CC n, value 0-127 (the planned protocol)
+* CC14: CC n (MSB) + CC n+32 (LSB), value 0-16383
+* NRPN: CC 99/98 select parameter n, then CC 6 (MSB) + CC 38 (LSB)
+* The MSB is only sent when it changed, receivers keep it.
+*/
+enum class MidiAnalogMode : uint8_t {
+    CC7,
+    CC14,
+    NRPN
+};
+
+// =============================================================================
+// MIDI HANDLER CLASS - Virtual ports, input as MIDI, MIDI to LEDs
+// =============================================================================
+
+/*
+* Incoming messages are only parsed on RtMidi's callback thread and pushed
+* into a lock-free queue. A MIDI LED thread drains the queue, paints all
+* waiting messages into one frame and flushes it once, so the callback never
+* waits on the LED buffer and hid_write() stays on the LED writer thread.
+*
+* Each flushed frame is marked with the arrival time of its oldest message,
+* getLatencyStats() reports note-in to hid_write() latency.
+*
+* MIDI clock (ticks, Start/Stop/Continue, Song Position) takes the same queue,
+* so the clock follower sees ticks with their arrival times from the callback.
+*
+* With attachReactor() the queue is drained on the reactor thread instead:
+* the callback signals an eventfd, coalesced to one wakeup per batch.
+*/
+class MidiHandler {
+private:
+    std::unique_ptr<RtMidiIn> midi_in;
+    std::unique_ptr<RtMidiOut> midi_out;
+    MidiEventQueue queue;                     // Callback thread -> MIDI LED thread
+    MidiLEDMap led_map;                       // Note/CC -> LED byte tables
+    MidiClockFollower clock;                  // Fed with clock messages by the MIDI LED thread
+    std::mutex map_mutex;                     // Guards led_map, taken once per batch before the LED buffer lock
+    DisplayController* display;               // Target of the display controllers, may be null
+    LEDCommandHook led_command_hook;          // Called before LED commands are painted, may be null
+    void* led_command_user_data;
+
+    std::thread led_thread;
+    std::atomic<bool> running;
+    std::atomic<bool> led_thread_running;
+
+    // Reactor mode (see attachReactor()), the notifier replaces the LED thread
+    EventReactor* reactor;
+    std::atomic<int> notify_fd;               // -1 = LED thread mode
+    std::atomic<bool> notify_pending;         // Wakeup sent, not yet handled
+    std::atomic<int> notify_users;            // Callbacks inside notifyReactor()
+    std::atomic<uint64_t> events_received;
+    std::atomic<uint64_t> events_applied;
+
+    // Output side, used by the input thread only (modes are set from any thread)
+    std::atomic<MidiAnalogMode> analog_modes[MIDI_ANALOG_CONTROL_COUNT];
+    MidiAnalogMode analog_sent_modes[MIDI_ANALOG_CONTROL_COUNT];
+    int analog_raw[MIDI_ANALOG_CONTROL_COUNT];      // Last raw value sent, -1 = none
+    int analog_values[MIDI_ANALOG_CONTROL_COUNT];   // Last value sent in the control's resolution
+    int analog_pending[MIDI_ANALOG_CONTROL_COUNT];  // Latest raw value of this report, -1 = none
+    int nrpn_parameter;                             // Parameter the receiver has selected, -1 = none
+    std::atomic<uint64_t> messages_sent;
+    std::atomic<uint64_t> bytes_sent;
+
+    // Helper functions
+    bool applyLEDMessage(const MidiEvent& event);
+    void sendAnalogValue(int control, int raw_value);
+    void sendMessage(uint8_t status, uint8_t data1, uint8_t data2);
+    void ledLoop();
+    void stopLEDThread();
+    void releaseReactor();
+    void notifyReactor();
+    static void onReactorNotify(int fd, uint32_t count, void* user_data);
+
+public:
+    MidiHandler();
+    ~MidiHandler();
+
+    // Setup
+    bool initializeMIDI(DisplayController* display = nullptr, bool open_ports = true);
+    void cleanup();
+    bool isOpen() const;
+    bool attachReactor(EventReactor& reactor);
+    void detachReactor();
+    void setLEDCommandHook(LEDCommandHook hook, void* user_data);
+
+    // Input -> MIDI (call from the input thread)
+    void sendButtonMIDI(int note, bool pressed);
+    void sendAnalogMIDI(int controller, int value);
+    void sendWheelMIDI(bool clockwise);
+    void sendAnalogControl(int control, uint16_t raw_value);
+    void flushOutput();
+
+    // Output configuration
+    void setAnalogMode(int control, MidiAnalogMode mode);
+    MidiAnalogMode getAnalogMode(int control) const;
+
+    // MIDI -> LEDs
+    static void receiveLEDMIDI(double deltatime, std::vector<unsigned char>* message, void* user_data);
+    bool receiveMessage(const unsigned char* bytes, size_t size);
+    int processLEDMessages();
+
+    // Note/CC to LED mapping
+    bool loadLEDMap(const std::string& path);
+    void resetLEDMap();
+    bool setNoteMapping(int note, const MidiLEDMapping& mapping);
+    bool setControllerMapping(int controller, const MidiLEDMapping& mapping);
+
+    // MIDI clock, the source of BEAT LED modes (see setLEDBeatClock())
+    MidiClockFollower* getClock();
+    MidiClockStats getClockStats() const;
+
+    // Statistics
+    uint64_t getEventsReceived() const;
+    uint64_t getEventsApplied() const;
+    uint64_t getEventsDropped() const;
+    uint64_t getMessagesSent() const;
+    uint64_t getBytesSent() const;
+    LEDLatencyStats getLatencyStats() const;
+};
+
+#endif // MIDI_HANDLER_H
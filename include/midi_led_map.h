@@ -0,0 +1,91 @@
+#ifndef MIDI_LED_MAP_H
+#define MIDI_LED_MAP_H
+
+#include <cstdint>
+#include <string>
+#include "led_controller_base.h"
+#include "led_controller_display.h"
+
+// =============================================================================
+// MAPPING ENTRIES - What one note or controller number drives
+// =============================================================================
+
+// How the message value (velocity or CC value) becomes LED bytes
+enum class MidiLEDTransform : uint8_t {
+    NONE,            // Unmapped, the message is ignored
+    LEVEL,           // Value is the level of all bytes (0-127)
+    SWITCH,          // Value >= 64 turns all bytes fully on, below turns them off
+    COLOR_LEVEL,     // Matrix pad: fixed color, value is the level
+    PALETTE,         // Matrix pad: value selects the LEDColor, full level
+    DISPLAY_NUMBER,  // Display shows the value (0-99, higher shows 99)
+    DISPLAY_DOT      // Display dot, on at 64 and above
+};
+
+/*
+* One precomputed table entry
+* byte/count address the LED buffer directly (e.g. 2 bytes for a stop button,
+* 3 BRG bytes for a pad), so applying a message needs no position math.
+*/
+struct MidiLEDMapping {
+    MidiLEDTransform transform = MidiLEDTransform::NONE;
+    uint8_t byte = 0;        // First LED report byte
+    uint8_t count = 0;       // Bytes set to the level (LEVEL, SWITCH)
+    uint8_t param = 0;       // LEDColor (COLOR_LEVEL), display 1/2 (DISPLAY_DOT)
+};
+
+// =============================================================================
+// MIDI LED MAP CLASS - 128-entry note and controller tables
+// =============================================================================
+
+/*
+* Config file format, one mapping per line, '#' starts a comment:
+*
+*   note 36 matrix 1 1 color=red     # Pad (1,1), velocity is the red level
+*   note 52 matrix 1 1 palette       # Velocity selects the color (0 = black, 1 = red, ...)
+*   note 60 button SHIFT             # Velocity is the level
+*   note 68 stop 1 switch            # On/off at velocity 64
+*   cc 15 display number
+*   cc 16 display left_dot
+*   cc 17 display right_dot
+*
+* Rows, columns and stop buttons count from 1. Pads default to white. A
+* file replaces the whole map, a file with errors leaves the map unchanged.
+*/
+class MidiLEDMap {
+private:
+    MidiLEDMapping notes[128];
+    MidiLEDMapping controllers[128];
+
+    bool apply(const MidiLEDMapping& mapping, uint8_t value, DisplayController* display) const;
+
+public:
+    MidiLEDMap();
+
+    // Building the tables
+    void clear();
+    void loadDefaults();
+    bool loadFile(const std::string& path);
+    bool parseLine(const std::string& line, std::string& error);
+    bool setNoteMapping(int note, const MidiLEDMapping& mapping);
+    bool setControllerMapping(int controller, const MidiLEDMapping& mapping);
+    MidiLEDMapping getNoteMapping(int note) const;
+    MidiLEDMapping getControllerMapping(int controller) const;
+
+    // Applying messages - a table lookup and one buffer write
+    bool applyNote(uint8_t note, uint8_t velocity, DisplayController* display) const;
+    bool applyControlChange(uint8_t controller, uint8_t value, DisplayController* display) const;
+};
+
+// Mapping builders
+MidiLEDMapping makeMatrixMapping(int row, int col, LEDColor color);
+MidiLEDMapping makeMatrixPaletteMapping(int row, int col);
+MidiLEDMapping makeButtonMapping(LEDButton button, bool on_off = false);
+MidiLEDMapping makeStopMapping(int index, bool on_off = false);
+MidiLEDMapping makeDisplayNumberMapping();
+MidiLEDMapping makeDisplayDotMapping(int display);
+
+// Names used in config files (case-insensitive), also used by OSC. -1 = unknown
+int findLEDColorName(const char* name);
+int findLEDButtonName(const char* name);
+
+#endif // MIDI_LED_MAP_H
@@ -0,0 +1,39 @@
+#ifndef MIDI_SYSEX_H
+#define MIDI_SYSEX_H
+
+#include <cstdint>
+#include "led_controller_base.h"    // For LED_REPORT_SIZE
+
+// =============================================================================
+// CONSTANTS - LED frame SysEx format
+// =============================================================================
+
+/*
+* LED frames over SysEx, LED values are 7-bit so they go over MIDI as is:
+*
+*   Full frame:    F0 7D 46 31 01 <80 bytes: report bytes 1-80> F7
+*   Partial frame: F0 7D 46 31 02 (<start byte> <count> <count bytes>)... F7
+*
+* Report bytes: 1-8 right display, 9-16 left display, 17-24 buttons,
+* 25-72 matrix pads (B, R, G per pad), 73-80 stop buttons. A partial frame
+* may carry any number of runs. The whole message is applied as one frame
+* and sent with one report. Display bytes are raw segment levels.
+*/
+const uint8_t LED_SYSEX_MANUFACTURER = 0x7D;    // Non-commercial ID
+const uint8_t LED_SYSEX_DEVICE[2] = {0x46, 0x31};   // "F1"
+const uint8_t LED_SYSEX_FULL_FRAME = 0x01;
+const uint8_t LED_SYSEX_PARTIAL_FRAME = 0x02;
+const int LED_SYSEX_HEADER_SIZE = 5;            // F0, manufacturer, device x2, command
+const int LED_SYSEX_FULL_SIZE = LED_SYSEX_HEADER_SIZE + LED_REPORT_SIZE - 1 + 1;    // + F7
+
+// =============================================================================
+// FUNCTION DECLARATIONS
+// =============================================================================
+
+// Applies a frame message to the LED buffer (no flush)
+bool applyLEDSysEx(const uint8_t* message, int size);
+
+// Builds a full frame message from a report, returns its size (LED_SYSEX_FULL_SIZE)
+int encodeLEDSysExFrame(const unsigned char* report, uint8_t* message);
+
+#endif // MIDI_SYSEX_H
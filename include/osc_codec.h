@@ -0,0 +1,91 @@
+#ifndef OSC_CODEC_H
+#define OSC_CODEC_H
+
+#include <cstdint>
+
+// =============================================================================
+// CONSTANTS - OSC 1.0 packet format
+// =============================================================================
+
+const int OSC_MAX_PACKET_SIZE = 2048;       // Largest datagram sent or accepted
+const int OSC_MAX_ARGUMENTS = 8;            // Arguments a parsed message may carry
+const int OSC_MAX_BUNDLE_DEPTH = 4;         // Nested bundles accepted on input
+const char OSC_BUNDLE_TAG[8] = {'#', 'b', 'u', 'n', 'd', 'l', 'e', '\0'};
+const uint64_t OSC_TIMETAG_IMMEDIATE = 1;
+
+// =============================================================================
+// OSC WRITER CLASS - Messages and bundles into a caller-owned buffer
+// =============================================================================
+
+/*
+* Encodes straight into a fixed buffer, nothing is allocated. Strings are
+* padded and numbers written big-endian as the spec requires.
+*
+* A message is built with beginMessage(), one add*() call per type tag and
+* endMessage(). A message that does not fit is taken out again and
+* endMessage() returns false, so the caller can send the buffer and retry.
+* Inside a bundle every message is prefixed with its size.
+*/
+class OSCWriter {
+private:
+    uint8_t* buffer;
+    int capacity;
+    int size;
+    int message_start;      // Start of the open message, -1 = none
+    int message_count;
+    bool in_bundle;
+    bool overflow;          // The open message did not fit
+
+    void writeBytes(const void* bytes, int count);
+    void writePadded(const char* text);
+    void writeUInt32(uint32_t value);
+
+public:
+    OSCWriter(uint8_t* buffer, int capacity);
+
+    void reset();
+    void beginBundle(uint64_t timetag);
+    bool beginMessage(const char* address, const char* typetags);
+    void addInt(int32_t value);
+    void addFloat(float value);
+    void addString(const char* value);
+    bool endMessage();
+
+    const uint8_t* getData() const;
+    int getSize() const;
+    int getMessageCount() const;
+};
+
+// =============================================================================
+// OSC MESSAGE - A parsed message, pointing into the received datagram
+// =============================================================================
+
+struct OSCArgument {
+    char type;              // 'i', 'f', 's', 'T' or 'F'
+    int32_t int_value;      // Set for 'i', 'T' (1) and 'F' (0), converted for 'f'
+    float float_value;      // Set for 'f', converted for 'i', 'T' and 'F'
+    const char* string_value;   // Set for 's', nullptr otherwise
+};
+
+struct OSCMessage {
+    const char* address;
+    const char* typetags;   // Without the leading ','
+    OSCArgument arguments[OSC_MAX_ARGUMENTS];
+    int argument_count;
+    uint64_t timetag;       // Of the enclosing bundle, OSC_TIMETAG_IMMEDIATE if none
+};
+
+// Called once per message of a packet
+typedef void (*OSCMessageCallback)(const OSCMessage& message, void* user_data);
+
+// =============================================================================
+// FUNCTION DECLARATIONS
+// =============================================================================
+
+// Parses a datagram (message or bundle), returns the number of messages or -1 if malformed
+int parseOSCPacket(const uint8_t* data, int size, OSCMessageCallback callback, void* user_data);
+
+// Current time as an OSC (NTP) time tag: seconds since 1900 . 32-bit fraction
+uint64_t getOSCTimeTag();
+
+#endif // OSC_CODEC_H
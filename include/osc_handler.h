@@ -0,0 +1,129 @@
+#ifndef OSC_HANDLER_H
+#define OSC_HANDLER_H
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <netinet/in.h>             // For sockaddr_in
+#include "led_controller_base.h"
+#include "led_controller_display.h"
+#include "event_reactor.h"
+#include "osc_codec.h"
+
+// =============================================================================
+// CONSTANTS - Endpoint and address space
+// =============================================================================
+
+const char OSC_HOST[] = "127.0.0.1";        // Local only, no network exposure
+const int OSC_DEFAULT_LISTEN_PORT = 9000;   // External software -> F1 LEDs
+const int OSC_DEFAULT_SEND_PORT = 9001;     // F1 -> external software
+const int OSC_ANALOG_CONTROL_COUNT = 8;     // Knobs 0-3, faders 4-7
+const int OSC_ANALOG_DEADBAND = 2;          // Raw 12-bit steps ignored as ADC noise
+
+/*
+* Output, one bundle per input report, time tagged with the time the report
+* was read. Rows, columns and indices are 0-based like the C++ API:
+*
+*   /f1/matrix  ,iii  row col pressed(0/1)
+*   /f1/button  ,si   name pressed      (SHIFT, REVERSE, ... WHEEL for the wheel press)
+*   /f1/stop    ,ii   index pressed
+*   /f1/knob    ,if   index value       (0.0 - 1.0, full 12-bit resolution)
+*   /f1/fader   ,if   index value
+*   /f1/wheel   ,i    +1 clockwise, -1 counter-clockwise
+*
+* Input, all messages of one datagram (bundles included) make one LED frame:
+*
+*   /f1/led/matrix   ,iis[f]  row col color-name [brightness]
+*   /f1/led/matrix   ,iifff   row col red green blue (0.0 - 1.0)
+*   /f1/led/button   ,sf      name brightness   (or ,if with the LEDButton index)
+*   /f1/led/stop     ,if      index brightness
+*   /f1/display/number ,i     value (scrolls if it has more than two digits)
+*   /f1/display/text   ,s     text (two characters, longer texts scroll)
+*   /f1/display/dot    ,ii    display(1 = left, 2 = right) on
+*
+* Integer and float arguments are interchangeable on input.
+*/
+
+// =============================================================================
+// OSC HANDLER CLASS - UDP endpoint for controller events and LEDs
+// =============================================================================
+
+/*
+* Events are encoded into a fixed buffer on the input thread (no allocation)
+* and flushOutput() sends them as one bundle per report. A receive thread
+* waits on the socket and applies each datagram as one LED frame with one
+* flush, like the MIDI LED thread. With attachReactor() the socket is
+* watched by the reactor instead of the receive thread.
+*/
+class OSCHandler {
+private:
+    int socket_fd;                            // -1 = closed
+    int wake_pipe[2];                         // Wakes the receive thread on cleanup
+    sockaddr_in send_address;
+    DisplayController* display;               // Target of /f1/display, may be null
+    LEDCommandHook led_command_hook;          // Called before /f1/led commands are painted, may be null
+    void* led_command_user_data;
+
+    std::thread receive_thread;
+    std::atomic<bool> running;
+    EventReactor* reactor;                    // Watches the socket instead of the thread, may be null
+
+    // Output side, used by the input thread only
+    uint8_t output_buffer[OSC_MAX_PACKET_SIZE];
+    OSCWriter writer;
+    uint64_t report_timetag;                  // Time tag of the bundle being built
+    int analog_raw[OSC_ANALOG_CONTROL_COUNT]; // Last raw value sent, -1 = none
+
+    // Input side, used by the receive thread (or the reactor) only
+    uint8_t input_buffer[OSC_MAX_PACKET_SIZE];
+    int applied_in_packet;
+
+    std::atomic<uint64_t> messages_sent;
+    std::atomic<uint64_t> bundles_sent;
+    std::atomic<uint64_t> messages_received;
+    std::atomic<uint64_t> messages_applied;
+    std::atomic<uint64_t> packets_rejected;
+
+    // Helper functions
+    void sendEvent(const char* address, const char* typetags, const OSCArgument* arguments);
+    bool applyMessage(const OSCMessage& message);
+    static void onMessage(const OSCMessage& message, void* user_data);
+    void receiveLoop();
+    void receivePending();
+    void stopReceiveThread();
+    static void onReactorReadable(int fd, uint32_t events, void* user_data);
+
+public:
+    OSCHandler();
+    ~OSCHandler();
+
+    // Setup
+    bool initializeOSC(int listen_port = OSC_DEFAULT_LISTEN_PORT, int send_port = OSC_DEFAULT_SEND_PORT,
+                       DisplayController* display = nullptr);
+    void cleanup();
+    bool isOpen() const;
+    bool attachReactor(EventReactor& reactor);
+    void detachReactor();
+    void setLEDCommandHook(LEDCommandHook hook, void* user_data);
+
+    // Input -> OSC (call from the input thread)
+    void beginReport();
+    void sendMatrixButton(int row, int col, bool pressed);
+    void sendButton(const char* name, bool pressed);
+    void sendStopButton(int index, bool pressed);
+    void sendAnalogControl(int control, uint16_t raw_value);
+    void sendWheel(bool clockwise);
+    void flushOutput();
+
+    // OSC -> LEDs
+    int receivePacket(const uint8_t* data, int size);
+
+    // Statistics
+    uint64_t getMessagesSent() const;
+    uint64_t getBundlesSent() const;
+    uint64_t getMessagesReceived() const;
+    uint64_t getMessagesApplied() const;
+    uint64_t getPacketsRejected() const;
+};
+
+#endif // OSC_HANDLER_H
@@ -0,0 +1,56 @@
+#ifndef REALTIME_MODE_H
+#define REALTIME_MODE_H
+
+#include <pthread.h>
+
+// =============================================================================
+// CONSTANTS - Real-time defaults
+// =============================================================================
+
+const int REALTIME_DEFAULT_PRIORITY = 70;           // SCHED_FIFO 1-99, above audio-less apps, below IRQ threads
+const int REALTIME_DEFAULT_STACK_PREFAULT_KB = 256; // Stack the I/O thread may use without page faults
+const int REALTIME_DEFAULT_HEAP_PREFAULT_KB = 4096; // Heap kept mapped and locked for later allocations
+
+// =============================================================================
+// REALTIME CONFIG AND STATUS
+// =============================================================================
+
+struct RealtimeConfig {
+    int priority = REALTIME_DEFAULT_PRIORITY;       // SCHED_FIFO priority, 0 = keep the current policy
+    int cpu = -1;                                   // CPU to pin the thread to, -1 = no pinning
+    bool lock_memory = true;                        // mlockall() current and future memory
+    int stack_prefault_kb = REALTIME_DEFAULT_STACK_PREFAULT_KB;
+    int heap_prefault_kb = REALTIME_DEFAULT_HEAP_PREFAULT_KB;
+};
+
+/*
+* What took effect. The *_error fields hold the errno of a setting that
+* failed (EPERM without privileges, ENOTSUP where the OS lacks it), 0 if it
+* worked or was not requested.
+*/
+struct RealtimeStatus {
+    bool scheduling;            // Thread runs SCHED_FIFO at priority
+    int scheduling_error;
+    int priority;
+    bool affinity;              // Thread is pinned to cpu
+    int affinity_error;
+    int cpu;
+    bool memory_locked;         // mlockall() succeeded
+    int memory_error;
+    bool stack_prefaulted;
+    bool heap_prefaulted;       // Heap reserved, and kept (not trimmed) by malloc, only with memory_locked
+};
+
+// =============================================================================
+// REALTIME FUNCTIONS
+// =============================================================================
+
+// Calling thread: scheduling, affinity, memory locking and prefaulting
+RealtimeStatus enableRealtimeThread(const RealtimeConfig& config);
+
+// Another thread: scheduling and affinity only (memory settings are per process)
+bool setThreadRealtime(pthread_t thread, int priority, int cpu, RealtimeStatus* status = nullptr);
+
+void printRealtimeStatus(const char* thread_name, const RealtimeStatus& status);
+
+#endif // REALTIME_MODE_H
@@ -3,7 +3,13 @@
 
 #include <hidapi/hidapi.h>
 #include <stdint.h>
+#include "led_animation.h"
 
+const int STARTUP_STEP_MS = 50;     // Time between two animation steps
+
+LEDAnimation makeStartupAnimation(int tick_ms = LED_ANIMATION_DEFAULT_TICK_MS);
+void applyStartupFinalState();
+void playStartupSequence(LEDAnimationEngine& engine);
 void startupSequence(hid_device *handle);
 
-#endif
\ No newline at end of file
+#endif
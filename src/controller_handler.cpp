@@ -1,11 +1,32 @@
 #include "controller_handler.h"
 
-ControllerHandler::ControllerHandler() : current_effect_page(1), display_controller(), wheel_input_reader() {
+#include <cstdio>               // For sscanf
+#include <cstring>              // For strncmp
+#include <dirent.h>             // For opendir, readdir
+#include <fcntl.h>              // For open
+#include <fstream>              // For std::ifstream
+#include <thread>               // For std::this_thread::sleep_for
+#include <unistd.h>             // For read, close
+
+ControllerHandler::ControllerHandler() : current_effect_page(1), device(nullptr), display_controller(), wheel_input_reader(), page_scenes_enabled(false) {
     // Constructor initializes pointers to null and sets initialized to false
     // =============================================================================
     // START UP SEQUENCE
     // =============================================================================
 
+    // Measure how long it takes until the app sees its first input
+    construct_time = std::chrono::steady_clock::now();
+    startup_timing = {-1.0, -1.0};
+    shared_state = {};
+    startup_animation_id = 0;
+    event_loop_stop = false;
+    hid_notify_fd = -1;
+
+    // External LED commands (MIDI, OSC, the daemon) also stop the startup wave
+    midi_handler.setLEDCommandHook(onExternalLEDCommand, this);
+    osc_handler.setLEDCommandHook(onExternalLEDCommand, this);
+    daemon_server.setLEDCommandHook(onExternalLEDCommand, this);
+
     // create start up message
     std::cout << "" << std::endl;
     std::cout << "=== Starting Visual Sync Kontrol F1 ===" << std::endl;
@@ -30,16 +51,26 @@ ControllerHandler::ControllerHandler() : current_effect_page(1), display_control
         // Initialize the LED controller
         initializeLEDController(device);
 
-        // Run startup sequence
-        startupSequence(device);
+        // Hand the LED write side to the writer thread
+        if (led_writer.start(device)) {
+            setLEDOutputWriter(&led_writer);
+        }
+
+        // Start the animation engine, the startup wave plays in the background
+        // and is cancelled by the first LED command of the app
+        animation_engine.start();
+        startup_animation_id.store(animation_engine.play(makeStartupAnimation(animation_engine.getTickMs())));
+        std::cout << "  - Startup LED sequence playing in background..." << std::endl;
 
         // Initialize wheel input reader and set first page
         wheel_input_reader.initialize();
 
-        // Set first effects page on display
+        // Set final button state and first effects page on display
         // Turn on left dot to indicate page is loaded
+        applyStartupFinalState();
         display_controller.setDisplayNumber(current_effect_page);
         display_controller.setDisplayDot(1, true);
+        flushLEDReport();
 
         // Send success message
         std::cout << "" << std::endl;
@@ -57,10 +88,19 @@ ControllerHandler::ControllerHandler() : current_effect_page(1), display_control
     std::cout << "+++ Press Ctrl+C to exit. +++" << std::endl;
     std::cout << "" << std::endl;
 
+    startup_timing.constructor_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - construct_time).count();
 }
 
 ControllerHandler::~ControllerHandler() {
     // Destructor ensures cleanup is called
+    midi_handler.cleanup();
+    osc_handler.cleanup();
+    state_publisher.close();
+    daemon_server.stop();
+    animation_engine.stop();
+    setLEDBeatClock(nullptr);
+    setLEDOutputWriter(nullptr);
+    led_writer.stop();
 }
 
 void ControllerHandler::setDelegate(ControllerDelegate *delegate){
@@ -68,6 +108,16 @@ void ControllerHandler::setDelegate(ControllerDelegate *delegate){
 }
 
 void ControllerHandler::close() {
+    // Stop the LED threads before the device goes away
+    midi_handler.cleanup();
+    osc_handler.cleanup();
+    state_publisher.close();
+    daemon_server.stop();
+    animation_engine.stop();
+    setLEDBeatClock(nullptr);
+    setLEDOutputWriter(nullptr);
+    led_writer.stop();
+
     // Close the device
     hid_close(device);
 
@@ -81,12 +131,23 @@ bool ControllerHandler::run() {
         // =======================================
         unsigned char input_report_buffer[INPUT_REPORT_SIZE];
         if (!readInputReport(device, input_report_buffer)) {
+            // No new input, but LED changes made since the last call still go out
+            flushLEDReportIfDue();
             return false;
         }
 
+        // First input report: the app can use the controller from now on
+        if (startup_timing.first_event_ms < 0.0) {
+            startup_timing.first_event_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - construct_time).count();
+            std::cout << "- First input event " << startup_timing.first_event_ms << " ms after start (constructor took "
+                      << startup_timing.constructor_ms << " ms)" << std::endl;
+        }
+
         // =======================================
         // MIDI: Process matrix button changes
         // =======================================
+        osc_handler.beginReport();
+        daemon_server.beginReport();
         updateButtons(input_report_buffer);
         updateMatrixButtonStates(input_report_buffer);
         updateKnobStates(input_report_buffer);
@@ -97,41 +158,682 @@ bool ControllerHandler::run() {
         // =======================================
         WheelDirection selector_wheel_direction = wheel_input_reader.checkWheelRotation(input_report_buffer);
 
+        if (selector_wheel_direction != WheelDirection::NONE) {
+            midi_handler.sendWheelMIDI(selector_wheel_direction == WheelDirection::CLOCKWISE);
+            osc_handler.sendWheel(selector_wheel_direction == WheelDirection::CLOCKWISE);
+            daemon_server.addWheel(selector_wheel_direction == WheelDirection::CLOCKWISE);
+        }
         if (selector_wheel_direction == WheelDirection::CLOCKWISE) {
             current_effect_page = std::min(current_effect_page + 1, 99);
+            daemon_server.addPage(current_effect_page);
+            activatePageScene();
             delegate->onWheelChanged(current_effect_page);
         } else if (selector_wheel_direction == WheelDirection::COUNTER_CLOCKWISE) {
             current_effect_page = std::max(current_effect_page - 1, 1);
+            daemon_server.addPage(current_effect_page);
+            activatePageScene();
             delegate->onWheelChanged(current_effect_page);
         }
 
+        // =======================================
+        // Publish the decoded state for local consumers
+        // =======================================
+        publishState(input_report_buffer, selector_wheel_direction);
+
+        // =======================================
+        // Send this iteration's analog MIDI values, OSC as one bundle, all LED changes as one report
+        // =======================================
+        midi_handler.flushOutput();
+        osc_handler.flushOutput();
+        daemon_server.endReport();
+        flushLEDReportIfDue();
 
         return true;
 }
 
+/*
+* Stops the background startup wave when the app sends its first LED command
+* The matrix pads the wave may have left lit are cleared in a frame that is
+* left open for the command: the caller paints its command and then calls
+* commitLEDFrame(), so the clear and the command go out in one report and
+* the app starts from a dark matrix.
+*
+* @return: true if a frame was opened, the caller must commit it
+*/
+bool ControllerHandler::cancelStartupAnimation() {
+    if (startup_animation_id.load() == 0) {
+        return false;   // Common case, no lock and no frame
+    }
+    int id = startup_animation_id.exchange(0);
+    if (id == 0 || !animation_engine.isPlaying(id)) {
+        return false;
+    }
+    beginLEDFrame();
+    animation_engine.cancel(id);
+    for (int row = 0; row < MATRIX_ROWS; row++) {
+        for (int col = 0; col < MATRIX_COLS; col++) {
+            setMatrixButtonLEDLevel(row, col, LEDColor::black, 0, false);
+        }
+    }
+    return true;
+}
+
+/*
+* LED command hook of the MIDI, OSC and daemon paths
+* They call it inside their own open frame, so the nested commit here only
+* merges the clear into that frame and it goes out with their command.
+*
+* @param user_data: The ControllerHandler
+*/
+void ControllerHandler::onExternalLEDCommand(void* user_data) {
+    if (static_cast<ControllerHandler*>(user_data)->cancelStartupAnimation()) {
+        commitLEDFrame();
+    }
+}
+
+/*
+* Shows the scene of the current page if page scenes are enabled
+* Only swaps the LED buffer, the page change goes out with the next flush.
+*/
+void ControllerHandler::activatePageScene() {
+    if (!page_scenes_enabled || scene_cache.getActivePage() == current_effect_page) {
+        return;
+    }
+    bool cancelled = cancelStartupAnimation();
+    scene_cache.activatePage(current_effect_page);
+    if (cancelled) {
+        commitLEDFrame();
+    }
+}
+
+StartupTiming ControllerHandler::getStartupTiming() const {
+    return startup_timing;
+}
+
 void ControllerHandler::setStopButton(int index, float brightness) {
-    setStopButtonLED(index, brightness);
+    bool cancelled = cancelStartupAnimation();
+    if (page_scenes_enabled) {
+        scene_cache.setStopButton(current_effect_page, index, brightness);
+    } else {
+        setStopButtonLED(index, brightness);
+    }
+    if (cancelled) {
+        commitLEDFrame();
+    }
 }
 
 void ControllerHandler::setMatrixButton(int row, int col, BRGColor color, float brightness) {
-    setMatrixButtonLED(row, col, color, brightness, false);
+    bool cancelled = cancelStartupAnimation();
+    if (page_scenes_enabled) {
+        scene_cache.setMatrixButton(current_effect_page, row, col, color, brightness);
+    } else {
+        setMatrixButtonLED(row, col, color, brightness, false);
+    }
+    if (cancelled) {
+        commitLEDFrame();
+    }
 }
 
 void ControllerHandler::setMatrixButton(int row, int col, LEDColor color, float brightness) {
-    setMatrixButtonLED(row, col, color, brightness, false);
+    bool cancelled = cancelStartupAnimation();
+    if (page_scenes_enabled) {
+        scene_cache.setMatrixButton(current_effect_page, row, col, color, brightness);
+    } else {
+        // Stored, so blink and pulse modes follow the new color
+        setMatrixButtonLED(row, col, color, brightness, true);
+    }
+    if (cancelled) {
+        commitLEDFrame();
+    }
 }
 
 void ControllerHandler::setPage(int page) {
     current_effect_page = page;
+
+    // Wave clear, scene, dot and both digits are published together
+    beginLEDFrame();
+    bool cancelled = cancelStartupAnimation();
+    activatePageScene();
     display_controller.setDisplayDot(1, false);
     display_controller.setDisplayNumber(current_effect_page);
+    if (cancelled) {
+        commitLEDFrame();
+    }
+    commitLEDFrame();
+}
+
+// Shown until the next page change puts the page number back
+void ControllerHandler::setDisplayText(char left, char right) {
+    display_controller.setDisplayText(left, right);
+}
+
+void ControllerHandler::setDisplayHex(uint8_t code) {
+    display_controller.setDisplayHex(code);
+}
+
+// Long values and texts scroll on the animation tick
+void ControllerHandler::setDisplayValue(int value, int step_ms, int repeat) {
+    display_controller.setDisplayValue(value, step_ms, repeat);
+}
+
+void ControllerHandler::scrollDisplayText(const std::string& text, int step_ms, int repeat) {
+    display_controller.scrollDisplayText(text, step_ms, repeat);
 }
 
 void ControllerHandler::setButton(LEDButton button, float brightness) {
-    setButtonLED(button, brightness);
+    bool cancelled = cancelStartupAnimation();
+    if (page_scenes_enabled) {
+        scene_cache.setButton(current_effect_page, button, brightness);
+    } else {
+        setButtonLED(button, brightness);
+    }
+    if (cancelled) {
+        commitLEDFrame();
+    }
+}
+
+/*
+* Switches to per-page LED scenes
+* While enabled, each page keeps its own button LEDs. setMatrixButton(),
+* setButton() and setStopButton() change the current page, setPage*() any
+* page, and a page change swaps the whole scene in with one report.
+* LEDs set over MIDI, SysEx, OSC or the daemon belong to the page that is
+* shown when they arrive, and are saved with it when the page is left.
+* When disabled, the LEDs keep showing the last page.
+*
+* @param enabled: true to use page scenes, false for a single shared set of LEDs
+*/
+void ControllerHandler::enablePageScenes(bool enabled) {
+    page_scenes_enabled = enabled;
+    if (enabled) {
+        activatePageScene();
+    } else {
+        scene_cache.deactivate();
+    }
+}
+
+void ControllerHandler::setPageMatrixButton(int page, int row, int col, LEDColor color, float brightness) {
+    scene_cache.setMatrixButton(page, row, col, color, brightness);
+}
+
+void ControllerHandler::setPageButton(int page, LEDButton button, float brightness) {
+    scene_cache.setButton(page, button, brightness);
+}
+
+void ControllerHandler::setPageStopButton(int page, int index, float brightness) {
+    scene_cache.setStopButton(page, index, brightness);
+}
+
+/*
+* Layer wrappers - BASE is what setMatrixButton() etc. paint, OVERLAY and
+* FEEDBACK are composited on top and uncover it again when cleared
+*/
+void ControllerHandler::setLayerMatrixButton(LEDLayer layer, int row, int col, LEDColor color, float brightness) {
+    if (layer == LEDLayer::BASE) {
+        setMatrixButton(row, col, color, brightness);
+        return;
+    }
+    setLayerMatrixButtonLED(layer, row, col, color, brightness);
+}
+
+void ControllerHandler::setLayerButton(LEDLayer layer, LEDButton button, float brightness) {
+    if (layer == LEDLayer::BASE) {
+        setButton(button, brightness);
+        return;
+    }
+    setLayerButtonLED(layer, button, brightness);
+}
+
+void ControllerHandler::setLayerStopButton(LEDLayer layer, int index, float brightness) {
+    if (layer == LEDLayer::BASE) {
+        setStopButton(index, brightness);
+        return;
+    }
+    setLayerStopButtonLED(layer, index, brightness);
+}
+
+void ControllerHandler::clearLayer(LEDLayer layer) {
+    clearLEDLayer(layer);
+}
+
+void ControllerHandler::setLayerOpacity(LEDLayer layer, float opacity) {
+    setLEDLayerOpacity(layer, opacity);
+}
+
+void ControllerHandler::setLayerBlendMode(LEDLayer layer, LEDBlendMode mode) {
+    setLEDLayerBlendMode(layer, mode);
+}
+
+/*
+* Reflex wrappers - configured LEDs light up on press in the same run()
+* iteration, before the delegate is called, and are restored on release.
+* Safe to call from any thread.
+*/
+void ControllerHandler::setMatrixReflex(int row, int col, LEDReflex reflex) {
+    reflex_table.setMatrixReflex(row, col, reflex);
+}
+
+void ControllerHandler::setButtonReflex(LEDButton button, LEDReflex reflex) {
+    reflex_table.setButtonReflex(button, reflex);
+}
+
+void ControllerHandler::setStopReflex(int index, LEDReflex reflex) {
+    reflex_table.setStopReflex(index, reflex);
+}
+
+void ControllerHandler::clearReflexes() {
+    reflex_table.clear();
+}
+
+/*
+* LED mode wrappers - blinking and pulsing run on the animation tick,
+* setting a mode only stores it and never writes to the device.
+* LEDModeSync::BEAT modes follow the MIDI clock once enableMIDI() ran.
+*/
+void ControllerHandler::setMatrixButtonMode(int row, int col, LEDMode mode, float rate_hz, float phase, LEDModeSync sync) {
+    bool cancelled = cancelStartupAnimation();
+    setMatrixButtonLEDMode(row, col, mode, rate_hz, phase, sync);
+    if (cancelled) {
+        commitLEDFrame();
+    }
+}
+
+void ControllerHandler::setButtonMode(LEDButton button, LEDMode mode, float rate_hz, float phase, LEDModeSync sync) {
+    bool cancelled = cancelStartupAnimation();
+    setButtonLEDMode(button, mode, rate_hz, phase, sync);
+    if (cancelled) {
+        commitLEDFrame();
+    }
+}
+
+void ControllerHandler::setStopButtonMode(int index, LEDMode mode, float rate_hz, float phase, LEDModeSync sync) {
+    bool cancelled = cancelStartupAnimation();
+    setStopButtonLEDMode(index, mode, rate_hz, phase, sync);
+    if (cancelled) {
+        commitLEDFrame();
+    }
+}
+
+bool ControllerHandler::flush() {
+    return flushLEDReport();
+}
+
+void ControllerHandler::beginFrame() {
+    beginLEDFrame();
+}
+
+bool ControllerHandler::commitFrame() {
+    return commitLEDFrame();
+}
+
+int ControllerHandler::playAnimation(const LEDAnimation& animation) {
+    if (cancelStartupAnimation()) {
+        commitLEDFrame();
+    }
+    return animation_engine.play(animation);
+}
+
+void ControllerHandler::cancelAnimation(int id) {
+    animation_engine.cancel(id);
+}
+
+void ControllerHandler::setFlushPolicy(LEDFlushPolicy policy, int max_frame_rate) {
+    setLEDFlushPolicy(policy, max_frame_rate);
+}
+
+void ControllerHandler::setLEDFrameRate(int frame_rate) {
+    led_writer.setFrameRate(frame_rate);
+}
+
+void ControllerHandler::setLEDRefreshInterval(int refresh_ms) {
+    ::setLEDRefreshInterval(refresh_ms);
+}
+
+void ControllerHandler::setBrightnessCurve(LEDGroup group, LEDBrightnessCurve curve, float gamma) {
+    setLEDGroupCurve(group, curve, gamma);
+}
+
+/*
+* Turns temporal dithering on or off for an LED group
+* Dithering needs frames at the highest rate the device takes, so enabling
+* it raises the writer to LED_WRITER_MAX_FRAME_RATE. The rate that is
+* actually reached is reported by getDitherFrameRate().
+*/
+void ControllerHandler::setDithering(LEDGroup group, bool enabled) {
+    if (enabled) {
+        led_writer.setFrameRate(LED_WRITER_MAX_FRAME_RATE);
+    }
+    setLEDGroupDithering(group, enabled);
+}
+
+int ControllerHandler::getDitherFrameRate() const {
+    return led_writer.getDitherFrameRate();
+}
+
+/*
+* Opens the virtual MIDI ports: input goes out on F1_Controller_Out, LED
+* and display messages come in on F1_Controller_In
+*
+* @param open_ports: false only starts the MIDI LED path, for apps that run
+*                    their own RtMidiIn and forward it with mycallback()
+* @return: true if MIDI is running
+*/
+bool ControllerHandler::enableMIDI(bool open_ports) {
+    if (!midi_handler.initializeMIDI(&display_controller, open_ports)) {
+        return false;
+    }
+    setLEDBeatClock(midi_handler.getClock());    // Incoming MIDI clock drives BEAT modes
+    return true;
+}
+
+/*
+* Forwards a message from the app's own RtMidiIn to the MIDI LED path
+* Same format as an RtMidi callback. Must not be used together with the
+* ports of enableMIDI(true), the queue takes one producer.
+*/
+void ControllerHandler::mycallback(double deltatime, std::vector<unsigned char> *message) {
+    MidiHandler::receiveLEDMIDI(deltatime, message, &midi_handler);
+}
+
+// Note/CC to LED mapping, see midi_led_map.h for the file format
+bool ControllerHandler::loadMIDILEDMap(const std::string& path) {
+    return midi_handler.loadLEDMap(path);
+}
+
+// =============================================================================
+// EVENT LOOP - Optional single-threaded driver (epoll)
+// =============================================================================
+
+/*
+* Finds the hidraw node of a vendor/product in sysfs
+* For hidapi backends whose paths are not hidraw nodes (libusb). Nothing is
+* found if that backend detached the kernel driver.
+*
+* @return: Node path, empty if none
+*/
+static std::string findHIDRawNode(unsigned short vendor_id, unsigned short product_id) {
+    DIR* directory = opendir("/sys/class/hidraw");
+    if (directory == nullptr) {
+        return "";
+    }
+    std::string node;
+    while (node.empty()) {
+        dirent* entry = readdir(directory);
+        if (entry == nullptr) {
+            break;
+        }
+        if (strncmp(entry->d_name, "hidraw", 6) != 0) {
+            continue;
+        }
+
+        // uevent holds HID_ID=<bus>:<vendor>:<product> in hex
+        std::ifstream uevent(std::string("/sys/class/hidraw/") + entry->d_name + "/device/uevent");
+        std::string line;
+        while (std::getline(uevent, line)) {
+            unsigned int bus = 0, vendor = 0, product = 0;
+            if (sscanf(line.c_str(), "HID_ID=%x:%x:%x", &bus, &vendor, &product) == 3) {
+                if (vendor == vendor_id && product == product_id) {
+                    node = std::string("/dev/") + entry->d_name;
+                }
+                break;
+            }
+        }
+    }
+    closedir(directory);
+    return node;
+}
+
+/*
+* Opens a second read handle on the device's hidraw node
+* hidraw hands every report to every open handle, so this one only tells
+* the reactor that hid_read() has something. The hidraw backend's path is
+* the node itself, for other backends the node is looked up in sysfs.
+*
+* @return: Descriptor, -1 if the device has no hidraw node
+*/
+static int openHIDNotifier() {
+    std::string node;
+    hid_device_info* devices = hid_enumerate(VENDOR_ID, PRODUCT_ID);
+    if (devices != nullptr && devices->path != nullptr && strncmp(devices->path, "/dev/hidraw", 11) == 0) {
+        node = devices->path;
+    }
+    hid_free_enumeration(devices);
+    if (node.empty()) {
+        node = findHIDRawNode(VENDOR_ID, PRODUCT_ID);
+    }
+    return node.empty() ? -1 : open(node.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+}
+
+/*
+* Drives input, animations, MIDI, OSC and the daemon from the calling thread
+* Input wakes the loop through the hidraw node. Without one (no hidraw
+* driver for the device) input is polled every input_poll_ms, which costs
+* 1000 / input_poll_ms wakeups per second even when idle.
+*
+* @param input_poll_ms: Input polling period when there is no hidraw node
+* @return: false if no device is connected
+*/
+bool ControllerHandler::runEventLoop(int input_poll_ms) {
+    if (device == nullptr) {
+        return false;
+    }
+    if (input_poll_ms < 1) input_poll_ms = 1;
+
+    // Step 1: No epoll, poll run() instead
+    if (!reactor.open()) {
+        std::cerr << "Warning: Event loop unavailable, polling input every " << input_poll_ms << " ms" << std::endl;
+        while (!event_loop_stop.exchange(false)) {
+            if (!run()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(input_poll_ms));
+            }
+        }
+        return true;
+    }
+
+    // Step 2: Input reports wake the loop, or a short timer polls for them
+    hid_notify_fd = openHIDNotifier();
+    if (hid_notify_fd >= 0 && !reactor.addReader(hid_notify_fd, &ControllerHandler::onReactorHID, this)) {
+        ::close(hid_notify_fd);
+        hid_notify_fd = -1;
+    }
+    if (hid_notify_fd < 0) {
+        std::cerr << "Warning: No hidraw node for the device, polling input every " << input_poll_ms << " ms" << std::endl;
+        reactor.addTimer(input_poll_ms, &ControllerHandler::onReactorInputPoll, this);
+    }
+
+    // Step 3: Animations and LED modes tick on a timerfd instead of their thread
+    int tick_ms = animation_engine.getTickMs();
+    bool engine_was_running = animation_engine.isRunning();
+    animation_engine.stop();
+    reactor.addTimer(tick_ms, &ControllerHandler::onReactorTick, this);
+
+    // Step 4: Incoming MIDI, OSC and daemon clients
+    bool midi = midi_handler.attachReactor(reactor);
+    bool osc = osc_handler.attachReactor(reactor);
+    bool daemon = daemon_server.attachReactor(reactor);
+    std::cout << "- Event loop running (input " << (hid_notify_fd >= 0 ? "hidraw" : "polled")
+              << (midi ? ", MIDI" : "") << (osc ? ", OSC" : "") << (daemon ? ", daemon" : "") << ")" << std::endl;
+
+    // Step 5: Dispatch until stopEventLoop()
+    event_loop_stop = false;
+    processPendingInput();
+    reactor.run();
+
+    // Step 6: Back to the threaded mode, run() works as before; the tick
+    // thread only comes back if it was running before the loop
+    daemon_server.detachReactor();
+    osc_handler.detachReactor();
+    midi_handler.detachReactor();
+    if (hid_notify_fd >= 0) {
+        reactor.remove(hid_notify_fd);
+        ::close(hid_notify_fd);
+        hid_notify_fd = -1;
+    }
+    reactor.close();
+    if (engine_was_running) {
+        animation_engine.start(tick_ms);
+    }
+    return true;
+}
+
+/*
+* Ends runEventLoop() after the current callback, safe from any thread
+*/
+void ControllerHandler::stopEventLoop() {
+    event_loop_stop = true;
+    reactor.stop();
+}
+
+EventReactorStats ControllerHandler::getEventLoopStats() const {
+    return reactor.getStats();
+}
+
+/*
+* Makes the calling thread the driver's real-time I/O thread
+* Call it on the thread that will call runEventLoop() (or run()), after
+* enabling MIDI, OSC and the daemon so their buffers are already allocated
+* and get locked. The LED writer thread gets the priority below it on the
+* same CPU. Settings that need privileges the process lacks are skipped
+* and reported, the driver then runs as before.
+*
+* SCHED_FIFO does not yield to normal threads: use runEventLoop() or a loop
+* that blocks, a run() loop that spins would hold its CPU.
+*
+* @param config: Settings to apply, see realtime_mode.h
+* @return: What took effect for this thread
+*/
+RealtimeStatus ControllerHandler::enableRealtime(const RealtimeConfig& config) {
+    RealtimeStatus status = enableRealtimeThread(config);
+    printRealtimeStatus("I/O", status);
+    if (led_writer.isRunning()) {
+        RealtimeStatus writer_status;
+        led_writer.setRealtime(config.priority > 1 ? config.priority - 1 : config.priority, config.cpu, &writer_status);
+        printRealtimeStatus("LED writer", writer_status);
+    }
+    return status;
+}
+
+// Handles every report that is waiting, run() returns false once none is left
+void ControllerHandler::processPendingInput() {
+    while (run()) {
+    }
+}
+
+void ControllerHandler::onReactorHID(int fd, uint32_t events, void* user_data) {
+    ControllerHandler* handler = static_cast<ControllerHandler*>(user_data);
+    if (events & (EVENT_HANGUP | EVENT_ERROR)) {
+        std::cerr << "Error: Device disconnected, stopping the event loop" << std::endl;
+        handler->stopEventLoop();
+        return;
+    }
+    // The copies on this handle are not needed, hid_read() gets the reports
+    unsigned char discard[INPUT_REPORT_SIZE * 8];
+    while (read(fd, discard, sizeof(discard)) > 0) {
+    }
+    handler->processPendingInput();
+}
+
+void ControllerHandler::onReactorInputPoll(int fd, uint32_t count, void* user_data) {
+    (void)fd;
+    (void)count;
+    static_cast<ControllerHandler*>(user_data)->processPendingInput();
+}
+
+// Animation tick, also sends LED changes the flush policy held back
+void ControllerHandler::onReactorTick(int fd, uint32_t count, void* user_data) {
+    (void)fd;
+    (void)count;
+    ControllerHandler* handler = static_cast<ControllerHandler*>(user_data);
+    handler->animation_engine.tick();
+    flushLEDReportIfDue();
+}
+
+/*
+* Selects 7-bit CC, 14-bit CC or NRPN output for a knob (0-3) or fader (4-7)
+*/
+void ControllerHandler::setMIDIAnalogMode(int control, MidiAnalogMode mode) {
+    midi_handler.setAnalogMode(control, mode);
+}
+
+/*
+* Opens the OSC endpoint on localhost, see osc_handler.h for the addresses
+* Input events go out as one bundle per report, LED messages are applied
+* like MIDI. Can be used together with MIDI.
+*
+* @param listen_port: Port for LED and display messages
+* @param send_port: Port controller events are sent to
+* @return: true if OSC is running
+*/
+bool ControllerHandler::enableOSC(int listen_port, int send_port) {
+    return osc_handler.initializeOSC(listen_port, send_port, &display_controller);
+}
+
+/*
+* Shares the state of all controls in POSIX shared memory, updated once per
+* input report. Other processes read it with ControllerStateReader, see
+* controller_state_shm.h. The segment is removed by close().
+*
+* @param name: Shared memory name
+* @return: true if the segment was created
+*/
+bool ControllerHandler::enableStateSharing(const std::string& name) {
+    return state_publisher.open(name);
+}
+
+/*
+* Serves controller events to any number of local processes over a Unix
+* socket, see daemon_server.h for the protocol. Clients can claim LED groups
+* and drive them. A slow client only loses its own events. Can be used
+* together with MIDI and OSC.
+*
+* @param path: Socket path
+* @param group: Group allowed to connect besides the owner, empty for none
+* @return: true if serving
+*/
+bool ControllerHandler::enableDaemon(const std::string& path, const std::string& group) {
+    return daemon_server.start(path, &display_controller, group);
+}
+
+std::vector<DaemonClientStats> ControllerHandler::getDaemonClientStats() {
+    return daemon_server.getClientStats();
+}
+
+LEDLatencyStats ControllerHandler::getMIDILatency() const {
+    return midi_handler.getLatencyStats();
+}
+
+// Tempo, beat position and PLL phase error of the incoming MIDI clock
+MidiClockStats ControllerHandler::getMIDIClockStats() const {
+    return midi_handler.getClockStats();
+}
+
+void ControllerHandler::sendKnobChange(int knob_number, int value) {
+    midi_handler.sendAnalogMIDI(MIDI_CC_KNOB_FIRST + knob_number, value);
+}
+
+void ControllerHandler::sendFaderChange(int fader_number, int value) {
+    midi_handler.sendAnalogMIDI(MIDI_CC_FADER_FIRST + fader_number, value);
 }
 
 bool specialPressed[9] = {false};
+bool stopPressed[4] = {false};
+
+// MIDI note of each special input index, -1 = no note (SELECTOR_WHEEL press)
+static const int SPECIAL_INPUT_NOTE[9] = {
+    MIDI_NOTE_BUTTON_FIRST, MIDI_NOTE_BUTTON_FIRST + 1, MIDI_NOTE_BUTTON_FIRST + 2, MIDI_NOTE_BUTTON_FIRST + 3,
+    MIDI_NOTE_BUTTON_FIRST + 4, -1, MIDI_NOTE_BUTTON_FIRST + 7, MIDI_NOTE_BUTTON_FIRST + 6, MIDI_NOTE_BUTTON_FIRST + 5
+};
+
+// OSC name of each special input index
+static const char* const SPECIAL_INPUT_NAME[9] = {
+    "SHIFT", "REVERSE", "TYPE", "SIZE", "BROWSE", "WHEEL", "SYNC", "QUANT", "CAPTURE"
+};
+
+// LED of each special input index: SHIFT, REVERSE, TYPE, SIZE, BROWSE, SELECTOR_WHEEL (no LED), SYNC, QUANT, CAPTURE
+static const int SPECIAL_INPUT_LED[9] = {
+    (int)LEDButton::SHIFT, (int)LEDButton::REVERSE, (int)LEDButton::TYPE, (int)LEDButton::SIZE,
+    (int)LEDButton::BROWSE, -1, (int)LEDButton::SYNC, (int)LEDButton::QUANT, (int)LEDButton::CAPTURE
+};
 
 void ControllerHandler::updateButtons(const unsigned char* input_buffer) {
 
@@ -139,17 +841,41 @@ void ControllerHandler::updateButtons(const unsigned char* input_buffer) {
         if (isSpecialButtonPressed(input_buffer, i)) {
             if (!specialPressed[i]) {
                 std::cerr << "Special pressed..." << std::endl;
+                if (SPECIAL_INPUT_LED[i] >= 0) {
+                    reflex_table.onButton((LEDButton)SPECIAL_INPUT_LED[i], true);
+                }
+                if (SPECIAL_INPUT_NOTE[i] >= 0) {
+                    midi_handler.sendButtonMIDI(SPECIAL_INPUT_NOTE[i], true);
+                }
+                osc_handler.sendButton(SPECIAL_INPUT_NAME[i], true);
+                daemon_server.addButton(i, true);
                 delegate->onButtonPress(4 + i);
                 specialPressed[i] = true;
             }
         } else if (specialPressed[i]) {
+            if (SPECIAL_INPUT_LED[i] >= 0) {
+                reflex_table.onButton((LEDButton)SPECIAL_INPUT_LED[i], false);
+            }
+            if (SPECIAL_INPUT_NOTE[i] >= 0) {
+                midi_handler.sendButtonMIDI(SPECIAL_INPUT_NOTE[i], false);
+            }
+            osc_handler.sendButton(SPECIAL_INPUT_NAME[i], false);
+            daemon_server.addButton(i, false);
             delegate->onButtonRelease(4 + i);
             specialPressed[i] = false;
         }
     }
 
     for (int i = 0; i < 4; i++) {
-        if (isStopButtonPressed(input_buffer, i)) {
+        bool pressed = isStopButtonPressed(input_buffer, i);
+        if (pressed != stopPressed[i]) {
+            reflex_table.onStopButton(i, pressed);
+            midi_handler.sendButtonMIDI(MIDI_NOTE_STOP_FIRST + i, pressed);
+            osc_handler.sendStopButton(i, pressed);
+            daemon_server.addStopButton(i, pressed);
+            stopPressed[i] = pressed;
+        }
+        if (pressed) {
             delegate->onButtonPress(i);
         }
     }
@@ -167,6 +893,11 @@ void ControllerHandler::updateMatrixButtonStates(const unsigned char* input_buff
             
             // Check if state has changed
             if (current_pressed != button_state.previous_state[row_index][col_index]) {
+                // Local echo first, it goes out with this iteration's flush
+                reflex_table.onMatrixButton(row, col, current_pressed);
+                midi_handler.sendButtonMIDI(MIDI_NOTE_MATRIX_FIRST + row * MATRIX_COLS + col, current_pressed);
+                osc_handler.sendMatrixButton(row, col, current_pressed);
+                daemon_server.addMatrixButton(row, col, current_pressed);
                 if (current_pressed) {
                     // Button was just pressed
                     delegate->onMatrixButtonPress(row, col);
@@ -195,8 +926,13 @@ void ControllerHandler::updateKnobStates(const unsigned char* input_buffer) {
         // Check if value has changed (allow for some tolerance)
         int previous_value = analog_state.previous_knob_values[knob];
         
+        // MIDI, OSC and daemon clients get the full 12-bit value, the handlers filter and scale it
+        uint16_t raw_value = knob_reader.getRawKnobValue(input_buffer, knob);
+        midi_handler.sendAnalogControl(knob, raw_value);
+        osc_handler.sendAnalogControl(knob, raw_value);
+        daemon_server.addAnalogControl(knob, raw_value);
+
         if (current_value != previous_value) {
-            // Send MIDI CC message for knob change
             delegate->onKnobChanged(knob, current_value * 2);
         }
         analog_state.previous_knob_values[knob] = current_value;
@@ -215,6 +951,10 @@ void ControllerHandler::updateFaderStates(const unsigned char* input_buffer) {
         // Check if value has changed (allow for some tolerance)
         int previous_value = analog_state.previous_fader_values[fader];
         auto now = std::chrono::system_clock::now();
+        uint16_t raw_value = fader_reader.getRawFaderValue(input_buffer, fader);
+        midi_handler.sendAnalogControl(KNOB_COUNT + fader, raw_value);
+        osc_handler.sendAnalogControl(KNOB_COUNT + fader, raw_value);
+        daemon_server.addAnalogControl(KNOB_COUNT + fader, raw_value);
         if (current_value != previous_value) {
             if (!analog_state.is_fader_value_dirty[fader]) {
                 analog_state.last_slider_change[fader] = now;
@@ -231,3 +971,57 @@ void ControllerHandler::updateFaderStates(const unsigned char* input_buffer) {
         analog_state.previous_fader_values[fader] = current_value;
     }
 }
+
+/*
+* Publishes the state of all controls after one input report
+* Does nothing unless enableStateSharing() was called. Button states come
+* from the edge detection of this run() iteration, analog values are raw.
+*
+* @param input_buffer: The input report
+* @param wheel_direction: Wheel step of this report
+*/
+void ControllerHandler::publishState(const unsigned char* input_buffer, WheelDirection wheel_direction) {
+    if (!state_publisher.isOpen()) {
+        return;
+    }
+
+    // Step 1: Buttons as one bitmask
+    uint32_t buttons = 0;
+    for (int row = 0; row < MATRIX_ROWS; row++) {
+        for (int col = 0; col < MATRIX_COLS; col++) {
+            if (button_state.current_state[row][col]) {
+                buttons |= 1u << (CONTROLLER_STATE_MATRIX_BIT + row * MATRIX_COLS + col);
+            }
+        }
+    }
+    for (int i = 0; i < 9; i++) {
+        if (specialPressed[i]) {
+            buttons |= 1u << (CONTROLLER_STATE_SPECIAL_BIT + i);
+        }
+    }
+    for (int i = 0; i < LED_STOP_COUNT; i++) {
+        if (stopPressed[i]) {
+            buttons |= 1u << (CONTROLLER_STATE_STOP_BIT + i);
+        }
+    }
+
+    // Step 2: Analog values, wheel, page and times
+    for (int i = 0; i < KNOB_COUNT; i++) {
+        shared_state.analog[i] = knob_input_reader.getRawKnobValue(input_buffer, i);
+        shared_state.analog[KNOB_COUNT + i] = fader_input_reader.getRawFaderValue(input_buffer, i);
+    }
+    if (wheel_direction == WheelDirection::CLOCKWISE) {
+        shared_state.wheel_position++;
+    } else if (wheel_direction == WheelDirection::COUNTER_CLOCKWISE) {
+        shared_state.wheel_position--;
+    }
+    shared_state.buttons = buttons;
+    shared_state.page = current_effect_page;
+    shared_state.report_count++;
+    shared_state.report_time_ns = getLEDTimeNs();
+    shared_state.report_wall_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    // Step 3: One seqlock write
+    state_publisher.publish(shared_state);
+}
@@ -0,0 +1,200 @@
+#include "include/controller_state_shm.h"
+
+#include <cerrno>               // For errno
+#include <cstring>              // For memcpy, strerror
+#include <fcntl.h>              // For O_* constants
+#include <iostream>             // For std::cout and std::cerr
+#include <new>                  // For placement new
+#include <sys/mman.h>           // For shm_open, mmap
+#include <unistd.h>             // For ftruncate, close
+
+// =============================================================================
+// CONTROLLER STATE PUBLISHER CLASS IMPLEMENTATION
+// =============================================================================
+
+ControllerStatePublisher::ControllerStatePublisher() : segment(nullptr) {
+}
+
+ControllerStatePublisher::~ControllerStatePublisher() {
+    close();
+}
+
+/*
+* Creates (or takes over) the shared memory segment
+* A segment left behind by a crashed driver is reinitialized.
+*
+* @param name: POSIX shared memory name, starting with '/'
+* @return: true if the segment is mapped, false if error
+*/
+bool ControllerStatePublisher::open(const std::string& name) {
+    if (segment != nullptr) {
+        return true;
+    }
+
+    // Step 1: Create the segment, readable by other users' processes
+    int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        std::cerr << "Error: Unable to create shared memory " << name << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    if (ftruncate(fd, sizeof(ControllerStateSegment)) != 0) {
+        std::cerr << "Error: Unable to size shared memory " << name << ": " << strerror(errno) << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    // Step 2: Map it, the descriptor is not needed after that
+    void* memory = mmap(nullptr, sizeof(ControllerStateSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED) {
+        std::cerr << "Error: Unable to map shared memory " << name << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    // Step 3: Header last, readers check it before they trust the data
+    segment = new (memory) ControllerStateSegment();
+    segment->sequence.store(0, std::memory_order_relaxed);
+    for (int i = 0; i < CONTROLLER_STATE_WORDS; i++) {
+        segment->words[i].store(0, std::memory_order_relaxed);
+    }
+    segment->data_size = sizeof(ControllerStateData);
+    segment->version = CONTROLLER_STATE_VERSION;
+    std::atomic_thread_fence(std::memory_order_release);
+    segment->magic = CONTROLLER_STATE_MAGIC;
+    this->name = name;
+
+    std::cout << "- Controller state shared as " << name << std::endl;
+    return true;
+}
+
+/*
+* Unmaps and removes the segment
+* Readers that still have it mapped keep the last state.
+*/
+void ControllerStatePublisher::close() {
+    if (segment == nullptr) {
+        return;
+    }
+    munmap(segment, sizeof(ControllerStateSegment));
+    shm_unlink(name.c_str());
+    segment = nullptr;
+}
+
+bool ControllerStatePublisher::isOpen() const {
+    return segment != nullptr;
+}
+
+/*
+* Publishes one snapshot (seqlock write side)
+* Called once per input report by the input thread, the only writer.
+*
+* @param data: Decoded state of all controls
+*/
+void ControllerStatePublisher::publish(const ControllerStateData& data) {
+    if (segment == nullptr) {
+        return;
+    }
+    uint64_t words[CONTROLLER_STATE_WORDS];
+    memcpy(words, &data, sizeof(data));
+
+    // Odd sequence: readers that start now retry, the fence keeps the data
+    // stores after it
+    uint32_t sequence = segment->sequence.load(std::memory_order_relaxed);
+    segment->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (int i = 0; i < CONTROLLER_STATE_WORDS; i++) {
+        segment->words[i].store(words[i], std::memory_order_relaxed);
+    }
+    // Even again: the data is complete
+    segment->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+// =============================================================================
+// CONTROLLER STATE READER CLASS IMPLEMENTATION
+// =============================================================================
+
+ControllerStateReader::ControllerStateReader() : segment(nullptr) {
+}
+
+ControllerStateReader::~ControllerStateReader() {
+    close();
+}
+
+/*
+* Maps the segment of a running driver, read-only
+*
+* @param name: POSIX shared memory name, starting with '/'
+* @return: true if mapped, false if there is no driver or its layout differs
+*/
+bool ControllerStateReader::open(const std::string& name) {
+    if (segment != nullptr) {
+        return true;
+    }
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        std::cerr << "Error: No controller state at " << name << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    void* memory = mmap(nullptr, sizeof(ControllerStateSegment), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED) {
+        std::cerr << "Error: Unable to map controller state " << name << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    // The layout must match this build
+    const ControllerStateSegment* mapped = static_cast<const ControllerStateSegment*>(memory);
+    if (mapped->magic != CONTROLLER_STATE_MAGIC || mapped->version != CONTROLLER_STATE_VERSION ||
+        mapped->data_size != sizeof(ControllerStateData)) {
+        std::cerr << "Error: Controller state " << name << " has an unknown layout" << std::endl;
+        munmap(memory, sizeof(ControllerStateSegment));
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    segment = mapped;
+    return true;
+}
+
+void ControllerStateReader::close() {
+    if (segment == nullptr) {
+        return;
+    }
+    munmap(const_cast<ControllerStateSegment*>(segment), sizeof(ControllerStateSegment));
+    segment = nullptr;
+}
+
+bool ControllerStateReader::isOpen() const {
+    return segment != nullptr;
+}
+
+/*
+* Copies the latest snapshot (seqlock read side), never blocks the driver
+*
+* @param data: Set to the snapshot
+* @return: true if a consistent snapshot was read, false if the driver was
+*          writing for all CONTROLLER_STATE_READ_ATTEMPTS attempts (try again next frame)
+*/
+bool ControllerStateReader::read(ControllerStateData& data) const {
+    if (segment == nullptr) {
+        return false;
+    }
+    uint64_t words[CONTROLLER_STATE_WORDS];
+    for (int attempt = 0; attempt < CONTROLLER_STATE_READ_ATTEMPTS; attempt++) {
+        // Step 1: Skip while a write is in progress
+        uint32_t before = segment->sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            continue;
+        }
+
+        // Step 2: Copy, then check that no write started meanwhile
+        for (int i = 0; i < CONTROLLER_STATE_WORDS; i++) {
+            words[i] = segment->words[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (segment->sequence.load(std::memory_order_relaxed) == before) {
+            memcpy(&data, words, sizeof(data));
+            return true;
+        }
+    }
+    return false;
+}
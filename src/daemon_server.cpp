@@ -0,0 +1,782 @@
+#include "include/daemon_server.h"
+
+#include <cerrno>               // For errno
+#include <cstring>              // For memcpy, strerror
+#include <fcntl.h>              // For fcntl
+#include <grp.h>                // For getgrnam
+#include <iostream>             // For std::cout and std::cerr
+#include <poll.h>               // For poll
+#include <sys/socket.h>         // For socket, bind, listen, accept, send
+#include <sys/stat.h>           // For chmod
+#include <sys/un.h>             // For sockaddr_un
+#include <unistd.h>             // For close, pipe, read, write, unlink, chown
+
+// =============================================================================
+// HELPER FUNCTIONS
+// =============================================================================
+
+// Writes to a closed client must return EPIPE instead of raising SIGPIPE
+#ifdef MSG_NOSIGNAL
+static const int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+static const int SEND_FLAGS = 0;
+#endif
+
+static const uint32_t RING_MASK = DAEMON_CLIENT_BUFFER_EVENTS - 1;
+
+static bool setNonBlocking(int fd) {
+    return fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) == 0;
+}
+
+// LED group a command writes to, -1 = no LED command
+static int getCommandGroup(DaemonCommandType type) {
+    switch (type) {
+        case DaemonCommandType::LED_MATRIX:    return (int)DaemonLEDGroup::MATRIX;
+        case DaemonCommandType::LED_BUTTON:    return (int)DaemonLEDGroup::BUTTONS;
+        case DaemonCommandType::LED_STOP:      return (int)DaemonLEDGroup::STOPS;
+        case DaemonCommandType::DISPLAY_VALUE: return (int)DaemonLEDGroup::DISPLAY;
+        default:                               return -1;
+    }
+}
+
+// =============================================================================
+// DAEMON SERVER CLASS IMPLEMENTATION
+// =============================================================================
+
+DaemonServer::DaemonServer()
+    : listen_fd(-1), wake_pipe{-1, -1}, display(nullptr), led_command_hook(nullptr), led_command_user_data(nullptr), owners{0, 0, 0, 0}, next_client_id(1), running(false),
+      thread_running(false), reactor(nullptr), report_size(0), report_sequence(0), report_time_ns(0),
+      pending_count(0) {
+    for (int i = 0; i < DAEMON_ANALOG_CONTROL_COUNT; i++) {
+        analog_raw[i] = -1;
+    }
+}
+
+DaemonServer::~DaemonServer() {
+    stop();
+}
+
+/*
+* Starts serving on a Unix-domain socket
+* A socket file left behind by a crashed daemon is replaced, one that
+* another daemon still accepts on is not. The socket is only usable by the
+* owner, or also by a group if one is given, whatever the process umask is.
+*
+* @param path: Socket path
+* @param display: Display controller for DISPLAY_VALUE, may be null
+* @param group: Group allowed to connect, empty for the owner only
+* @return: true if serving, false if error
+*/
+bool DaemonServer::start(const std::string& path, DisplayController* display, const std::string& group) {
+    if (running) {
+        return true;
+    }
+    this->display = display;
+
+    // Step 1: Build the address and look up the group
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Error: Daemon socket path too long: " << path << std::endl;
+        return false;
+    }
+    memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    gid_t gid = (gid_t)-1;
+    if (!group.empty()) {
+        const struct group* entry = getgrnam(group.c_str());
+        if (entry == nullptr) {
+            std::cerr << "Error: Unknown daemon socket group: " << group << std::endl;
+            return false;
+        }
+        gid = entry->gr_gid;
+    }
+
+    // Step 2: Refuse to take over a live daemon's socket
+    int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (probe >= 0) {
+        bool live = connect(probe, (const sockaddr*)&address, sizeof(address)) == 0;
+        close(probe);
+        if (live) {
+            std::cerr << "Error: Another daemon is serving " << path << std::endl;
+            return false;
+        }
+    }
+    unlink(path.c_str());
+
+    // Step 3: Bind and restrict the socket file before anyone can connect,
+    // then listen, everything non-blocking
+    mode_t mode = group.empty() ? DAEMON_SOCKET_MODE : DAEMON_SOCKET_GROUP_MODE;
+    listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0 || bind(listen_fd, (const sockaddr*)&address, sizeof(address)) != 0 ||
+        (gid != (gid_t)-1 && chown(path.c_str(), (uid_t)-1, gid) != 0) || chmod(path.c_str(), mode) != 0 ||
+        listen(listen_fd, DAEMON_MAX_CLIENTS) != 0 || !setNonBlocking(listen_fd) ||
+        pipe(wake_pipe) != 0 || !setNonBlocking(wake_pipe[0]) || !setNonBlocking(wake_pipe[1])) {
+        std::cerr << "Error: Unable to serve " << path << ": " << strerror(errno) << std::endl;
+        socket_path = path;
+        stop();
+        return false;
+    }
+    socket_path = path;
+
+    // Step 4: Start the server thread
+    running = true;
+    thread_running = true;
+    server_thread = std::thread(&DaemonServer::serverLoop, this);
+    std::cout << "- Daemon serving events on " << path << std::endl;
+    return true;
+}
+
+/*
+* Disconnects all clients, stops the server thread and removes the socket file
+*/
+void DaemonServer::stop() {
+    // Step 1: Stop the server thread
+    running = false;
+    stopServerThread();
+
+    // Step 2: Drop the clients, leave the reactor and close all descriptors
+    {
+        std::lock_guard<std::mutex> lock(clients_mutex);
+        for (int slot = 0; slot < DAEMON_MAX_CLIENTS; slot++) {
+            removeClient(slot);
+        }
+        if (reactor != nullptr) {
+            reactor->remove(listen_fd);
+            reactor = nullptr;
+        }
+    }
+    for (int* fd : {&listen_fd, &wake_pipe[0], &wake_pipe[1]}) {
+        if (*fd >= 0) {
+            close(*fd);
+            *fd = -1;
+        }
+    }
+    if (!socket_path.empty()) {
+        unlink(socket_path.c_str());
+        socket_path.clear();
+    }
+}
+
+/*
+* Sets the hook called before client LED commands are painted
+* Call before start(), the serving thread reads it unlocked.
+*
+* @param hook: Function to call, nullptr for none
+* @param user_data: Passed to the hook
+*/
+void DaemonServer::setLEDCommandHook(LEDCommandHook hook, void* user_data) {
+    led_command_hook = hook;
+    led_command_user_data = user_data;
+}
+
+bool DaemonServer::isRunning() const {
+    return running;
+}
+
+/*
+* Serves on a reactor thread instead of the server thread
+* endReport() must then be called on the reactor thread as well. Detach
+* before the reactor is closed.
+*
+* @param reactor: Open reactor
+* @return: true if attached, false if not serving or the reactor is not open
+*/
+bool DaemonServer::attachReactor(EventReactor& reactor) {
+    if (!running || this->reactor != nullptr) {
+        return this->reactor == &reactor;
+    }
+
+    // Step 1: The listening socket moves over first
+    stopServerThread();
+    if (!reactor.addReader(listen_fd, &DaemonServer::onReactorListen, this)) {
+        thread_running = true;
+        server_thread = std::thread(&DaemonServer::serverLoop, this);
+        return false;
+    }
+
+    // Step 2: Then the connected clients, with their backlog
+    std::lock_guard<std::mutex> lock(clients_mutex);
+    this->reactor = &reactor;
+    for (int slot = 0; slot < DAEMON_MAX_CLIENTS; slot++) {
+        Client* client = clients[slot].get();
+        if (client == nullptr) {
+            continue;
+        }
+        if (!reactor.addReader(client->fd, &DaemonServer::onReactorClient, this)) {
+            close(client->fd);
+            clients[slot].reset();
+            continue;
+        }
+        reactor.setWriteInterest(client->fd, client->head != client->tail);
+    }
+    return true;
+}
+
+/*
+* Goes back to the server thread
+*/
+void DaemonServer::detachReactor() {
+    {
+        std::lock_guard<std::mutex> lock(clients_mutex);
+        if (reactor == nullptr) {
+            return;
+        }
+        for (int slot = 0; slot < DAEMON_MAX_CLIENTS; slot++) {
+            if (clients[slot]) {
+                reactor->remove(clients[slot]->fd);
+            }
+        }
+        reactor->remove(listen_fd);
+        reactor = nullptr;
+    }
+    if (running) {
+        thread_running = true;
+        server_thread = std::thread(&DaemonServer::serverLoop, this);
+    }
+}
+
+// =============================================================================
+// EVENT FAN-OUT - Input thread
+// =============================================================================
+
+/*
+* Starts collecting the events of a new input report
+*/
+void DaemonServer::beginReport() {
+    report_size = 0;
+    report_sequence++;
+    report_time_ns = getLEDTimeNs();
+}
+
+void DaemonServer::addEvent(DaemonEventType type, int index, int value) {
+    if (!running || report_size >= DAEMON_REPORT_MAX_EVENTS) {
+        return;
+    }
+    report_events[report_size++] = {(uint8_t)type, (uint8_t)index, (uint16_t)value, report_sequence.load(), report_time_ns};
+}
+
+void DaemonServer::addMatrixButton(int row, int col, bool pressed) {
+    addEvent(DaemonEventType::MATRIX, row * MATRIX_COLS + col, pressed ? 1 : 0);
+}
+
+void DaemonServer::addButton(int index, bool pressed) {
+    addEvent(DaemonEventType::BUTTON, index, pressed ? 1 : 0);
+}
+
+void DaemonServer::addStopButton(int index, bool pressed) {
+    addEvent(DaemonEventType::STOP, index, pressed ? 1 : 0);
+}
+
+/*
+* Adds a knob or fader, call once per report for every control
+* Unchanged values and ADC noise below DAEMON_ANALOG_DEADBAND are skipped.
+*
+* @param control: Knob 0-3 = control 0-3, fader 0-3 = control 4-7
+* @param raw_value: Raw 12-bit value (0-4095)
+*/
+void DaemonServer::addAnalogControl(int control, uint16_t raw_value) {
+    if (control < 0 || control >= DAEMON_ANALOG_CONTROL_COUNT) {
+        return;
+    }
+    if (raw_value > 0x0FFF) raw_value = 0x0FFF;
+    int previous = analog_raw[control];
+    int difference = previous > raw_value ? previous - raw_value : raw_value - previous;
+    if (previous >= 0 && (difference == 0 || (difference < DAEMON_ANALOG_DEADBAND && raw_value != 0 && raw_value != 0x0FFF))) {
+        return;
+    }
+    analog_raw[control] = raw_value;
+    addEvent(DaemonEventType::ANALOG, control, raw_value);
+}
+
+void DaemonServer::addWheel(bool clockwise) {
+    addEvent(DaemonEventType::WHEEL, 0, clockwise ? 1 : 0xFFFF);
+}
+
+void DaemonServer::addPage(int page) {
+    addEvent(DaemonEventType::PAGE, 0, page);
+}
+
+/*
+* Copies the report's events to every client and sends what fits
+* Never blocks: what a socket does not take stays in the client's ring and
+* the server thread sends it when the socket is writable.
+*/
+void DaemonServer::endReport() {
+    if (report_size == 0 || !running) {
+        return;
+    }
+    bool pending = false;
+    {
+        std::lock_guard<std::mutex> lock(clients_mutex);
+        for (int slot = 0; slot < DAEMON_MAX_CLIENTS; slot++) {
+            Client* client = clients[slot].get();
+            if (client == nullptr) {
+                continue;
+            }
+            enqueue(*client, report_events, report_size);
+            if (!sendPending(*client)) {
+                removeClient(slot);
+            } else if (client->head != client->tail) {
+                if (reactor != nullptr) {
+                    reactor->setWriteInterest(client->fd, true);
+                } else {
+                    pending = true;
+                }
+            }
+        }
+    }
+    if (pending) {
+        wake();    // The server thread watches for the socket to drain
+    }
+    report_size = 0;
+}
+
+/*
+* Appends events to a client's ring, all or nothing
+* A report that does not fit is dropped for this client only and reported
+* with an OVERFLOW event once there is room again.
+* Requires clients_mutex to be held.
+*
+* @return: true if appended, false if dropped
+*/
+bool DaemonServer::enqueue(Client& client, const DaemonEvent* events, int count) {
+    uint32_t free_events = DAEMON_CLIENT_BUFFER_EVENTS - (client.head - client.tail);
+    int needed = count + (client.lost_events > 0 ? 1 : 0);
+    if ((int)free_events < needed) {
+        client.lost_events += count;
+        client.stats.events_dropped += count;
+        return false;
+    }
+    if (client.lost_events > 0) {
+        uint16_t lost = client.lost_events > 0xFFFF ? 0xFFFF : (uint16_t)client.lost_events;
+        client.events[client.head++ & RING_MASK] = {(uint8_t)DaemonEventType::OVERFLOW, 0, lost, report_sequence.load(), 0};
+        client.lost_events = 0;
+    }
+    for (int i = 0; i < count; i++) {
+        client.events[client.head++ & RING_MASK] = events[i];
+    }
+    return true;
+}
+
+/*
+* Sends as much of a client's ring as the socket takes, without blocking
+* The latency of the newest report event that went out completely is
+* recorded once per call. Requires clients_mutex to be held.
+*
+* @return: false if the client is gone
+*/
+bool DaemonServer::sendPending(Client& client) {
+    int64_t sent_time_ns = 0;
+    while (client.head != client.tail) {
+        // Step 1: Send the contiguous part of the ring, from inside the tail event
+        uint32_t tail_slot = client.tail & RING_MASK;
+        uint32_t count = client.head - client.tail;
+        if (tail_slot + count > (uint32_t)DAEMON_CLIENT_BUFFER_EVENTS) {
+            count = DAEMON_CLIENT_BUFFER_EVENTS - tail_slot;
+        }
+        const uint8_t* bytes = (const uint8_t*)&client.events[tail_slot] + client.sent_bytes;
+        size_t size = count * sizeof(DaemonEvent) - client.sent_bytes;
+        ssize_t written = send(client.fd, bytes, size, SEND_FLAGS | MSG_DONTWAIT);
+        if (written < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                break;
+            }
+            return false;
+        }
+
+        // Step 2: Advance over the events that went out completely
+        int total = client.sent_bytes + (int)written;
+        int complete = total / (int)sizeof(DaemonEvent);
+        for (int i = 0; i < complete; i++) {
+            const DaemonEvent& event = client.events[(client.tail + i) & RING_MASK];
+            if (event.time_ns != 0) {
+                sent_time_ns = event.time_ns;
+            }
+        }
+        client.tail += complete;
+        client.sent_bytes = total % (int)sizeof(DaemonEvent);
+        client.stats.events_sent += complete;
+        if ((size_t)written < size) {
+            break;
+        }
+    }
+
+    // Step 3: Fan-out latency of this client
+    if (sent_time_ns != 0) {
+        double latency_us = (getLEDTimeNs() - sent_time_ns) / 1000.0;
+        client.stats.latency_samples++;
+        client.latency_sum_us += latency_us;
+        client.stats.average_latency_us = client.latency_sum_us / client.stats.latency_samples;
+        client.stats.last_latency_us = latency_us;
+        if (latency_us > client.stats.max_latency_us) {
+            client.stats.max_latency_us = latency_us;
+        }
+    }
+    return true;
+}
+
+void DaemonServer::wake() {
+    char byte = 1;
+    if (wake_pipe[1] >= 0 && write(wake_pipe[1], &byte, 1) < 0 && errno != EAGAIN) {
+        std::cerr << "Error: Unable to wake the daemon thread" << std::endl;
+    }
+}
+
+// =============================================================================
+// CLIENTS AND COMMANDS - Server thread
+// =============================================================================
+
+/*
+* Accepts all waiting connections and greets them with HELLO
+*/
+void DaemonServer::acceptClient() {
+    while (true) {
+        int fd = accept(listen_fd, nullptr, nullptr);
+        if (fd < 0) {
+            return;
+        }
+#ifdef SO_NOSIGPIPE
+        int on = 1;
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+        std::lock_guard<std::mutex> lock(clients_mutex);
+        int slot = 0;
+        while (slot < DAEMON_MAX_CLIENTS && clients[slot]) {
+            slot++;
+        }
+        if (slot == DAEMON_MAX_CLIENTS || !setNonBlocking(fd)) {
+            std::cerr << "Error: Daemon client refused (" << DAEMON_MAX_CLIENTS << " clients max)" << std::endl;
+            close(fd);
+            continue;
+        }
+
+        // The ring lives with the client, nothing is allocated per event
+        std::unique_ptr<Client> client = std::make_unique<Client>();
+        client->fd = fd;
+        client->id = next_client_id++;
+        client->head = 0;
+        client->tail = 0;
+        client->sent_bytes = 0;
+        client->command_size = 0;
+        client->lost_events = 0;
+        client->stats = {client->id, 0, 0, 0, 0, 0.0, 0.0, 0.0};
+        client->latency_sum_us = 0.0;
+        if (reactor != nullptr && !reactor->addReader(fd, &DaemonServer::onReactorClient, this)) {
+            close(fd);
+            continue;
+        }
+        DaemonEvent hello = {(uint8_t)DaemonEventType::HELLO, (uint8_t)client->id, DAEMON_PROTOCOL_VERSION, report_sequence.load(), 0};
+        enqueue(*client, &hello, 1);
+        sendPending(*client);
+        if (reactor != nullptr) {
+            reactor->setWriteInterest(fd, client->head != client->tail);
+        }
+        clients[slot] = std::move(client);
+    }
+}
+
+/*
+* Disconnects a client and frees the LED groups it owned
+* Requires clients_mutex to be held.
+*/
+void DaemonServer::removeClient(int slot) {
+    Client* client = clients[slot].get();
+    if (client == nullptr) {
+        return;
+    }
+    for (int group = 0; group < DAEMON_LED_GROUP_COUNT; group++) {
+        if (owners[group] == client->id) {
+            owners[group] = 0;
+        }
+    }
+    if (reactor != nullptr) {
+        reactor->remove(client->fd);
+    }
+    close(client->fd);
+    clients[slot].reset();
+}
+
+/*
+* Reads a client's commands, at most DAEMON_MAX_COMMANDS_PER_WAKEUP
+* Claims are handled and LED commands checked here, the ones that may be
+* applied are copied to pending_commands. Whatever the client sent beyond
+* the limit stays in the socket for the next wakeup.
+* Requires clients_mutex to be held.
+*
+* @return: false if the client disconnected
+*/
+bool DaemonServer::readCommands(Client& client) {
+    uint8_t buffer[DAEMON_MAX_COMMANDS_PER_WAKEUP * sizeof(DaemonCommand)];
+    ssize_t size = read(client.fd, buffer, sizeof(buffer) - client.command_size);
+    if (size == 0) {
+        return false;
+    }
+    if (size < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+
+    // Commands may arrive split across reads
+    for (ssize_t i = 0; i < size; i++) {
+        client.command_bytes[client.command_size++] = buffer[i];
+        if (client.command_size == (int)sizeof(DaemonCommand)) {
+            DaemonCommand command;
+            memcpy(&command, client.command_bytes, sizeof(command));
+            client.command_size = 0;
+            client.stats.commands_received++;
+            if (checkCommand(client, command)) {
+                pending_commands[pending_count++] = command;
+            }
+        }
+    }
+    return true;
+}
+
+/*
+* Handles a claim or checks an LED command (no LED changes)
+* Rejected commands are answered right away.
+* Requires clients_mutex to be held.
+*
+* @return: true if the command is an LED command that may be applied
+*/
+bool DaemonServer::checkCommand(Client& client, const DaemonCommand& command) {
+    DaemonCommandType type = (DaemonCommandType)command.type;
+
+    // Step 1: Claiming and releasing LED groups
+    if (type == DaemonCommandType::CLAIM || type == DaemonCommandType::RELEASE) {
+        bool granted = false;
+        if (command.index < DAEMON_LED_GROUP_COUNT) {
+            int& owner = owners[command.index];
+            if (type == DaemonCommandType::CLAIM && (owner == 0 || owner == client.id)) {
+                owner = client.id;
+                granted = true;
+            } else if (type == DaemonCommandType::RELEASE && owner == client.id) {
+                owner = 0;
+                granted = true;
+            }
+        }
+        DaemonEvent reply = {(uint8_t)DaemonEventType::CLAIM_RESULT, command.index, (uint16_t)(granted ? 1 : 0), report_sequence.load(), 0};
+        enqueue(client, &reply, 1);
+        return false;
+    }
+
+    // Step 2: LED commands only from the owner of their group, and only valid targets
+    int group = getCommandGroup(type);
+    bool valid = false;
+    if (group >= 0 && owners[group] == client.id) {
+        switch (type) {
+            case DaemonCommandType::LED_MATRIX:
+                valid = command.index < MATRIX_ROWS * MATRIX_COLS && command.color < LED_COLOR_COUNT;
+                break;
+            case DaemonCommandType::LED_BUTTON:
+                valid = command.index < LED_BUTTON_COUNT;
+                break;
+            case DaemonCommandType::LED_STOP:
+                valid = command.index < LED_STOP_COUNT;
+                break;
+            case DaemonCommandType::DISPLAY_VALUE:
+                valid = display != nullptr;
+                break;
+            default:
+                break;
+        }
+    }
+    if (!valid) {
+        DaemonEvent reply = {(uint8_t)DaemonEventType::COMMAND_REJECTED, command.type, (uint16_t)(group < 0 ? 0xFFFF : group), report_sequence.load(), 0};
+        enqueue(client, &reply, 1);
+    }
+    return valid;
+}
+
+/*
+* Paints the checked commands of this wakeup as one LED frame and flushes it
+* Called without clients_mutex, the input thread can fan out meanwhile.
+*
+* @param receive_ns: When the wakeup started, the frame's latency origin
+*/
+void DaemonServer::applyCommands(int64_t receive_ns) {
+    if (pending_count == 0) {
+        return;
+    }
+    beginLEDFrame();
+    for (int i = 0; i < pending_count; i++) {
+        const DaemonCommand& command = pending_commands[i];
+        uint8_t level = command.level > 127 ? 127 : command.level;
+        if (led_command_hook != nullptr && command.type != (uint8_t)DaemonCommandType::DISPLAY_VALUE) {
+            led_command_hook(led_command_user_data);
+        }
+        switch ((DaemonCommandType)command.type) {
+            case DaemonCommandType::LED_MATRIX:
+                setMatrixButtonLEDLevel(command.index / MATRIX_COLS, command.index % MATRIX_COLS, (LEDColor)command.color, level);
+                break;
+            case DaemonCommandType::LED_BUTTON:
+                setButtonLEDLevel((LEDButton)command.index, level);
+                break;
+            case DaemonCommandType::LED_STOP:
+                setStopButtonLEDLevel(command.index, level);
+                break;
+            case DaemonCommandType::DISPLAY_VALUE:
+                display->setDisplayValue(command.value);
+                break;
+            default:
+                break;
+        }
+    }
+    commitLEDFrame();
+    pending_count = 0;
+    markLEDFrameOrigin(receive_ns);
+    flushLEDReport();
+}
+
+/*
+* Reads a client's commands and sends its backlog
+* Requires clients_mutex to be held.
+*
+* @param readable: The socket has data or was closed
+* @return: false if the client was removed
+*/
+bool DaemonServer::handleClient(int slot, bool readable) {
+    Client& client = *clients[slot];
+    bool alive = !readable || readCommands(client);
+    if (alive) {
+        alive = sendPending(client);
+    }
+    if (!alive) {
+        removeClient(slot);
+        return false;
+    }
+    if (reactor != nullptr) {
+        reactor->setWriteInterest(client.fd, client.head != client.tail);
+    }
+    return true;
+}
+
+/*
+* Server thread: waits on the listening socket, the clients and the wake pipe
+*/
+void DaemonServer::serverLoop() {
+    pollfd fds[2 + DAEMON_MAX_CLIENTS];
+    int slots[DAEMON_MAX_CLIENTS];
+    while (thread_running) {
+        // Step 1: Watch every client for commands, and for room if it has events waiting
+        int count = 0;
+        fds[count++] = {listen_fd, POLLIN, 0};
+        fds[count++] = {wake_pipe[0], POLLIN, 0};
+        {
+            std::lock_guard<std::mutex> lock(clients_mutex);
+            for (int slot = 0; slot < DAEMON_MAX_CLIENTS; slot++) {
+                Client* client = clients[slot].get();
+                if (client != nullptr) {
+                    short events = POLLIN;
+                    if (client->head != client->tail) {
+                        events |= POLLOUT;
+                    }
+                    slots[count - 2] = slot;
+                    fds[count++] = {client->fd, events, 0};
+                }
+            }
+        }
+        if (poll(fds, count, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "Error: Daemon poll failed: " << strerror(errno) << std::endl;
+            break;
+        }
+
+        // Step 2: Drain the wake pipe, new connections
+        if (fds[1].revents != 0) {
+            char drain[64];
+            while (read(wake_pipe[0], drain, sizeof(drain)) > 0) {
+            }
+        }
+        if (!thread_running) {
+            break;
+        }
+        if (fds[0].revents & POLLIN) {
+            acceptClient();
+        }
+
+        // Step 3: Read commands and send replies and backlog, then paint
+        // all clients' commands as one LED frame without the lock
+        int64_t receive_ns = getLEDTimeNs();
+        {
+            std::lock_guard<std::mutex> lock(clients_mutex);
+            for (int i = 2; i < count; i++) {
+                int slot = slots[i - 2];
+                Client* client = clients[slot].get();
+                if (client == nullptr || client->fd != fds[i].fd) {
+                    continue;
+                }
+                handleClient(slot, fds[i].revents & (POLLIN | POLLHUP | POLLERR));
+            }
+        }
+        applyCommands(receive_ns);
+    }
+}
+
+/*
+* Wakes and joins the server thread, the wake pipe is emptied for a restart
+*/
+void DaemonServer::stopServerThread() {
+    if (!thread_running.exchange(false)) {
+        return;
+    }
+    wake();
+    if (server_thread.joinable()) {
+        server_thread.join();
+    }
+    char drain[64];
+    while (read(wake_pipe[0], drain, sizeof(drain)) > 0) {
+    }
+}
+
+void DaemonServer::onReactorListen(int fd, uint32_t events, void* user_data) {
+    (void)fd;
+    (void)events;
+    static_cast<DaemonServer*>(user_data)->acceptClient();
+}
+
+/*
+* Reactor callback for one client, its commands make one LED frame
+*/
+void DaemonServer::onReactorClient(int fd, uint32_t events, void* user_data) {
+    DaemonServer* server = static_cast<DaemonServer*>(user_data);
+    int64_t receive_ns = getLEDTimeNs();
+    {
+        std::lock_guard<std::mutex> lock(server->clients_mutex);
+        for (int slot = 0; slot < DAEMON_MAX_CLIENTS; slot++) {
+            if (server->clients[slot] && server->clients[slot]->fd == fd) {
+                server->handleClient(slot, events & (EVENT_READABLE | EVENT_HANGUP | EVENT_ERROR));
+                break;
+            }
+        }
+    }
+    server->applyCommands(receive_ns);
+}
+
+// =============================================================================
+// STATISTICS
+// =============================================================================
+
+int DaemonServer::getClientCount() {
+    std::lock_guard<std::mutex> lock(clients_mutex);
+    int count = 0;
+    for (int slot = 0; slot < DAEMON_MAX_CLIENTS; slot++) {
+        if (clients[slot]) {
+            count++;
+        }
+    }
+    return count;
+}
+
+std::vector<DaemonClientStats> DaemonServer::getClientStats() {
+    std::lock_guard<std::mutex> lock(clients_mutex);
+    std::vector<DaemonClientStats> stats;
+    for (int slot = 0; slot < DAEMON_MAX_CLIENTS; slot++) {
+        if (clients[slot]) {
+            stats.push_back(clients[slot]->stats);
+        }
+    }
+    return stats;
+}
@@ -0,0 +1,361 @@
+#include "include/event_reactor.h"
+
+#include <cerrno>               // For errno
+#include <cstring>              // For strerror
+#include <iostream>             // For std::cout and std::cerr
+#include <unistd.h>             // For close, read, write
+
+#ifdef __linux__
+#include <sys/epoll.h>          // For epoll_create1, epoll_ctl, epoll_wait
+#include <sys/eventfd.h>        // For eventfd
+#include <sys/timerfd.h>        // For timerfd_create, timerfd_settime
+
+static_assert(EVENT_READABLE == EPOLLIN && EVENT_WRITABLE == EPOLLOUT &&
+              EVENT_ERROR == EPOLLERR && EVENT_HANGUP == EPOLLHUP, "EVENT_* bits are epoll bits");
+#endif
+
+// =============================================================================
+// EVENT REACTOR CLASS IMPLEMENTATION
+// =============================================================================
+
+EventReactor::EventReactor()
+    : epoll_fd(-1), stop_fd(-1), stop_requested(false), wakeups(0), events_dispatched(0), timer_overruns(0) {
+    for (Watch& watch : watches) {
+        watch = {-1, 0, 0, false, false, nullptr, nullptr};
+    }
+}
+
+EventReactor::~EventReactor() {
+    close();
+}
+
+EventReactor::Watch* EventReactor::findWatch(int fd) {
+    for (Watch& watch : watches) {
+        if (watch.fd == fd && fd >= 0) {
+            return &watch;
+        }
+    }
+    return nullptr;
+}
+
+#ifdef __linux__
+
+// Stops run(), the counter was already read by runOnce()
+static void onStop(int fd, uint32_t count, void* user_data) {
+    (void)fd;
+    (void)count;
+    (void)user_data;
+}
+
+/*
+* Creates the epoll set
+*
+* @return: true if the reactor can be used
+*/
+bool EventReactor::open() {
+    if (epoll_fd >= 0) {
+        return true;
+    }
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd < 0) {
+        std::cerr << "Error: Unable to create epoll set: " << strerror(errno) << std::endl;
+        return false;
+    }
+    stop_requested = false;
+    stop_fd = addNotifier(&onStop, nullptr);
+    if (stop_fd < 0) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+/*
+* Removes all watches (closing the reactor's own descriptors) and the epoll set
+*/
+void EventReactor::close() {
+    for (Watch& watch : watches) {
+        if (watch.fd >= 0) {
+            remove(watch.fd);
+        }
+    }
+    stop_fd = -1;
+    if (epoll_fd >= 0) {
+        ::close(epoll_fd);
+        epoll_fd = -1;
+    }
+}
+
+bool EventReactor::addWatch(int fd, uint32_t interest, bool counter, bool owned, EventCallback callback, void* user_data) {
+    if (epoll_fd < 0 || fd < 0 || callback == nullptr || findWatch(fd) != nullptr) {
+        return false;
+    }
+
+    // Step 1: Free slot, its generation tags the epoll events
+    int slot = 0;
+    while (slot < EVENT_REACTOR_MAX_WATCHES && watches[slot].fd >= 0) {
+        slot++;
+    }
+    if (slot == EVENT_REACTOR_MAX_WATCHES) {
+        std::cerr << "Error: Event reactor is full (" << EVENT_REACTOR_MAX_WATCHES << " descriptors)" << std::endl;
+        return false;
+    }
+    Watch& watch = watches[slot];
+
+    // Step 2: Register
+    epoll_event event = {};
+    event.events = interest;
+    event.data.u64 = ((uint64_t)watch.generation << 32) | (uint32_t)slot;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+        std::cerr << "Error: Unable to watch descriptor " << fd << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    watch.fd = fd;
+    watch.interest = interest;
+    watch.counter = counter;
+    watch.owned = owned;
+    watch.callback = callback;
+    watch.user_data = user_data;
+    return true;
+}
+
+/*
+* Watches a descriptor for input (and hangup/errors)
+* The descriptor should be non-blocking, the callback reads until EAGAIN.
+*/
+bool EventReactor::addReader(int fd, EventCallback callback, void* user_data) {
+    return addWatch(fd, EVENT_READABLE, false, false, callback, user_data);
+}
+
+/*
+* Adds or drops EVENT_WRITABLE for a watched descriptor
+* Costs a syscall only when the interest changes.
+*/
+bool EventReactor::setWriteInterest(int fd, bool enabled) {
+    Watch* watch = findWatch(fd);
+    if (watch == nullptr) {
+        return false;
+    }
+    uint32_t interest = enabled ? (watch->interest | EVENT_WRITABLE) : (watch->interest & ~EVENT_WRITABLE);
+    if (interest == watch->interest) {
+        return true;
+    }
+    epoll_event event = {};
+    event.events = interest;
+    event.data.u64 = ((uint64_t)watch->generation << 32) | (uint32_t)(watch - watches);
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &event) != 0) {
+        return false;
+    }
+    watch->interest = interest;
+    return true;
+}
+
+/*
+* Stops watching a descriptor, events of it already collected are skipped
+* Caller descriptors stay open, timers and notifiers are closed.
+*/
+void EventReactor::remove(int fd) {
+    Watch* watch = findWatch(fd);
+    if (watch == nullptr) {
+        return;
+    }
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    if (watch->owned) {
+        ::close(fd);
+    }
+    watch->fd = -1;
+    watch->generation++;
+    watch->callback = nullptr;
+    watch->user_data = nullptr;
+}
+
+/*
+* Adds a periodic timer (timerfd, steady clock)
+* The period is fixed, a late callback does not shift the following ones.
+*
+* @param interval_ms: Period in milliseconds
+* @return: Timer descriptor, -1 if error
+*/
+int EventReactor::addTimer(int interval_ms, EventCallback callback, void* user_data) {
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "Error: Unable to create timer: " << strerror(errno) << std::endl;
+        return -1;
+    }
+    if (!addWatch(fd, EVENT_READABLE, true, true, callback, user_data)) {
+        ::close(fd);
+        return -1;
+    }
+    if (!setTimerInterval(fd, interval_ms)) {
+        remove(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/*
+* Changes a timer's period, the next expiry is one period from now
+*
+* @param interval_ms: Period in milliseconds, 0 disarms the timer
+*/
+bool EventReactor::setTimerInterval(int fd, int interval_ms) {
+    if (interval_ms < 0) interval_ms = 0;
+    itimerspec spec = {};
+    spec.it_interval.tv_sec = interval_ms / 1000;
+    spec.it_interval.tv_nsec = (long)(interval_ms % 1000) * 1000000L;
+    spec.it_value = spec.it_interval;
+    return timerfd_settime(fd, 0, &spec, nullptr) == 0;
+}
+
+/*
+* Adds a notifier (eventfd) other threads wake the reactor with notify()
+*
+* @return: Notifier descriptor, -1 if error
+*/
+int EventReactor::addNotifier(EventCallback callback, void* user_data) {
+    int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "Error: Unable to create notifier: " << strerror(errno) << std::endl;
+        return -1;
+    }
+    if (!addWatch(fd, EVENT_READABLE, true, true, callback, user_data)) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/*
+* Wakes the reactor for a notifier, safe from any thread and never blocks
+* Several calls before the reactor runs make one callback.
+*/
+void EventReactor::notify(int fd) {
+    uint64_t one = 1;
+    if (fd >= 0 && write(fd, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+        std::cerr << "Error: Unable to notify the event reactor" << std::endl;
+    }
+}
+
+/*
+* Waits once and dispatches everything that is ready
+*
+* @param timeout_ms: Longest wait, -1 = until something is ready
+* @return: Number of callbacks made, -1 if the wait failed
+*/
+int EventReactor::runOnce(int timeout_ms) {
+    epoll_event events[EVENT_REACTOR_MAX_EVENTS];
+    int count = epoll_wait(epoll_fd, events, EVENT_REACTOR_MAX_EVENTS, timeout_ms);
+    if (count < 0) {
+        if (errno == EINTR) {
+            return 0;
+        }
+        std::cerr << "Error: epoll_wait failed: " << strerror(errno) << std::endl;
+        return -1;
+    }
+    wakeups++;
+
+    int dispatched = 0;
+    for (int i = 0; i < count; i++) {
+        // Step 1: Skip events of watches removed by an earlier callback
+        uint32_t slot = (uint32_t)events[i].data.u64;
+        uint32_t generation = (uint32_t)(events[i].data.u64 >> 32);
+        Watch& watch = watches[slot];
+        if (watch.fd < 0 || watch.generation != generation) {
+            continue;
+        }
+
+        // Step 2: Timers and notifiers report their count instead of bits
+        uint32_t bits = events[i].events;
+        if (watch.counter) {
+            uint64_t value = 0;
+            if (read(watch.fd, &value, sizeof(value)) != (ssize_t)sizeof(value)) {
+                continue;
+            }
+            if (value > 1 && watch.fd != stop_fd) {
+                timer_overruns += value - 1;
+            }
+            bits = value > 0xFFFFFFFFULL ? 0xFFFFFFFFU : (uint32_t)value;
+        }
+        watch.callback(watch.fd, bits, watch.user_data);
+        dispatched++;
+    }
+    events_dispatched += dispatched;
+    return dispatched;
+}
+
+/*
+* Dispatches on the calling thread until stop()
+*/
+void EventReactor::run() {
+    while (!stop_requested && epoll_fd >= 0) {
+        if (runOnce(-1) < 0) {
+            break;
+        }
+    }
+    stop_requested = false;
+}
+
+#else // No epoll: the reactor cannot be opened, callers fall back to their threads
+
+bool EventReactor::open() {
+    std::cerr << "Error: The event reactor needs epoll (Linux)" << std::endl;
+    return false;
+}
+
+void EventReactor::close() {
+}
+
+bool EventReactor::addWatch(int, uint32_t, bool, bool, EventCallback, void*) {
+    return false;
+}
+
+bool EventReactor::addReader(int, EventCallback, void*) {
+    return false;
+}
+
+bool EventReactor::setWriteInterest(int, bool) {
+    return false;
+}
+
+void EventReactor::remove(int) {
+}
+
+int EventReactor::addTimer(int, EventCallback, void*) {
+    return -1;
+}
+
+bool EventReactor::setTimerInterval(int, int) {
+    return false;
+}
+
+int EventReactor::addNotifier(EventCallback, void*) {
+    return -1;
+}
+
+void EventReactor::notify(int) {
+}
+
+int EventReactor::runOnce(int) {
+    return -1;
+}
+
+void EventReactor::run() {
+}
+
+#endif // __linux__
+
+bool EventReactor::isOpen() const {
+    return epoll_fd >= 0;
+}
+
+/*
+* Ends run() after the current dispatch, safe from any thread
+*/
+void EventReactor::stop() {
+    stop_requested = true;
+    notify(stop_fd);
+}
+
+EventReactorStats EventReactor::getStats() const {
+    return {wakeups, events_dispatched, timer_overruns};
+}
@@ -0,0 +1,312 @@
+#include "include/led_animation.h"
+#include "include/led_controller_display.h"   // For the display scroll
+
+#include <iostream>             // For std::cout and std::cerr
+#include <algorithm>            // For std::remove_if, std::max
+
+// =============================================================================
+// ANIMATION HELPER FUNCTIONS - Build procedural animations
+// =============================================================================
+
+/*
+* Fade all targets from one level to another, once
+*
+* @param targets: LEDs to drive
+* @param color: Color for matrix pads
+* @param from_level: Start brightness level (0-127)
+* @param to_level: End brightness level (0-127), kept after the fade
+* @param duration_ticks: Length of the fade in ticks
+*/
+LEDAnimation makeFadeAnimation(const std::vector<LEDTarget>& targets, LEDColor color, uint8_t from_level, uint8_t to_level, int duration_ticks) {
+    LEDAnimation animation;
+    animation.type = LEDAnimationType::FADE;
+    animation.targets = targets;
+    animation.color = color;
+    animation.low_level = from_level;
+    animation.high_level = to_level;
+    animation.period_ticks = duration_ticks;
+    animation.repeat = 1;
+    return animation;
+}
+
+/*
+* Pulse all targets between two levels (triangle wave)
+*
+* @param period_ticks: Length of one low-high-low cycle in ticks
+* @param repeat: Number of cycles, 0 = until cancelled
+*/
+LEDAnimation makePulseAnimation(const std::vector<LEDTarget>& targets, LEDColor color, uint8_t low_level, uint8_t high_level, int period_ticks, int repeat) {
+    LEDAnimation animation = makeFadeAnimation(targets, color, low_level, high_level, period_ticks);
+    animation.type = LEDAnimationType::PULSE;
+    animation.repeat = repeat;
+    return animation;
+}
+
+/*
+* Blink all targets between two levels (50% duty cycle)
+*
+* @param period_ticks: Length of one on-off cycle in ticks
+* @param repeat: Number of cycles, 0 = until cancelled
+*/
+LEDAnimation makeBlinkAnimation(const std::vector<LEDTarget>& targets, LEDColor color, uint8_t low_level, uint8_t high_level, int period_ticks, int repeat) {
+    LEDAnimation animation = makePulseAnimation(targets, color, low_level, high_level, period_ticks, repeat);
+    animation.type = LEDAnimationType::BLINK;
+    return animation;
+}
+
+/*
+* Light one target after the other, the rest stays at low_level
+*
+* @param step_ticks: Ticks each target stays lit
+* @param repeat: Number of passes over all targets, 0 = until cancelled
+*/
+LEDAnimation makeChaseAnimation(const std::vector<LEDTarget>& targets, LEDColor color, uint8_t low_level, uint8_t high_level, int step_ticks, int repeat) {
+    LEDAnimation animation = makePulseAnimation(targets, color, low_level, high_level, step_ticks, repeat);
+    animation.type = LEDAnimationType::CHASE;
+    return animation;
+}
+
+/*
+* Sets one LED target to a level without touching the state storage
+*
+* @param target: LED to set
+* @param color: Color for matrix pads (ignored for single-color LEDs)
+* @param level: Brightness level (0-127)
+* @return: true if the buffer was updated, false if error
+*/
+bool setLEDTargetLevel(LEDTarget target, LEDColor color, uint8_t level) {
+    switch (target.type) {
+        case LEDTargetType::MATRIX:
+            return setMatrixButtonLEDLevel(target.index / MATRIX_COLS, target.index % MATRIX_COLS, color, level, false);
+        case LEDTargetType::BUTTON:
+            return setButtonLEDLevel((LEDButton)target.index, level, false);
+        case LEDTargetType::STOP:
+            return setStopButtonLEDLevel(target.index, level, false);
+    }
+    return false;
+}
+
+// =============================================================================
+// LED ANIMATION ENGINE CLASS IMPLEMENTATION
+// =============================================================================
+
+LEDAnimationEngine::LEDAnimationEngine() : tick_count(0), next_id(1), running(false), tick_ms(LED_ANIMATION_DEFAULT_TICK_MS) {
+}
+
+LEDAnimationEngine::~LEDAnimationEngine() {
+    stop();
+}
+
+/*
+* Starts the tick thread
+*
+* @param tick_ms: Tick length in milliseconds
+* @return: true if the thread is running
+*/
+bool LEDAnimationEngine::start(int tick_ms) {
+    if (running) {
+        return true;
+    }
+    this->tick_ms = std::max(1, tick_ms);
+    running = true;
+    tick_thread = std::thread(&LEDAnimationEngine::tickLoop, this);
+    return true;
+}
+
+/*
+* Stops the tick thread, active animations stay where they are
+*/
+void LEDAnimationEngine::stop() {
+    if (!running.exchange(false)) {
+        return;
+    }
+    if (tick_thread.joinable()) {
+        tick_thread.join();
+    }
+}
+
+// true while the engine's own tick thread runs
+bool LEDAnimationEngine::isRunning() const {
+    return running;
+}
+
+int LEDAnimationEngine::getTickMs() const {
+    return tick_ms;
+}
+
+/*
+* Advances all animations by one tick
+* All animations paint one frame together, which is flushed once.
+*/
+void LEDAnimationEngine::tick() {
+    uint64_t tick = tick_count++;
+
+    {
+        std::lock_guard<std::mutex> lock(animation_mutex);
+        if (animations.empty() && !hasActiveLEDModes() && !isDisplayScrolling()) {
+            return;
+        }
+
+        // Step 1: Paint all animations, blinking/pulsing LEDs and the display scroll into one frame
+        beginLEDFrame();
+        for (const ActiveAnimation& active : animations) {
+            evaluate(active, tick - active.start_tick);
+        }
+        uint64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        updateLEDModes(now_ms);
+        updateDisplayScroll(now_ms);
+        commitLEDFrame();
+
+        // Step 2: Drop animations that played their last tick
+        animations.erase(std::remove_if(animations.begin(), animations.end(), [tick](const ActiveAnimation& active) {
+            return active.total_ticks > 0 && tick - active.start_tick + 1 >= (uint64_t)active.total_ticks;
+        }), animations.end());
+    }
+
+    // Step 3: One report for the whole tick
+    flushLEDReport();
+}
+
+/*
+* Starts playing an animation on the next tick
+*
+* @param animation: Animation to play (copied)
+* @return: Animation id for cancel() and isPlaying()
+*/
+int LEDAnimationEngine::play(const LEDAnimation& animation) {
+    ActiveAnimation active;
+    active.animation = animation;
+    active.animation.period_ticks = std::max(1, animation.period_ticks);
+
+    // Step 1: Calculate how many ticks the animation lasts (0 = forever)
+    int period = active.animation.period_ticks;
+    int cycle_ticks = period;
+    if (animation.type == LEDAnimationType::KEYFRAMES) {
+        int steps = 0;
+        for (const LEDKeyframe& keyframe : animation.keyframes) {
+            steps = std::max(steps, keyframe.step + 1);
+        }
+        cycle_ticks = steps * period;
+    } else if (animation.type == LEDAnimationType::CHASE) {
+        cycle_ticks = (int)animation.targets.size() * period;
+    }
+    active.cycle_ticks = std::max(1, cycle_ticks);
+    active.total_ticks = animation.repeat > 0 ? active.cycle_ticks * animation.repeat : 0;
+
+    // Step 2: Register it
+    std::lock_guard<std::mutex> lock(animation_mutex);
+    active.id = next_id++;
+    active.start_tick = tick_count;
+    animations.push_back(active);
+    return active.id;
+}
+
+/*
+* Stops an animation, its LEDs keep their last value
+*/
+void LEDAnimationEngine::cancel(int id) {
+    std::lock_guard<std::mutex> lock(animation_mutex);
+    animations.erase(std::remove_if(animations.begin(), animations.end(), [id](const ActiveAnimation& active) {
+        return active.id == id;
+    }), animations.end());
+}
+
+void LEDAnimationEngine::cancelAll() {
+    std::lock_guard<std::mutex> lock(animation_mutex);
+    animations.clear();
+}
+
+bool LEDAnimationEngine::isPlaying(int id) {
+    std::lock_guard<std::mutex> lock(animation_mutex);
+    for (const ActiveAnimation& active : animations) {
+        if (active.id == id) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool LEDAnimationEngine::isIdle() {
+    std::lock_guard<std::mutex> lock(animation_mutex);
+    return animations.empty();
+}
+
+// =============================================================================
+// PRIVATE HELPER FUNCTIONS
+// =============================================================================
+
+/*
+* Paints one animation at a given tick into the back buffer
+* Integer math only
+*
+* @param active: Animation to evaluate
+* @param tick: Ticks since the animation started
+*/
+void LEDAnimationEngine::evaluate(const ActiveAnimation& active, uint64_t tick) {
+    const LEDAnimation& animation = active.animation;
+    int period = animation.period_ticks;
+    int low = animation.low_level;
+    int high = animation.high_level;
+    int phase = (int)(tick % period);
+    int level = low;
+
+    switch (animation.type) {
+        case LEDAnimationType::KEYFRAMES: {
+            // Keyframes are applied once, at the start of their step
+            if (phase != 0 || animation.keyframes.empty()) {
+                return;
+            }
+            int steps = active.cycle_ticks / period;
+            int step = (int)((tick / period) % steps);
+            for (const LEDKeyframe& keyframe : animation.keyframes) {
+                if (keyframe.step == step) {
+                    setLEDTargetLevel(keyframe.target, keyframe.color, keyframe.level);
+                }
+            }
+            return;
+        }
+        case LEDAnimationType::FADE:
+            level = low + (high - low) * (phase + 1) / period;
+            break;
+        case LEDAnimationType::PULSE: {
+            int half = std::max(1, period / 2);
+            if (phase < half) {
+                level = low + (high - low) * phase / half;
+            } else {
+                level = high - (high - low) * (phase - half) / std::max(1, period - half);
+            }
+            break;
+        }
+        case LEDAnimationType::BLINK:
+            level = (phase < period / 2 || period == 1) ? high : low;
+            break;
+        case LEDAnimationType::CHASE: {
+            if (animation.targets.empty()) {
+                return;
+            }
+            int lit = (int)((tick / period) % animation.targets.size());
+            for (int i = 0; i < (int)animation.targets.size(); i++) {
+                setLEDTargetLevel(animation.targets[i], animation.color, (uint8_t)(i == lit ? high : low));
+            }
+            return;
+        }
+    }
+
+    for (const LEDTarget& target : animation.targets) {
+        setLEDTargetLevel(target, animation.color, (uint8_t)level);
+    }
+}
+
+/*
+* Tick thread body
+* Ticks on a fixed schedule, so slow ticks do not shift the timing
+*/
+void LEDAnimationEngine::tickLoop() {
+    auto next_tick = std::chrono::steady_clock::now();
+    while (running) {
+        tick();
+        next_tick += std::chrono::milliseconds(tick_ms.load());
+        std::this_thread::sleep_until(next_tick);
+    }
+}
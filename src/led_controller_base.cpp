@@ -4,20 +4,115 @@
 #include <iomanip>              // For std::hex (hexadecimal printing)
 #include <cstring>              // For memset (clearing memory)
 #include <unistd.h>             // For usleep (sleep function)
+#include <chrono>               // For flush rate limiting and write statistics
+#include <mutex>                // For std::mutex guarding the LED buffers
+#include <atomic>               // For thread-safe flags and counters
+#include <array>                // For the compile-time lookup tables
+#include <cmath>                // For std::floor in the LED mode evaluation
+#include <algorithm>            // For std::max
+#include "include/led_output_writer.h"
+#include "include/led_frame_encoder.h"
+#include "include/led_layers.h"
 // #include <hidapi/hidapi.h>   // included already in header
 
 
 // =============================================================================
-// GLOBAL LED STATE BYTE BUFFER - Persistent byte buffer for all LED states
+// OUTPUT FRAMEBUFFERS - Back and front buffer of the F1
 // =============================================================================
 
 /*
-* This byte buffer holds the current state of all LEDs on the F1.
-* It's persistent, so changing one LED does not affect the others.
-* The byte buffer is always ready to send to the F1 device.
+* The LED output of the F1: its framebuffer pair, the device it is sent to
+* and the copy of what the device shows. The buffers hold the current state
+* of all LEDs as linear levels, flushes encode them (brightness curves)
+* before sending.
+*
+* There is one instance per process, like the state storage and the layers
+* below: the LED API has no device parameter, and the driver drives one F1.
+* Two ControllerHandlers in one process would share it, only run one.
+*
+* back is the BACK buffer: setters paint here outside a frame, and frames
+* are merged into it when they are committed. A commit copies it to the
+* FRONT buffer in one step, together with a snapshot of the LED layers, and
+* only the front buffer is ever encoded and sent.
+*
+* The fine buffers hold the same levels with LED_DITHER_BITS fraction bits
+* (7.5 fixed point, 0 - 127 << 5). Float setters store the brightness they
+* were given there before it is rounded to 7 bits, so dithered groups get
+* their extra precision from the input. Byte and level setters store the
+* level without a fraction.
+*
+* Guarded by led_buffer_mutex, except the last sent frame: it is guarded by
+* led_output_mutex, because the writer thread and a direct sendLEDReport()
+* on another thread may both send. A refresh interval > 0 lets an identical
+* frame through once it is that old, so a device that lost its state is
+* repainted eventually.
+*/
+struct LEDOutputFrames {
+    hid_device* device;                               // Store device for automatic sending
+    unsigned char back[LED_REPORT_SIZE];
+    uint16_t fine_back[LED_REPORT_SIZE];
+    unsigned char front[LED_REPORT_SIZE];             // Last committed frame
+    uint16_t fine_front[LED_REPORT_SIZE];
+    LEDLayerSnapshot front_layers;                    // Layers as of the last commit
+    std::atomic<bool> back_dirty;                     // Back buffer has uncommitted changes
+    std::atomic<bool> front_dirty;                    // Front buffer has unsent changes
+    unsigned char last_sent_frame[LED_REPORT_SIZE];   // Suppresses writes of frames the device already shows
+    bool last_sent_valid;
+    std::chrono::steady_clock::time_point last_sent_time;
+};
+
+static LEDOutputFrames led_output = {};
+
+/*
+* A frame painted by one thread (see beginLEDFrame())
+* Setters called between beginLEDFrame() and commitLEDFrame() paint into
+* their thread's frame, and only the bytes they painted are merged into the
+* back buffer on commit. Several threads can paint frames at the same time
+* without one commit publishing another thread's half-painted frame.
 */
-unsigned char led_buffer[LED_REPORT_SIZE];
-hid_device* current_device = nullptr;  // Store device for automatic sending
+struct LEDThreadFrame {
+    int depth;                                        // Nested beginLEDFrame() calls
+    unsigned char levels[LED_REPORT_SIZE];
+    uint16_t fine[LED_REPORT_SIZE];
+    bool touched[LED_REPORT_SIZE];                    // Painted in this frame
+};
+
+static thread_local LEDThreadFrame thread_frame;
+
+// =============================================================================
+// FRAME FLUSH STATE - Dirty tracking, flush policy and write statistics
+// =============================================================================
+
+/*
+* Setters only mark the buffer dirty. The flush functions below decide when
+* the dirty buffer is sent, so a full repaint costs one hid_write().
+*
+* led_buffer_mutex is held only while bytes are written or copied, never
+* during USB I/O, so setters from several threads never block on the device.
+* led_output_mutex is held during USB I/O, it only ever blocks other senders.
+*/
+static std::mutex led_buffer_mutex;
+static std::mutex led_output_mutex;                 // Serializes hid_write() and the last sent frame
+static LEDFlushPolicy flush_policy = LEDFlushPolicy::END_OF_RUN;
+static std::chrono::steady_clock::duration min_frame_interval{0};
+static std::atomic<std::chrono::steady_clock::rep> last_flush_time{0};
+static LEDOutputWriter* current_writer = nullptr;   // Writer thread, if one is attached
+
+static std::atomic<uint64_t> stat_led_changes{0};
+static std::atomic<uint64_t> stat_reports_sent{0};
+static std::atomic<uint64_t> stat_reports_failed{0};
+static std::atomic<uint64_t> stat_reports_suppressed{0};
+
+// Latency: origin of the oldest change not yet handed to the output (0 = none)
+static std::atomic<int64_t> pending_origin_ns{0};
+static std::atomic<uint64_t> stat_latency_samples{0};
+static std::atomic<int64_t> stat_latency_total_ns{0};
+static std::atomic<int64_t> stat_latency_max_ns{0};
+static std::atomic<int64_t> stat_latency_last_ns{0};
+
+// Forced refresh of unchanged frames, see setLEDRefreshInterval()
+static std::atomic<std::chrono::steady_clock::rep> refresh_interval{0};
+static std::chrono::steady_clock::time_point stat_start_time = std::chrono::steady_clock::now();
 
 // =============================================================================
 // PARALLEL STATE STORAGE - Preserve original color/brightness values
@@ -29,25 +124,49 @@ hid_device* current_device = nullptr;  // Store device for automatic sending
 * These arrays store the original color and brightness values that were passed
 * to the LED functions, BEFORE conversion to 7-bit hardware format. This allows
 * other modules, such as the toggle system, to restore exact original values.
+* All indices are 0-based, like the setters. Guarded by led_buffer_mutex.
 */
-static LEDStateMatrix matrix_states[5][5];         // Original states for 5x5 matrix
+static LEDStateMatrix matrix_states[MATRIX_ROWS][MATRIX_COLS]; // Original states for 4x4 matrix
 static LEDState special_states[5];                 // Original states for 5 special buttons
 static LEDState control_states[3];                 // Original states for 3 control buttons
-static LEDState stop_states[4];                    // Original states for 4 stop buttons
+static LEDState stop_states[LED_STOP_COUNT];       // Original states for 4 stop buttons
+
+/*
+* Maps a button to its state slot, in the same way the setters map it to a byte:
+* the first three buttons are control buttons, the rest are special buttons
+*/
+static LEDState& buttonState(int index) {
+    return index < 3 ? control_states[index] : special_states[index - 3];
+}
+
+/*
+* Per-LED modes (steady, blink, pulse)
+*
+* A blinking or pulsing LED is driven from its stored state above, so the
+* app can change color or brightness while it blinks. updateLEDModes() is
+* called once per animation tick and repaints all of them in one frame.
+* Buttons are indexed by LEDButton. Guarded by led_buffer_mutex.
+*/
+static LEDModeState matrix_modes[MATRIX_ROWS][MATRIX_COLS];
+static LEDModeState button_modes[LED_BUTTON_COUNT];
+static LEDModeState stop_modes[LED_STOP_COUNT];
+static std::atomic<int> active_mode_count{0};      // LEDs that are not STEADY
+static std::atomic<LEDBeatClock*> beat_clock{nullptr};   // Beat position for BEAT modes, may be null
 
 // =============================================================================
 // HELPER FUNCTIONS - Internal functions for color conversion and validation
 // =============================================================================
 
 /*
-* Converts 8-bit color value (0-255) to 7-bit value (0-127) with brightness
-* The F1 hardware only accepts 7-bit color values, so we must convert.
+* Float reference conversion: 8-bit color value (0-255) to 7-bit value (0-127)
+* This was the per-channel conversion before the lookup tables. It is only
+* kept so benchmarkColorConversion() can compare against it.
 * 
 * @param value_8bit: Original color value (0-255)
 * @param brightness: Brightness multiplier (0.0 = off, 1.0 = full brightness)
 * @return: 7-bit color value (0-127) with brightness applied
 */
-static unsigned char convertTo7Bit(unsigned char value_8bit, float brightness) {
+static unsigned char convertTo7BitFloat(unsigned char value_8bit, float brightness) {
     // Step 1: Clamp brightness to valid range (0.0 to 1.0)
     if (brightness < 0.0f) brightness = 0.0f;
     if (brightness > 1.0f) brightness = 1.0f;
@@ -63,16 +182,136 @@ static unsigned char convertTo7Bit(unsigned char value_8bit, float brightness) {
     return (unsigned char)(result + 0.5f);
 }
 
+/*
+* Integer 8-bit to 7-bit conversion at a brightness level, rounded to nearest
+* value_8bit * 127/255 * level/127 simplifies to value_8bit * level / 255.
+* Only used at compile time to generate the lookup tables.
+*/
+static constexpr uint8_t scaleTo7Bit(int value_8bit, int level) {
+    return (uint8_t)((value_8bit * level + 127) / 255);
+}
+
+/*
+* Converts a float brightness to a level with LED_DITHER_BITS fraction bits
+* The unrounded counterpart of brightnessToLevel(), for the fine buffers.
+*
+* @param value_8bit: Color channel (0-255), 255 for single-color LEDs
+* @param brightness: Brightness (0.0 = off, 1.0 = full brightness)
+* @return: Level in 7.5 fixed point (0 - 127 << LED_DITHER_BITS), clamped
+*/
+static uint16_t brightnessToFineLevel(uint8_t value_8bit, float brightness) {
+    if (!(brightness > 0.0f)) return 0;       // Also catches NaN
+    if (brightness > 1.0f) brightness = 1.0f;
+    return (uint16_t)(value_8bit * brightness * ((127 << LED_DITHER_BITS) / 255.0f) + 0.5f);
+}
+
+/*
+* Writes one LED byte where the calling thread paints: its open frame, or
+* the back buffer. Requires led_buffer_mutex to be held.
+*
+* @param byte_position: Byte in the LED report (1-80)
+* @param level: 7-bit level
+* @param fine: Level with fraction bits, see LEDOutputFrames
+*/
+static void paintLEDByte(int byte_position, uint8_t level, uint16_t fine) {
+    if (thread_frame.depth > 0) {
+        thread_frame.levels[byte_position] = level;
+        thread_frame.fine[byte_position] = fine;
+        thread_frame.touched[byte_position] = true;
+        return;
+    }
+    led_output.back[byte_position] = level;
+    led_output.fine_back[byte_position] = fine;
+}
+
 /*
 * Validates matrix button position (row and column)
-* Matrix buttons are arranged in a 4x4 grid, rows 1-4, columns 1-4
+* Matrix buttons are arranged in a 4x4 grid, rows 0-3, columns 0-3
 * 
-* @param row: Matrix row (should be 1-4)
-* @param col: Matrix column (should be 1-4)  
+* @param row: Matrix row (should be 0-3)
+* @param col: Matrix column (should be 0-3)  
 * @return: true if position is valid, false if invalid
 */
 static bool isValidMatrixPosition(int row, int col) {
-    return (row >= 1 && row <= MATRIX_ROWS && col >= 1 && col <= MATRIX_COLS);
+    return (row >= 0 && row < MATRIX_ROWS && col >= 0 && col < MATRIX_COLS);
+}
+
+/*
+* Writes the three 7-bit BRG bytes of a matrix button and marks the buffer dirty
+* Matrix mapping: row * 4 + col gives button index (0-15), 3 bytes per button
+* 
+* @param row: Matrix row (0-3)
+* @param col: Matrix column (0-3)
+* @param value: 7-bit BRG values to write
+* @param fine: Optional BRG values with fraction bits, see LEDOutputFrames
+* @return: true if the buffer was updated, false if the position is invalid
+*/
+static bool writeMatrixButtonBytes(int row, int col, BRGColor value, const uint16_t* fine = nullptr) {
+    // Step 1: Validate the position
+    if (row < 0 || row >= MATRIX_ROWS || col < 0 || col >= MATRIX_COLS) {
+        std::cerr << "Error: Invalid matrix position (" << row << "," << col << ")" << std::endl;
+        return false;
+    }
+
+    // Step 2: Calculate the byte position for this matrix button
+    int button_index = row * MATRIX_COLS + col;
+    int base_byte = LED_BYTE_MATRIX_START + (button_index * MATRIX_LEDS_PER_BUTTON);
+
+    // Step 3: Set the three LED bytes for this button (Blue, Red, Green order)
+    std::lock_guard<std::mutex> lock(led_buffer_mutex);
+    paintLEDByte(base_byte,     value.blue,  fine != nullptr ? fine[0] : (uint16_t)(value.blue << LED_DITHER_BITS));    // Blue LED
+    paintLEDByte(base_byte + 1, value.red,   fine != nullptr ? fine[1] : (uint16_t)(value.red << LED_DITHER_BITS));     // Red LED
+    paintLEDByte(base_byte + 2, value.green, fine != nullptr ? fine[2] : (uint16_t)(value.green << LED_DITHER_BITS));   // Green LED
+
+    // Step 4: Mark the buffer dirty, the next flush sends it to the F1
+    markLEDBufferDirty();
+    return true;
+}
+
+// =============================================================================
+// BYTE POSITION FUNCTIONS - Where each LED lives in the report
+// =============================================================================
+
+/*
+* Gets the first (blue) byte of a matrix button, red and green follow
+*
+* @param row: Matrix row (0-3)
+* @param col: Matrix column (0-3)
+* @return: Byte position in the LED report, or -1 if the position is invalid
+*/
+int getMatrixButtonByte(int row, int col) {
+    if (!isValidMatrixPosition(row, col)) {
+        return -1;
+    }
+    return LED_BYTE_MATRIX_START + (row * MATRIX_COLS + col) * MATRIX_LEDS_PER_BUTTON;
+}
+
+/*
+* Gets the byte of a button: the first three are control buttons,
+* the rest special buttons
+*
+* @param button: Which button (using enum)
+* @return: Byte position in the LED report, or -1 if the button is invalid
+*/
+int getButtonByte(LEDButton button) {
+    int index = (int)button;
+    if (index < 0 || index >= LED_BUTTON_COUNT) {
+        return -1;
+    }
+    return index < 3 ? LED_BYTE_CONTROL_START + index : LED_BYTE_SPECIAL_START + (index - 3);
+}
+
+/*
+* Gets the left LED byte of a stop button, the right LED is the byte before it
+*
+* @param index: Which stop button (0-3)
+* @return: Byte position in the LED report, or -1 if the index is invalid
+*/
+int getStopButtonByte(int index) {
+    if (index < 0 || index >= LED_STOP_COUNT) {
+        return -1;
+    }
+    return LED_BYTE_STOP_START + (7 - (index * 2));
 }
 
 // =============================================================================
@@ -93,8 +332,8 @@ static bool isValidMatrixPosition(int row, int col) {
 * Returns the original color and brightness that were set for this matrix
 * button position, before any 7-bit conversion or hardware formatting.
 * 
-* @param row: Matrix row (1-4)
-* @param col: Matrix column (1-4)
+* @param row: Matrix row (0-3)
+* @param col: Matrix column (0-3)
 * @return: LEDState with original color and brightness, or error state if invalid position
 */
 LEDStateMatrix getMatrixButtonState(int row, int col) {
@@ -106,6 +345,7 @@ LEDStateMatrix getMatrixButtonState(int row, int col) {
     }
     
     // Return the stored original state
+    std::lock_guard<std::mutex> lock(led_buffer_mutex);
     return matrix_states[row][col];
 }
 
@@ -124,13 +364,330 @@ LEDState getButtonState(LEDButton button) {
     int index = (int) button;
     
     // Validate index
-    if (index < 0 || index > 8) {
-        std::cerr << "Error: Invalid special button in getSpecialButtonState()" << std::endl;
+    if (index < 0 || index >= LED_BUTTON_COUNT) {
+        std::cerr << "Error: Invalid special button in getButtonState()" << std::endl;
         return {0.0f}; // Return error state
     }
     
     // Return the stored original state
-    return special_states[index];
+    std::lock_guard<std::mutex> lock(led_buffer_mutex);
+    return buttonState(index);
+}
+
+/*
+* Replaces the whole state storage at once
+* 
+* Used when a complete set of LEDs is swapped in, for example when a page
+* scene is activated, so the getters above report the new states. Only the
+* state storage changes, the caller writes the matching LED bytes.
+* 
+* @param matrix: Matrix button states, [row][col] 0-based
+* @param buttons: Button states, indexed by LEDButton
+* @param stops: Stop button states (0-3)
+*/
+void loadLEDStates(const LEDStateMatrix matrix[MATRIX_ROWS][MATRIX_COLS],
+                   const LEDState buttons[LED_BUTTON_COUNT],
+                   const LEDState stops[LED_STOP_COUNT]) {
+    std::lock_guard<std::mutex> lock(led_buffer_mutex);
+    for (int row = 0; row < MATRIX_ROWS; row++) {
+        for (int col = 0; col < MATRIX_COLS; col++) {
+            matrix_states[row][col] = matrix[row][col];
+        }
+    }
+    for (int i = 0; i < LED_BUTTON_COUNT; i++) {
+        buttonState(i) = buttons[i];
+    }
+    for (int i = 0; i < LED_STOP_COUNT; i++) {
+        stop_states[i] = stops[i];
+    }
+}
+
+/*
+* Copies the whole state storage out, the counterpart of loadLEDStates()
+* 
+* @param matrix: Receives the matrix button states, [row][col] 0-based
+* @param buttons: Receives the button states, indexed by LEDButton
+* @param stops: Receives the stop button states (0-3)
+*/
+void saveLEDStates(LEDStateMatrix matrix[MATRIX_ROWS][MATRIX_COLS],
+                   LEDState buttons[LED_BUTTON_COUNT],
+                   LEDState stops[LED_STOP_COUNT]) {
+    std::lock_guard<std::mutex> lock(led_buffer_mutex);
+    for (int row = 0; row < MATRIX_ROWS; row++) {
+        for (int col = 0; col < MATRIX_COLS; col++) {
+            matrix[row][col] = matrix_states[row][col];
+        }
+    }
+    for (int i = 0; i < LED_BUTTON_COUNT; i++) {
+        buttons[i] = buttonState(i);
+    }
+    for (int i = 0; i < LED_STOP_COUNT; i++) {
+        stops[i] = stop_states[i];
+    }
+}
+
+// =============================================================================
+// LED MODE FUNCTIONS - Blink and pulse evaluated by the driver
+// =============================================================================
+
+/*
+* Sets all LEDs back to STEADY
+* Requires led_buffer_mutex to be held (or no other thread running yet).
+*/
+static void resetLEDModes() {
+    const LEDModeState steady = {LEDMode::STEADY, 0.0f, 0.0f};
+    for (int row = 0; row < MATRIX_ROWS; row++) {
+        for (int col = 0; col < MATRIX_COLS; col++) {
+            matrix_modes[row][col] = steady;
+        }
+    }
+    for (int i = 0; i < LED_BUTTON_COUNT; i++) {
+        button_modes[i] = steady;
+    }
+    for (int i = 0; i < LED_STOP_COUNT; i++) {
+        stop_modes[i] = steady;
+    }
+    active_mode_count = 0;
+}
+
+/*
+* Gets the brightness factor of a mode at a point in time
+* The phase shifts the LED within the period, so LEDs with the same rate
+* can blink in sync (same phase) or alternate (phase 0.0 and 0.5).
+* BEAT modes count periods in beats instead of seconds.
+*
+* @param mode: Mode of the LED
+* @param time_ms: Current time in milliseconds
+* @param beats: Current beat position, or a negative value if there is no running clock
+* @return: Factor for the stored level (0.0 - 1.0)
+*/
+static float getLEDModeFactor(const LEDModeState& mode, uint64_t time_ms, double beats) {
+    double cycles;
+    if (mode.sync == LEDModeSync::BEAT) {
+        if (beats < 0.0) {
+            return 1.0f;    // No clock, show the stored state
+        }
+        cycles = beats * mode.rate_hz + mode.phase;
+    } else {
+        cycles = time_ms / 1000.0 * mode.rate_hz + mode.phase;
+    }
+    double position = cycles - std::floor(cycles);     // 0.0 - 1.0 within the period
+    switch (mode.mode) {
+        case LEDMode::BLINK:
+            return position < 0.5 ? 1.0f : 0.0f;
+        case LEDMode::PULSE:
+            return (float)(1.0 - std::fabs(2.0 * position - 1.0));   // Triangle, full at mid-period
+        case LEDMode::STEADY:
+            break;
+    }
+    return 1.0f;
+}
+
+/*
+* Writes the bytes of one LED at a factor of its stored brightness
+* Requires led_buffer_mutex to be held.
+*/
+static void writeMatrixModeBytes(int row, int col, float factor) {
+    const LEDStateMatrix& state = matrix_states[row][col];
+    float brightness = state.brightness * factor;
+    BRGColor value = LED_COLOR_TABLE[(int)state.color][brightnessToLevel(brightness)];
+    BRGColor color = getColor(state.color);
+    int base_byte = getMatrixButtonByte(row, col);
+    paintLEDByte(base_byte,     value.blue,  brightnessToFineLevel(color.blue, brightness));
+    paintLEDByte(base_byte + 1, value.red,   brightnessToFineLevel(color.red, brightness));
+    paintLEDByte(base_byte + 2, value.green, brightnessToFineLevel(color.green, brightness));
+}
+
+static void writeButtonModeByte(int index, float factor) {
+    float brightness = buttonState(index).brightness * factor;
+    paintLEDByte(getButtonByte((LEDButton)index), brightnessToLevel(brightness), brightnessToFineLevel(255, brightness));
+}
+
+static void writeStopModeBytes(int index, float factor) {
+    float brightness = stop_states[index].brightness * factor;
+    uint8_t level = brightnessToLevel(brightness);
+    uint16_t fine = brightnessToFineLevel(255, brightness);
+    int left_byte = getStopButtonByte(index);
+    paintLEDByte(left_byte, level, fine);
+    paintLEDByte(left_byte - 1, level, fine);
+}
+
+/*
+* Validates a mode and updates the count of non-steady LEDs
+* Requires led_buffer_mutex to be held.
+*
+* @param slot: Mode slot of the LED
+* @param mode: New mode
+* @return: true if the mode was stored, false if the rate is invalid
+*/
+static bool storeLEDMode(LEDModeState& slot, LEDModeState mode) {
+    if (mode.mode != LEDMode::STEADY && !(mode.rate_hz > 0.0f)) {
+        std::cerr << "Error: Blink and pulse modes need a rate > 0 Hz" << std::endl;
+        return false;
+    }
+    mode.phase -= std::floor(mode.phase);
+    if (slot.mode == LEDMode::STEADY && mode.mode != LEDMode::STEADY) active_mode_count++;
+    if (slot.mode != LEDMode::STEADY && mode.mode == LEDMode::STEADY) active_mode_count--;
+    slot = mode;
+    return true;
+}
+
+/*
+* Sets the mode of a matrix button LED
+* Only the mode is stored, nothing is sent: the animation tick paints
+* blinking and pulsing LEDs. Back to STEADY restores the stored color.
+* The LED blinks with the color and brightness of its stored state.
+*
+* @param row: Matrix row (0-3)
+* @param col: Matrix column (0-3)
+* @param mode: STEADY, BLINK or PULSE
+* @param rate_hz: Periods per second, or per beat with LEDModeSync::BEAT (ignored for STEADY)
+* @param phase: Offset within the period (0.0 - 1.0)
+* @param sync: TIME or BEAT, see LEDModeSync
+* @return: true if the mode was set, false if error
+*/
+bool setMatrixButtonLEDMode(int row, int col, LEDMode mode, float rate_hz, float phase, LEDModeSync sync) {
+    if (!isValidMatrixPosition(row, col)) {
+        std::cerr << "Error: Invalid matrix position in setMatrixButtonLEDMode()" << std::endl;
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(led_buffer_mutex);
+    if (!storeLEDMode(matrix_modes[row][col], {mode, rate_hz, phase, sync})) {
+        return false;
+    }
+    if (mode == LEDMode::STEADY) {
+        writeMatrixModeBytes(row, col, 1.0f);
+        markLEDBufferDirty();
+    }
+    return true;
+}
+
+bool setButtonLEDMode(LEDButton button, LEDMode mode, float rate_hz, float phase, LEDModeSync sync) {
+    int index = (int)button;
+    if (index < 0 || index >= LED_BUTTON_COUNT) {
+        std::cerr << "Error: Invalid button in setButtonLEDMode()" << std::endl;
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(led_buffer_mutex);
+    if (!storeLEDMode(button_modes[index], {mode, rate_hz, phase, sync})) {
+        return false;
+    }
+    if (mode == LEDMode::STEADY) {
+        writeButtonModeByte(index, 1.0f);
+        markLEDBufferDirty();
+    }
+    return true;
+}
+
+bool setStopButtonLEDMode(int index, LEDMode mode, float rate_hz, float phase, LEDModeSync sync) {
+    if (index < 0 || index >= LED_STOP_COUNT) {
+        std::cerr << "Error: Invalid stop button in setStopButtonLEDMode()" << std::endl;
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(led_buffer_mutex);
+    if (!storeLEDMode(stop_modes[index], {mode, rate_hz, phase, sync})) {
+        return false;
+    }
+    if (mode == LEDMode::STEADY) {
+        writeStopModeBytes(index, 1.0f);
+        markLEDBufferDirty();
+    }
+    return true;
+}
+
+LEDModeState getMatrixButtonLEDMode(int row, int col) {
+    if (!isValidMatrixPosition(row, col)) {
+        return {LEDMode::STEADY, 0.0f, 0.0f};
+    }
+    std::lock_guard<std::mutex> lock(led_buffer_mutex);
+    return matrix_modes[row][col];
+}
+
+LEDModeState getButtonLEDMode(LEDButton button) {
+    int index = (int)button;
+    if (index < 0 || index >= LED_BUTTON_COUNT) {
+        return {LEDMode::STEADY, 0.0f, 0.0f};
+    }
+    std::lock_guard<std::mutex> lock(led_buffer_mutex);
+    return button_modes[index];
+}
+
+LEDModeState getStopButtonLEDMode(int index) {
+    if (index < 0 || index >= LED_STOP_COUNT) {
+        return {LEDMode::STEADY, 0.0f, 0.0f};
+    }
+    std::lock_guard<std::mutex> lock(led_buffer_mutex);
+    return stop_modes[index];
+}
+
+/*
+* Checks if any LED blinks or pulses
+* Lets the animation tick skip idle ticks without taking a lock.
+*/
+bool hasActiveLEDModes() {
+    return active_mode_count > 0;
+}
+
+/*
+* Paints all blinking and pulsing LEDs for a point in time
+* Called once per animation tick inside its frame, so all of them change
+* together in one report. Only the buffer is written, the tick flushes.
+*
+* @param time_ms: Current time in milliseconds (steady clock)
+* @return: Number of LEDs that were painted
+*/
+int updateLEDModes(uint64_t time_ms) {
+    // Step 1: Nothing blinks, nothing to do
+    if (active_mode_count == 0) {
+        return 0;
+    }
+
+    // Step 2: Read the beat position once, before the LED buffer lock
+    double beats = -1.0;
+    LEDBeatClock* clock = beat_clock.load();
+    if (clock != nullptr && !clock->getBeatPosition((int64_t)time_ms * 1000000, beats)) {
+        beats = -1.0;
+    }
+
+    // Step 3: Repaint every non-steady LED from its stored state
+    std::lock_guard<std::mutex> lock(led_buffer_mutex);
+    int painted = 0;
+    for (int row = 0; row < MATRIX_ROWS; row++) {
+        for (int col = 0; col < MATRIX_COLS; col++) {
+            if (matrix_modes[row][col].mode != LEDMode::STEADY) {
+                writeMatrixModeBytes(row, col, getLEDModeFactor(matrix_modes[row][col], time_ms, beats));
+                painted++;
+            }
+        }
+    }
+    for (int i = 0; i < LED_BUTTON_COUNT; i++) {
+        if (button_modes[i].mode != LEDMode::STEADY) {
+            writeButtonModeByte(i, getLEDModeFactor(button_modes[i], time_ms, beats));
+            painted++;
+        }
+    }
+    for (int i = 0; i < LED_STOP_COUNT; i++) {
+        if (stop_modes[i].mode != LEDMode::STEADY) {
+            writeStopModeBytes(i, getLEDModeFactor(stop_modes[i], time_ms, beats));
+            painted++;
+        }
+    }
+
+    // Step 4: One dirty mark for the whole tick
+    if (painted > 0) {
+        markLEDBufferDirty();
+    }
+    return painted;
+}
+
+/*
+* Attaches the clock that drives BEAT modes
+* Stop the animation tick (or detach) before the clock is destroyed.
+*
+* @param clock: Beat clock, e.g. a MIDI clock follower, or nullptr to detach
+*/
+void setLEDBeatClock(LEDBeatClock* clock) {
+    beat_clock = clock;
 }
 
 // =============================================================================
@@ -138,18 +695,96 @@ LEDState getButtonState(LEDButton button) {
 // =============================================================================
 
 /*
-* Gets a color in BRG format with specified brightness
-* All 18 colors are defined here with their RGB values, then converted to BRG
+* All 18 colors with their 8-bit values in BRG order (hardware order)
+* Indexed by LEDColor
+*/
+static constexpr BRGColor LED_COLOR_VALUES[LED_COLOR_COUNT] = {{0,0,0},{0, 255, 0},{45, 255, 97},{0, 255, 148},{0, 255, 213},{0, 255, 255},{0, 144, 255},{0, 0, 255},{165, 0, 255},{255, 0, 255},{255, 0, 206},{255, 0, 49},{218, 69, 49},{217, 125, 41},{255, 229, 18},{255, 255, 0},{136, 255, 0},{255, 255, 255 }};
+
+/*
+* Builds LED_SCALE_TABLE at compile time: every 8-bit value x 128 levels
+*/
+static constexpr std::array<std::array<uint8_t, LED_BRIGHTNESS_LEVELS>, 256> makeScaleTable() {
+    std::array<std::array<uint8_t, LED_BRIGHTNESS_LEVELS>, 256> table{};
+    for (int value = 0; value < 256; value++) {
+        for (int level = 0; level < LED_BRIGHTNESS_LEVELS; level++) {
+            table[value][level] = scaleTo7Bit(value, level);
+        }
+    }
+    return table;
+}
+
+/*
+* Builds LED_COLOR_TABLE at compile time: every LEDColor x 128 levels
+*/
+static constexpr std::array<std::array<BRGColor, LED_BRIGHTNESS_LEVELS>, LED_COLOR_COUNT> makeColorTable() {
+    std::array<std::array<BRGColor, LED_BRIGHTNESS_LEVELS>, LED_COLOR_COUNT> table{};
+    for (int color = 0; color < LED_COLOR_COUNT; color++) {
+        for (int level = 0; level < LED_BRIGHTNESS_LEVELS; level++) {
+            table[color][level] = {scaleTo7Bit(LED_COLOR_VALUES[color].blue, level),
+                                   scaleTo7Bit(LED_COLOR_VALUES[color].red, level),
+                                   scaleTo7Bit(LED_COLOR_VALUES[color].green, level)};
+        }
+    }
+    return table;
+}
+
+constexpr std::array<std::array<uint8_t, LED_BRIGHTNESS_LEVELS>, 256> LED_SCALE_TABLE = makeScaleTable();
+constexpr std::array<std::array<BRGColor, LED_BRIGHTNESS_LEVELS>, LED_COLOR_COUNT> LED_COLOR_TABLE = makeColorTable();
+
+/*
+* Gets a color in BRG format at full brightness (8-bit values)
 * 
 * @param color: The color to get (using LEDColor enum)
-* @param brightness: Brightness level (0.0 = off, 1.0 = full brightness)
-* @return: BRGColor structure with blue, red, green values (7-bit each)
+* @return: BRGColor structure with blue, red, green values (8-bit each)
 */
+BRGColor getColor(LEDColor color) {
+    return LED_COLOR_VALUES[(int)color];
+}
 
-BRGColor colors[18] = {{0,0,0},{0, 255, 0},{45, 255, 97},{0, 255, 148},{0, 255, 213},{0, 255, 255},{0, 144, 255},{0, 0, 255},{165, 0, 255},{255, 0, 255},{255, 0, 206},{255, 0, 49},{218, 69, 49},{217, 125, 41},{255, 229, 18},{255, 255, 0},{136, 255, 0},{255, 255, 255 }};
+/*
+* Finds the LEDColor closest to a BRG color, for the state storage
+* The color is scaled to full brightness first, brightness is stored apart.
+*
+* @param color: 8-bit BRG color
+* @return: Closest LEDColor, black only for (0,0,0)
+*/
+LEDColor getNearestColor(BRGColor color) {
+    // Step 1: Scale the brightest channel to 255
+    int peak = std::max(color.blue, std::max(color.red, color.green));
+    if (peak == 0) {
+        return LEDColor::black;
+    }
+    int blue = color.blue * 255 / peak;
+    int red = color.red * 255 / peak;
+    int green = color.green * 255 / peak;
 
-BRGColor getColor(LEDColor color) {
-    return colors[(int)color];
+    // Step 2: Smallest squared distance, black is never the answer here
+    int nearest = 1;
+    int nearest_distance = -1;
+    for (int i = 1; i < LED_COLOR_COUNT; i++) {
+        int db = blue - LED_COLOR_VALUES[i].blue;
+        int dr = red - LED_COLOR_VALUES[i].red;
+        int dg = green - LED_COLOR_VALUES[i].green;
+        int distance = db * db + dr * dr + dg * dg;
+        if (nearest_distance < 0 || distance < nearest_distance) {
+            nearest = i;
+            nearest_distance = distance;
+        }
+    }
+    return (LEDColor)nearest;
+}
+
+/*
+* Converts a float brightness to a 7-bit brightness level
+* This is the only float operation left on the LED path, done once per call
+* 
+* @param brightness: Brightness (0.0 = off, 1.0 = full brightness)
+* @return: Brightness level (0-127), clamped
+*/
+uint8_t brightnessToLevel(float brightness) {
+    if (!(brightness > 0.0f)) return 0;       // Also catches NaN
+    if (brightness >= 1.0f) return 127;
+    return (uint8_t)(brightness * 127.0f + 0.5f);
 }
 
 // =============================================================================
@@ -158,7 +793,7 @@ BRGColor getColor(LEDColor color) {
 
 /*
 * Initializes the LED controller system:
-* 1. Stores the device for automatic sending
+* 1. Stores the device for automatic sending, replacing a previous one
 * 2. Initializes the LED buffer to default values (sets all LEDs to clear)
 * 3. Initializes the state storage arrays to default values
 *
@@ -173,13 +808,25 @@ bool initializeLEDController(hid_device* device) {
     }
     
     // Step 2: Store device for automatic sending
-    current_device = device;
-    
-    // Step 3: Initialize LED buffer to all zeros (all LEDs off)
-    memset(led_buffer, 0, LED_REPORT_SIZE);
+    led_output.device = device;
+    {
+        std::lock_guard<std::mutex> lock(led_output_mutex);
+        led_output.last_sent_valid = false;    // New device, its LED state is unknown
+    }
     
-    // Step 4: Set the report ID (first byte must be 0x80)
-    led_buffer[0] = LED_REPORT_ID;
+    // Step 3: Initialize back and front buffer to all zeros (all LEDs off)
+    {
+        std::lock_guard<std::mutex> lock(led_buffer_mutex);
+        memset(led_output.back, 0, LED_REPORT_SIZE);
+        memset(led_output.front, 0, LED_REPORT_SIZE);
+        memset(led_output.fine_back, 0, sizeof(led_output.fine_back));
+        memset(led_output.fine_front, 0, sizeof(led_output.fine_front));
+
+        // Step 4: Set the report ID (first byte must be 0x80)
+        led_output.back[0] = LED_REPORT_ID;
+        led_output.front[0] = LED_REPORT_ID;
+        snapshotLEDLayers(led_output.front_layers);
+    }
 
     // Step 5: Initialize state storage arrays to default values
     // SPECIAL BUTTONS: Initialize special button states to off (color irrelevant for special buttons)
@@ -195,14 +842,18 @@ bool initializeLEDController(hid_device* device) {
         stop_states[i] = {0.0f};
     }
     // MATRIX:Initialize matrix states to black/off
-    for (int row = 1; row <= 4; row++) {
-        for (int col = 1; col <= 4; col++) {
+    for (int row = 0; row < MATRIX_ROWS; row++) {
+        for (int col = 0; col < MATRIX_COLS; col++) {
             matrix_states[row][col] = {LEDColor::black, 0.0f};
         }
     }
+    // MODES: All LEDs steady
+    resetLEDModes();
 
     // Step 6: Send initial empty report to turn off all LEDs
     bool success = sendLEDReport(device);
+    led_output.back_dirty = false;
+    led_output.front_dirty = !success;
     
     if (success) {
         std::cout << "  - LED controller initialized successfully - all LEDs off, state storage ready" << std::endl;
@@ -213,6 +864,43 @@ bool initializeLEDController(hid_device* device) {
     return success;
 }
 
+/*
+* Copies the back buffer and the layers to the front if they have uncommitted
+* changes. Caller must hold led_buffer_mutex, so the copy is atomic for
+* everyone else.
+*/
+static void commitBackBuffer() {
+    if (!led_output.back_dirty) {
+        return;
+    }
+    memcpy(led_output.front, led_output.back, LED_REPORT_SIZE);
+    memcpy(led_output.fine_front, led_output.fine_back, sizeof(led_output.fine_back));
+    snapshotLEDLayers(led_output.front_layers);
+    led_output.back_dirty = false;
+    led_output.front_dirty = true;
+}
+
+/*
+* Turns the front buffer into the report that is sent
+* The layers committed with it are composited over it first, then the brightness curves
+* are applied. Dithered groups are encoded from the fine levels, so float
+* brightness keeps its precision. Requires led_buffer_mutex to be held.
+*
+* @param frame: Output 81-byte report
+* @param fractions: Optional output for dithered groups, see encodeLEDFrame()
+* @return: true if fractions were written and at least one is not zero
+*/
+static bool encodeFrontBuffer(unsigned char* frame, unsigned char* fractions = nullptr) {
+    unsigned char composited[LED_REPORT_SIZE];
+    if (fractions == nullptr) {
+        compositeLEDLayers(led_output.front_layers, led_output.front, composited);
+        return encodeLEDFrame(composited, frame);
+    }
+    uint16_t fine[LED_REPORT_SIZE];
+    compositeLEDLayers(led_output.front_layers, led_output.front, composited, led_output.fine_front, fine);
+    return encodeLEDFrame(composited, frame, fractions, fine);
+}
+
 /*
 * Sends the current LED buffer to the F1 device
 * This function actually communicates with the hardware
@@ -221,31 +909,337 @@ bool initializeLEDController(hid_device* device) {
 * @return: true if send successful, false if error
 */
 bool sendLEDReport(hid_device* device) {
+    // Step 1: Commit and encode the front buffer, so setters are not blocked
+    // during the write
+    unsigned char frame[LED_REPORT_SIZE];
+    {
+        std::lock_guard<std::mutex> lock(led_buffer_mutex);
+        commitBackBuffer();
+        encodeFrontBuffer(frame);
+    }
+
+    // Step 2: Send the encoded copy
+    return sendLEDFrame(device, frame) != LEDSendResult::FAILED;
+}
+
+/*
+* Sends a complete LED frame to the F1 device
+* Used by sendLEDReport() and by the LED writer thread. Safe to call from
+* several threads, their writes are serialized.
+* 
+* @param device: Pointer to the opened HID device
+* @param frame: Complete 81-byte LED report
+* @return: SENT, SUPPRESSED if the device already shows the frame, FAILED if error
+*/
+LEDSendResult sendLEDFrame(hid_device* device, const unsigned char* frame) {
     // Step 1: Check if device is valid
     if (device == nullptr) {
-        std::cerr << "Error: Device is null in sendLEDReport()" << std::endl;
-        return false;
+        std::cerr << "Error: Device is null in sendLEDFrame()" << std::endl;
+        return LEDSendResult::FAILED;
+    }
+
+    // Step 2: Skip the write if the device already shows this exact frame
+    std::lock_guard<std::mutex> lock(led_output_mutex);
+    auto now = std::chrono::steady_clock::now();
+    if (led_output.last_sent_valid && memcmp(frame, led_output.last_sent_frame, LED_REPORT_SIZE) == 0) {
+        auto refresh = std::chrono::steady_clock::duration(refresh_interval.load());
+        if (refresh.count() == 0 || now - led_output.last_sent_time < refresh) {
+            stat_reports_suppressed++;
+            return LEDSendResult::SUPPRESSED;
+        }
     }
     
-    // Step 2: Send the 81-byte LED report to the F1
-    int bytes_sent = hid_write(device, led_buffer, LED_REPORT_SIZE);
+    // Step 3: Send the 81-byte LED report to the F1
+    int bytes_sent = hid_write(device, frame, LED_REPORT_SIZE);
     
-    // Step 3: Check if the send operation was successful
+    // Step 4: Check if the send operation was successful
     if (bytes_sent < 0) {
-        return false;
+        stat_reports_failed++;
+        led_output.last_sent_valid = false;    // Device state unknown, resend next time
+        return LEDSendResult::FAILED;
     }
     
-    // Step 4: Verify correct number of bytes were sent
+    // Step 5: Verify correct number of bytes were sent
     if (bytes_sent != LED_REPORT_SIZE) {
         std::cerr << "Warning: Partial LED report sent. Expected " 
                   << LED_REPORT_SIZE << " bytes, sent " << bytes_sent << " bytes" << std::endl;
-        return false;
+        stat_reports_failed++;
+        led_output.last_sent_valid = false;
+        return LEDSendResult::FAILED;
     }
     
-    // Step 5: Success!
+    // Step 6: Success! Remember what the device shows now
+    memcpy(led_output.last_sent_frame, frame, LED_REPORT_SIZE);
+    led_output.last_sent_valid = true;
+    led_output.last_sent_time = now;
+    stat_reports_sent++;
+    return LEDSendResult::SENT;
+}
+
+/*
+* Sets how often an unchanged frame is sent anyway
+* Identical frames are normally suppressed. With an interval > 0, a flush
+* resends the current frame once the last write is older than the interval.
+*
+* @param refresh_ms: Forced refresh interval in milliseconds (0 = never)
+*/
+void setLEDRefreshInterval(int refresh_ms) {
+    if (refresh_ms < 0) refresh_ms = 0;
+    refresh_interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::milliseconds(refresh_ms)).count();
+}
+
+/*
+* Writes raw bytes into the LED buffer and marks it dirty
+* For modules that fill whole byte ranges, like the 7-segment displays
+* Levels above 127 are stored as 127.
+*
+* @param start_byte: First byte position in the LED report (1-80)
+* @param bytes: 7-bit levels to copy
+* @param count: Number of bytes to copy
+* @return: true if the buffer was updated, false if the range is invalid
+*/
+bool writeLEDBytes(int start_byte, const uint8_t* bytes, int count) {
+    // Step 1: Never overwrite the report ID or run past the report
+    if (start_byte < 1 || count < 0 || start_byte + count > LED_REPORT_SIZE) {
+        std::cerr << "Error: Invalid byte range in writeLEDBytes()" << std::endl;
+        return false;
+    }
+
+    // Step 2: Copy the bytes and mark the buffer dirty
+    std::lock_guard<std::mutex> lock(led_buffer_mutex);
+    for (int i = 0; i < count; i++) {
+        uint8_t level = bytes[i] > 127 ? 127 : bytes[i];
+        paintLEDByte(start_byte + i, level, (uint16_t)(level << LED_DITHER_BITS));
+    }
+    markLEDBufferDirty();
+    return true;
+}
+
+/*
+* Reads levels back from the LED buffer
+* Returns what the calling thread painted: bytes it changed in its open
+* frame are read from there, all others from the back buffer.
+*
+* @param start_byte: First byte position in the LED report (1-80)
+* @param bytes: Receives the 7-bit levels
+* @param count: Number of bytes to read
+* @return: true if the bytes were read, false if the range is invalid
+*/
+bool readLEDBytes(int start_byte, uint8_t* bytes, int count) {
+    if (start_byte < 1 || count < 0 || start_byte + count > LED_REPORT_SIZE) {
+        std::cerr << "Error: Invalid byte range in readLEDBytes()" << std::endl;
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(led_buffer_mutex);
+    for (int i = 0; i < count; i++) {
+        int byte_position = start_byte + i;
+        bool in_frame = thread_frame.depth > 0 && thread_frame.touched[byte_position];
+        bytes[i] = in_frame ? thread_frame.levels[byte_position] : led_output.back[byte_position];
+    }
+    return true;
+}
+
+/*
+* Attaches the writer thread that owns the device's write side
+* While it runs, flushes hand frames to the thread instead of calling hid_write()
+*
+* @param writer: Started LEDOutputWriter, or nullptr to send synchronously again
+*/
+void setLEDOutputWriter(LEDOutputWriter* writer) {
+    std::lock_guard<std::mutex> lock(led_buffer_mutex);
+    current_writer = writer;
+}
+
+// =============================================================================
+// FRAME FLUSH FUNCTIONS - Send one report per frame instead of per setter
+// =============================================================================
+
+/*
+* Marks the LED buffer as changed since the last flush
+* Called by every LED setter instead of sending the report directly
+*/
+void markLEDBufferDirty() {
+    led_output.back_dirty = true;
+    stat_led_changes++;
+}
+
+/*
+* Checks if the LED buffer has changes that were not sent yet
+*
+* @return: true if there are uncommitted or unsent changes
+*/
+bool isLEDBufferDirty() {
+    return led_output.back_dirty || led_output.front_dirty;
+}
+
+/*
+* Starts painting a frame on the calling thread
+* Until the matching commitLEDFrame(), this thread's setters (and layer
+* painting) go into a frame of its own, flushes keep sending the last
+* committed frame. Other threads paint and commit independently. Calls may
+* be nested.
+*/
+void beginLEDFrame() {
+    thread_frame.depth++;
+}
+
+/*
+* Finishes painting a frame and publishes it
+* When the calling thread's outermost frame is committed, the bytes it
+* painted are merged into the back buffer, which is then copied to the front
+* buffer in one step. The next flush sends it.
+*
+* @return: true if the frame was published, false if frames are still open
+*/
+bool commitLEDFrame() {
+    // Step 1: Close one paint level, ignore unbalanced commits
+    if (thread_frame.depth == 0) {
+        return true;
+    }
+    if (--thread_frame.depth > 0) {
+        return false;   // An outer frame is still being painted
+    }
+
+    // Step 2: Merge what this frame painted, its dirty marks may already have
+    // been consumed by another thread's commit
+    std::lock_guard<std::mutex> lock(led_buffer_mutex);
+    bool merged = false;
+    for (int i = 1; i < LED_REPORT_SIZE; i++) {
+        if (thread_frame.touched[i]) {
+            led_output.back[i] = thread_frame.levels[i];
+            led_output.fine_back[i] = thread_frame.fine[i];
+            thread_frame.touched[i] = false;
+            merged = true;
+        }
+    }
+    if (mergeLEDLayerFrame() || merged) {
+        led_output.back_dirty = true;
+    }
+
+    // Step 3: Publish the back buffer
+    commitBackBuffer();
+    return true;
+}
+
+/*
+* Checks if the calling thread is painting a frame
+*/
+bool isLEDFrameOpen() {
+    return thread_frame.depth > 0;
+}
+
+/*
+* Sends the LED buffer to the F1 if it has changed since the last flush
+* Ignores the flush policy, use this to force a frame out now
+* Commits the back buffer first, frames that are still open stay out of it
+* With a writer thread attached this never blocks on USB
+*
+* @return: true if the device is up to date, false if the send failed
+*/
+bool flushLEDReport() {
+    // Step 1: Nothing changed, the device is already up to date
+    if (!led_output.back_dirty && !led_output.front_dirty) {
+        pending_origin_ns = 0;      // The marked change did not change the frame
+        return true;
+    }
+
+    // Step 2: Encode the front buffer (brightness curves)
+    unsigned char frame[LED_REPORT_SIZE];
+    int64_t origin_ns = 0;
+    {
+        std::lock_guard<std::mutex> lock(led_buffer_mutex);
+
+        // Keep the buffer dirty until a device can receive it
+        bool has_writer = current_writer != nullptr && current_writer->isRunning();
+        if (!has_writer && led_output.device == nullptr) {
+            return false;
+        }
+
+        // The back buffer only holds committed frames, publish it first
+        commitBackBuffer();
+        if (!led_output.front_dirty) {
+            return true;    // Only uncommitted changes, nothing to send yet
+        }
+        last_flush_time = std::chrono::steady_clock::now().time_since_epoch().count();
+        led_output.front_dirty = false;
+        origin_ns = pending_origin_ns.exchange(0);
+        // Writer thread attached - hand over the frame and return at once
+        // Only the writer can dither, it keeps sending frames on its own
+        if (has_writer) {
+            unsigned char fractions[LED_REPORT_SIZE];
+            bool dithered = encodeFrontBuffer(frame, fractions);
+            current_writer->submit(frame, dithered ? fractions : nullptr, origin_ns);
+            return true;
+        }
+        encodeFrontBuffer(frame);
+    }
+
+    // Step 3: No writer thread - send one report for all changes synchronously
+    LEDSendResult result = sendLEDFrame(led_output.device, frame);
+    if (result == LEDSendResult::FAILED) {
+        led_output.front_dirty = true;  // Stay dirty so the next flush retries
+        return false;
+    }
+    if (result == LEDSendResult::SENT && origin_ns != 0) {
+        recordLEDLatency(origin_ns);
+    }
+    return true;
+}
+
+/*
+* Flushes the LED buffer if the flush policy allows it right now
+* ControllerHandler::run() calls this once per iteration
+*
+* @return: true if nothing failed, false if a due send failed
+*/
+bool flushLEDReportIfDue() {
+    // Forced refresh: resend the unchanged frame once the interval has elapsed
+    std::chrono::steady_clock::rep refresh = refresh_interval;
+    if (refresh != 0 && !led_output.front_dirty &&
+        std::chrono::steady_clock::now().time_since_epoch().count() - last_flush_time >= refresh) {
+        led_output.front_dirty = true;
+    }
+
+    switch (flush_policy) {
+        case LEDFlushPolicy::EXPLICIT:
+            return true;    // Caller flushes manually
+        case LEDFlushPolicy::END_OF_RUN:
+            return flushLEDReport();
+        case LEDFlushPolicy::MAX_FRAME_RATE:
+            // Changes stay pending until the frame interval has elapsed
+            if (std::chrono::steady_clock::now().time_since_epoch().count() - last_flush_time < min_frame_interval.count()) {
+                return true;
+            }
+            return flushLEDReport();
+    }
     return true;
 }
 
+/*
+* Selects when dirty LED buffers are sent
+*
+* @param policy: EXPLICIT, END_OF_RUN or MAX_FRAME_RATE
+* @param max_frame_rate: Reports per second for MAX_FRAME_RATE (ignored otherwise)
+*/
+void setLEDFlushPolicy(LEDFlushPolicy policy, int max_frame_rate) {
+    if (policy == LEDFlushPolicy::MAX_FRAME_RATE && max_frame_rate <= 0) {
+        std::cerr << "Error: Invalid frame rate in setLEDFlushPolicy(), using END_OF_RUN" << std::endl;
+        policy = LEDFlushPolicy::END_OF_RUN;
+    }
+
+    flush_policy = policy;
+    min_frame_interval = std::chrono::steady_clock::duration{0};
+    if (policy == LEDFlushPolicy::MAX_FRAME_RATE) {
+        min_frame_interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::seconds(1)) / max_frame_rate;
+    }
+}
+
+LEDFlushPolicy getLEDFlushPolicy() {
+    return flush_policy;
+}
+
 /*
 * Clears all LEDs (turns them off) and sends the update to the F1
 * Also clears the state storage for all LEDs
@@ -253,7 +1247,10 @@ bool sendLEDReport(hid_device* device) {
 */
 void clearAllLEDs() {
     // Step 1: Clear the entire buffer except the report ID
-    memset(led_buffer + 1, 0, LED_REPORT_SIZE - 1);  // Skip first byte (report ID)
+    std::unique_lock<std::mutex> lock(led_buffer_mutex);
+    for (int i = 1; i < LED_REPORT_SIZE; i++) {     // Skip first byte (report ID)
+        paintLEDByte(i, 0, 0);
+    }
     
     // Step 2: Clear state storage arrays to match
     // SPECIAL BUTTONS: Clear special button states to off (color irrelevant for special buttons)
@@ -269,15 +1266,19 @@ void clearAllLEDs() {
         stop_states[i] = {0.0f};
     }
     // MATRIX: Clear matrix states to black/off
-    for (int row = 1; row <= 4; row++) {
-        for (int col = 1; col <= 4; col++) {
+    for (int row = 0; row < MATRIX_ROWS; row++) {
+        for (int col = 0; col < MATRIX_COLS; col++) {
             matrix_states[row][col] = {LEDColor::black, 0.0f};
         }
     }
+    // MODES: Stop blinking and pulsing
+    resetLEDModes();
+    lock.unlock();
 
     // Step 3: Send the cleared buffer to the F1
-    if (current_device != nullptr) {
-        sendLEDReport(current_device);
+    markLEDBufferDirty();
+    if (led_output.device != nullptr) {
+        flushLEDReport();
         std::cout << "All LEDs cleared" << std::endl;
     } else {
         std::cerr << "Warning: No device connected, LEDs cleared in buffer only" << std::endl;
@@ -288,37 +1289,94 @@ void clearAllLEDs() {
 * Sets a matrix button LED to a specific color and brightness
 * Saves the original color and brightness in the state storage
 * Matrix buttons are arranged in a 4x4 grid with RGB LEDs (BRG format)
+* The float brightness is converted to a level once, colors come from LED_COLOR_TABLE
 * 
-* @param row: Matrix row (1-4)
-* @param col: Matrix column (1-4)
+* @param row: Matrix row (0-3)
+* @param col: Matrix column (0-3)
 * @param color: Color to set (using LEDColor enum)
 * @param brightness: Brightness level (0.0 = off, 1.0 = full brightness)
 * @param store_led_state: Whether to store the LED state (original color/brightness)
-* @return: true if successful, false if error
+* @return: true if the buffer was updated, false if error
 */
 bool setMatrixButtonLED(int row, int col, LEDColor color, float brightness, bool store_led_state) {
-    return setMatrixButtonLED(row, col, getColor(color), brightness, store_led_state);
+    // Step 1: Clamp brightness to valid range
+    if (brightness < 0.0f) brightness = 0.0f;
+    if (brightness > 1.0f) brightness = 1.0f;
+
+    // Step 2: Save the original color and brightness if requested
+    int color_index = (int)color;
+    if (color_index < 0 || color_index >= LED_COLOR_COUNT) {
+        std::cerr << "Error: Invalid color in setMatrixButtonLED()" << std::endl;
+        return false;
+    }
+    if (store_led_state && isValidMatrixPosition(row, col)) {
+        std::lock_guard<std::mutex> lock(led_buffer_mutex);
+        matrix_states[row][col] = {color, brightness};
+    }
+
+    // Step 3: Convert brightness to a level and write the table entry,
+    // keeping the unrounded brightness for dithering
+    BRGColor value = LED_COLOR_VALUES[color_index];
+    const uint16_t fine[MATRIX_LEDS_PER_BUTTON] = {brightnessToFineLevel(value.blue, brightness),
+                                                   brightnessToFineLevel(value.red, brightness),
+                                                   brightnessToFineLevel(value.green, brightness)};
+    return writeMatrixButtonBytes(row, col, LED_COLOR_TABLE[color_index][brightnessToLevel(brightness)], fine);
 }
 
+/*
+* Sets a matrix button LED to any 8-bit BRG color
+* The state storage only holds LEDColors, it keeps the closest one.
+*/
 bool setMatrixButtonLED(int row, int col, BRGColor color, float brightness, bool store_led_state) {
-    // Step 4: Calculate the byte position for this matrix button
-    // Matrix mapping: (row-1) * 4 + (col-1) gives button index (0-15)
-    // Each button has 3 bytes (BRG), so multiply by 3
-    int button_index = (row) * MATRIX_COLS + (col);
-    int base_byte = LED_BYTE_MATRIX_START + (button_index * MATRIX_LEDS_PER_BUTTON);
+    // Step 1: Save the closest LEDColor and the brightness if requested
+    if (brightness < 0.0f) brightness = 0.0f;
+    if (brightness > 1.0f) brightness = 1.0f;
+    if (store_led_state && isValidMatrixPosition(row, col)) {
+        LEDColor nearest = getNearestColor(color);
+        std::lock_guard<std::mutex> lock(led_buffer_mutex);
+        matrix_states[row][col] = {nearest, brightness};
+    }
 
-    // Step 6: Set the three LED bytes for this button (Blue, Red, Green order)
-    led_buffer[base_byte]     = convertTo7Bit(color.blue, brightness);   // Blue LED
-    led_buffer[base_byte + 1] = convertTo7Bit(color.red, brightness);    // Red LED
-    led_buffer[base_byte + 2] = convertTo7Bit(color.green, brightness);  // Green LED
-    
-    // Step 7: Send the updated buffer to the F1
-    if (current_device != nullptr) {
-        return sendLEDReport(current_device);
-    } else {
-        std::cerr << "Warning: No device connected, LED set in buffer only" << std::endl;
+    // Step 2: Convert brightness to a level once, then look up all three channels
+    uint8_t level = brightnessToLevel(brightness);
+    BRGColor scaled = {LED_SCALE_TABLE[color.blue][level],
+                       LED_SCALE_TABLE[color.red][level],
+                       LED_SCALE_TABLE[color.green][level]};
+    const uint16_t fine[MATRIX_LEDS_PER_BUTTON] = {brightnessToFineLevel(color.blue, brightness),
+                                                   brightnessToFineLevel(color.red, brightness),
+                                                   brightnessToFineLevel(color.green, brightness)};
+
+    return writeMatrixButtonBytes(row, col, scaled, fine);
+}
+
+/*
+* Sets a matrix button LED to a color at an integer brightness level
+* Integer fast path: one table lookup, no float math
+* 
+* @param row: Matrix row (0-3)
+* @param col: Matrix column (0-3)
+* @param color: Color to set (using LEDColor enum)
+* @param level: Brightness level (0 = off, 127 = full brightness)
+* @param store_led_state: Whether to store the LED state (original color/brightness)
+* @return: true if the buffer was updated, false if error
+*/
+bool setMatrixButtonLEDLevel(int row, int col, LEDColor color, uint8_t level, bool store_led_state) {
+    // Step 1: Validate color and clamp level
+    int color_index = (int)color;
+    if (color_index < 0 || color_index >= LED_COLOR_COUNT) {
+        std::cerr << "Error: Invalid color in setMatrixButtonLEDLevel()" << std::endl;
         return false;
     }
+    if (level > 127) level = 127;
+
+    // Step 2: Save the color and brightness in state storage if requested
+    if (store_led_state && isValidMatrixPosition(row, col)) {
+        std::lock_guard<std::mutex> lock(led_buffer_mutex);
+        matrix_states[row][col] = {color, level / 127.0f};
+    }
+
+    // Step 3: Look up the 7-bit BRG triple
+    return writeMatrixButtonBytes(row, col, LED_COLOR_TABLE[color_index][level]);
 }
 
 // =============================================================================
@@ -336,24 +1394,49 @@ bool setMatrixButtonLED(int row, int col, BRGColor color, float brightness, bool
 * @return: true if successful, false if error
 */
 bool setButtonLED(LEDButton button, float brightness, bool store_led_state) {
-    // Step 1: Get array index for this button
-    int index = (int)button;
-
-    // Step 2: Clamp brightness to valid range
+    // Step 1: Clamp brightness to valid range
     if (brightness < 0.0f) brightness = 0.0f;
     if (brightness > 1.0f) brightness = 1.0f;
 
-    // Step 3: Save the original brightness in state storage
+    // Step 2: Save the original brightness in state storage
     // This happens BEFORE any conversion, preserving exact original value
     // Save only if requested
+    int index = (int)button;
+    if (index < 0 || index >= LED_BUTTON_COUNT) {
+        std::cerr << "Error: Invalid button in setButtonLED()" << std::endl;
+        return false;
+    }
+    // Step 3: Convert brightness to a 7-bit level (F1 hardware requirement),
+    // keeping the unrounded brightness for dithering
+    int byte_position = getButtonByte(button);
+    std::lock_guard<std::mutex> lock(led_buffer_mutex);
     if (store_led_state) {
-        special_states[index] = {brightness};
+        buttonState(index) = {brightness};
     }
+    paintLEDByte(byte_position, brightnessToLevel(brightness), brightnessToFineLevel(255, brightness));
+    markLEDBufferDirty();
+    return true;
+}
 
-    // Step 4: Convert brightness to 7-bit value (F1 hardware requirement)
-    unsigned char led_value = convertTo7Bit(255, brightness);  // Use max 7-bit value with brightness
-    
-    // Step 5: Determine which byte to set based on the button
+/*
+* Sets a button LED to an integer brightness level
+* For single-color LEDs the 7-bit value is the level itself
+* 
+* @param button: Which special button to control (using enum)
+* @param level: Brightness level (0 = off, 127 = full brightness)
+* @param store_led_state: Whether to store the LED state (brightness)
+* @return: true if successful, false if error
+*/
+bool setButtonLEDLevel(LEDButton button, uint8_t level, bool store_led_state) {
+    // Step 1: Get array index for this button and clamp level
+    int index = (int)button;
+    if (index < 0 || index >= LED_BUTTON_COUNT) {
+        std::cerr << "Error: Invalid button in setButtonLEDLevel()" << std::endl;
+        return false;
+    }
+    if (level > 127) level = 127;
+
+    // Step 3: Determine which byte to set based on the button
     int byte_position;
     
     if (index < 3) {
@@ -362,16 +1445,16 @@ bool setButtonLED(LEDButton button, float brightness, bool store_led_state) {
         byte_position = LED_BYTE_SPECIAL_START + (index - 3);
     }
     
-    // Step 6: Set the LED value in the buffer
-    led_buffer[byte_position] = led_value;
-    
-    // Step 7: Send the updated buffer to the F1
-    if (current_device != nullptr) {
-        return sendLEDReport(current_device);
-    } else {
-        std::cerr << "Warning: No device connected, LED set in buffer only" << std::endl;
-        return false;
+    // Step 4: Set the LED value in the buffer, save the brightness if requested
+    std::lock_guard<std::mutex> lock(led_buffer_mutex);
+    paintLEDByte(byte_position, level, (uint16_t)(level << LED_DITHER_BITS));
+    if (store_led_state) {
+        buttonState(index) = {level / 127.0f};
     }
+    
+    // Step 5: Mark the buffer dirty, the next flush sends it to the F1
+    markLEDBufferDirty();
+    return true;
 }
 
 /*
@@ -385,37 +1468,63 @@ bool setButtonLED(LEDButton button, float brightness, bool store_led_state) {
 * @return: true if successful, false if error
 */
 bool setStopButtonLED(int index, float brightness, bool store_led_state) {    
-    // Step 1: Get array index for this button
-
-    // Step 2: Clamp brightness to valid range
+    // Step 1: Clamp brightness to valid range
     if (brightness < 0.0f) brightness = 0.0f;
     if (brightness > 1.0f) brightness = 1.0f;
 
-    // Step 3: Save original brightness
+    // Step 2: Save original brightness
     // This happens BEFORE any conversion, preserving exact original value
     // Save only if requested
+    if (index < 0 || index >= LED_STOP_COUNT) {
+        std::cerr << "Error: Invalid stop button in setStopButtonLED()" << std::endl;
+        return false;
+    }
+    // Step 3: Convert brightness to a 7-bit level, keeping the unrounded
+    // brightness for dithering
+    uint8_t level = brightnessToLevel(brightness);
+    uint16_t fine = brightnessToFineLevel(255, brightness);
+    int left_byte = getStopButtonByte(index);
+    std::lock_guard<std::mutex> lock(led_buffer_mutex);
     if (store_led_state) {
         stop_states[index] = {brightness};
     }
+    paintLEDByte(left_byte, level, fine);
+    paintLEDByte(left_byte - 1, level, fine);
+    markLEDBufferDirty();
+    return true;
+}
 
-    // Step 4: Convert brightness to 7-bit value
-    unsigned char led_value = convertTo7Bit(255, brightness);
+/*
+* Sets both LEDs of a stop button to an integer brightness level
+* 
+* @param index: Which stop button to control (0-3)
+* @param level: Brightness level (0 = off, 127 = full brightness)
+* @param store_led_state: Whether to store the LED state (brightness)
+* @return: true if successful, false if error
+*/
+bool setStopButtonLEDLevel(int index, uint8_t level, bool store_led_state) {
+    // Step 1: Validate index and clamp level
+    if (index < 0 || index >= LED_STOP_COUNT) {
+        std::cerr << "Error: Invalid stop button in setStopButtonLEDLevel()" << std::endl;
+        return false;
+    }
+    if (level > 127) level = 127;
 
-    // Step 5: Determine byte positions for both LEDs of this stop button
+    // Step 2: Determine byte positions for both LEDs of this stop button
     int left_byte = LED_BYTE_STOP_START + (7 - (index * 2));
     int right_byte = LED_BYTE_STOP_START + (7 - (index * 2)) - 1;
     
-    // Step 6: Set both LED values in the buffer
-    led_buffer[right_byte] = led_value;
-    led_buffer[left_byte] = led_value;
-    
-    // Step 7: Send the updated buffer to the F1
-    if (current_device != nullptr) {
-        return sendLEDReport(current_device);
-    } else {
-        std::cerr << "Warning: No device connected, LED set in buffer only" << std::endl;
-        return false;
+    // Step 3: Set both LED values in the buffer, save the brightness if requested
+    std::lock_guard<std::mutex> lock(led_buffer_mutex);
+    paintLEDByte(right_byte, level, (uint16_t)(level << LED_DITHER_BITS));
+    paintLEDByte(left_byte, level, (uint16_t)(level << LED_DITHER_BITS));
+    if (store_led_state) {
+        stop_states[index] = {level / 127.0f};
     }
+    
+    // Step 4: Mark the buffer dirty, the next flush sends it to the F1
+    markLEDBufferDirty();
+    return true;
 }
 
 /*
@@ -423,6 +1532,7 @@ bool setStopButtonLED(int index, float brightness, bool store_led_state) {
 * Useful for debugging toggle system and verifying state storage accuracy
 */
 void printLEDStates() {
+    std::lock_guard<std::mutex> lock(led_buffer_mutex);
     std::cout << "=== LED State Storage ===" << std::endl;
     
     // Print matrix button states
@@ -469,44 +1579,51 @@ void printLEDStates() {
 * Useful for debugging and understanding what will be sent to the F1
 */
 void printLEDReport() {
+    // Take a consistent copy, other threads may be painting
+    unsigned char buffer[LED_REPORT_SIZE];
+    {
+        std::lock_guard<std::mutex> lock(led_buffer_mutex);
+        memcpy(buffer, led_output.back, LED_REPORT_SIZE);
+    }
+
     std::cout << "Current LED Report (81 bytes):" << std::endl;
     
     // Print report ID
     std::cout << "Report ID: 0x" << std::hex << std::setfill('0') << std::setw(2) 
-              << (int)led_buffer[0] << std::endl;
+              << (int)buffer[0] << std::endl;
     
     // Print in groups for easier reading
     std::cout << "7-Seg Right (1-8):   ";
     for (int i = 1; i <= 8; i++) {
         std::cout << std::hex << std::setfill('0') << std::setw(2) 
-        << (int)led_buffer[i] << " ";
+        << (int)buffer[i] << " ";
     }
     std::cout << std::endl;
     
     std::cout << "7-Seg Left (9-16):   ";
     for (int i = 9; i <= 16; i++) {
         std::cout << std::hex << std::setfill('0') << std::setw(2) 
-        << (int)led_buffer[i] << " ";
+        << (int)buffer[i] << " ";
     }
     std::cout << std::endl;
     
     std::cout << "Special (17-21):     ";
     for (int i = 17; i <= 21; i++) {
         std::cout << std::hex << std::setfill('0') << std::setw(2) 
-        << (int)led_buffer[i] << " ";
+        << (int)buffer[i] << " ";
     }
     std::cout << std::endl;
 
     std::cout << "Control (22-24):     ";
     for (int i = 22; i <= 24; i++) {
         std::cout << std::hex << std::setfill('0') << std::setw(2) 
-        << (int)led_buffer[i] << " ";
+        << (int)buffer[i] << " ";
     }
 
     std::cout << "Matrix (25-72):      ";
     for (int i = 25; i <= 72; i++) {
         std::cout << std::hex << std::setfill('0') << std::setw(2) 
-        << (int)led_buffer[i] << " ";
+        << (int)buffer[i] << " ";
         if ((i - 24) % 12 == 0) std::cout << std::endl << "                     ";
     }
     std::cout << std::endl;
@@ -514,7 +1631,7 @@ void printLEDReport() {
     std::cout << "Stop (73-80):        ";
     for (int i = 73; i <= 80; i++) {
         std::cout << std::hex << std::setfill('0') << std::setw(2) 
-        << (int)led_buffer[i] << " ";
+        << (int)buffer[i] << " ";
     }
     std::cout << std::dec << std::endl;  // Return to decimal mode
 }
@@ -536,6 +1653,7 @@ void testAllLEDs() {
         for (int row = 0; row < 4; row++) {
             for (int col = 0; col < 4; col++) {
                 setMatrixButtonLED(row, col, test_colors[i], 0.5f, false);
+                flushLEDReport();
                 usleep(100000);  // Sleep for 100ms
             }
         }
@@ -548,6 +1666,7 @@ void testAllLEDs() {
 
     for (int i = 0; i < 9; i++) {
         setButtonLED((LEDButton)i, 0.8f, false);
+        flushLEDReport();
         usleep(100000);  // Sleep for 100ms
     }
     std::cout << "All special button LEDs turned on" << std::endl;
@@ -556,6 +1675,7 @@ void testAllLEDs() {
     std::cout << "Testing stop button LEDs..." << std::endl;
     for (int i = 1; i <= 4; i++) {
         setStopButtonLED(i, 0.8f, false);
+        flushLEDReport();
         usleep(100000);  // Sleep for 100ms
     }
     std::cout << "All stop button LEDs turned on" << std::endl;
@@ -567,3 +1687,150 @@ void testAllLEDs() {
     std::cout << "Test complete - clearing all LEDs" << std::endl;
     clearAllLEDs();
 }
+
+/*
+* Gets the LED write statistics since the last reset
+* Compare led_changes with reports_sent to see how much coalescing saves,
+* reports_suppressed counts flushes that produced an unchanged frame
+*
+* @return: LEDWriteStats with counters and elapsed time
+*/
+LEDWriteStats getLEDWriteStats() {
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - stat_start_time;
+    return {stat_led_changes, stat_reports_sent, stat_reports_suppressed, stat_reports_failed, elapsed.count()};
+}
+
+/*
+* Resets the LED write statistics and restarts the measurement window
+*/
+void resetLEDWriteStats() {
+    stat_led_changes = 0;
+    stat_reports_sent = 0;
+    stat_reports_suppressed = 0;
+    stat_reports_failed = 0;
+    stat_start_time = std::chrono::steady_clock::now();
+}
+
+/*
+* Prints LED changes and USB writes per second since the last reset
+*/
+void printLEDWriteStats() {
+    LEDWriteStats stats = getLEDWriteStats();
+    double seconds = stats.elapsed_seconds > 0.0 ? stats.elapsed_seconds : 1.0;
+
+    std::cout << "=== LED Write Statistics ===" << std::endl;
+    std::cout << "  Elapsed:        " << std::fixed << std::setprecision(2) << stats.elapsed_seconds << " s" << std::endl;
+    std::cout << "  LED changes:    " << stats.led_changes << " (" << stats.led_changes / seconds << "/s)" << std::endl;
+    std::cout << "  Reports sent:   " << stats.reports_sent << " (" << stats.reports_sent / seconds << "/s)" << std::endl;
+    std::cout << "  Suppressed:     " << stats.reports_suppressed << " (unchanged frames)" << std::endl;
+    std::cout << "  Reports failed: " << stats.reports_failed << std::endl;
+    std::cout << "============================" << std::endl;
+}
+
+/*
+* Gets the time base of the latency statistics
+*
+* @return: Steady clock time in nanoseconds
+*/
+int64_t getLEDTimeNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*
+* Marks the changes painted since the last flush with the time of the event
+* that caused them. The next flush carries the time to the output, which
+* records the latency once the report is written. The oldest mark wins.
+*
+* @param origin_ns: Arrival time of the event, from getLEDTimeNs()
+*/
+void markLEDFrameOrigin(int64_t origin_ns) {
+    int64_t expected = 0;
+    pending_origin_ns.compare_exchange_strong(expected, origin_ns);
+}
+
+/*
+* Records one latency sample, called right after the report was written
+*
+* @param origin_ns: Arrival time of the event the report shows
+*/
+void recordLEDLatency(int64_t origin_ns) {
+    int64_t latency = getLEDTimeNs() - origin_ns;
+    stat_latency_samples++;
+    stat_latency_total_ns += latency;
+    stat_latency_last_ns = latency;
+    int64_t previous = stat_latency_max_ns.load();
+    while (latency > previous && !stat_latency_max_ns.compare_exchange_weak(previous, latency)) {
+    }
+}
+
+/*
+* Gets the event-to-report latency since the last reset
+*/
+LEDLatencyStats getLEDLatencyStats() {
+    uint64_t samples = stat_latency_samples;
+    double average = samples > 0 ? stat_latency_total_ns / 1000.0 / samples : 0.0;
+    return {samples, average, stat_latency_max_ns / 1000.0, stat_latency_last_ns / 1000.0};
+}
+
+void resetLEDLatencyStats() {
+    stat_latency_samples = 0;
+    stat_latency_total_ns = 0;
+    stat_latency_max_ns = 0;
+    stat_latency_last_ns = 0;
+}
+
+// =============================================================================
+// BENCHMARKS - Compare conversion paths
+// =============================================================================
+
+/*
+* Measures the cost of a full matrix repaint (16 buttons x 3 channels)
+* Compares the old float conversion with the integer lookup tables.
+* Both paths write into a scratch frame, so no device and no locking is involved.
+*
+* @param repaints: Number of full matrix repaints per path
+*/
+void benchmarkColorConversion(int repaints) {
+    unsigned char frame[LED_REPORT_SIZE] = {0};
+    unsigned int checksum = 0;     // Keeps the compiler from removing the loops
+
+    // Step 1: Float path - clamp, multiply and divide per channel
+    auto float_start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repaints; i++) {
+        float brightness = (i % 128) / 127.0f;
+        for (int button = 0; button < MATRIX_ROWS * MATRIX_COLS; button++) {
+            BRGColor color = LED_COLOR_VALUES[(i + button) % LED_COLOR_COUNT];
+            int base_byte = LED_BYTE_MATRIX_START + button * MATRIX_LEDS_PER_BUTTON;
+            frame[base_byte]     = convertTo7BitFloat(color.blue, brightness);
+            frame[base_byte + 1] = convertTo7BitFloat(color.red, brightness);
+            frame[base_byte + 2] = convertTo7BitFloat(color.green, brightness);
+        }
+        checksum += frame[LED_BYTE_MATRIX_START + (i % 48)];
+    }
+    auto float_end = std::chrono::steady_clock::now();
+
+    // Step 2: Table path - one level conversion, then one lookup per button
+    auto table_start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repaints; i++) {
+        uint8_t level = brightnessToLevel((i % 128) / 127.0f);
+        for (int button = 0; button < MATRIX_ROWS * MATRIX_COLS; button++) {
+            const BRGColor& color = LED_COLOR_TABLE[(i + button) % LED_COLOR_COUNT][level];
+            int base_byte = LED_BYTE_MATRIX_START + button * MATRIX_LEDS_PER_BUTTON;
+            frame[base_byte]     = color.blue;
+            frame[base_byte + 1] = color.red;
+            frame[base_byte + 2] = color.green;
+        }
+        checksum += frame[LED_BYTE_MATRIX_START + (i % 48)];
+    }
+    auto table_end = std::chrono::steady_clock::now();
+
+    // Step 3: Report nanoseconds per full matrix repaint
+    double float_ns = std::chrono::duration<double, std::nano>(float_end - float_start).count() / repaints;
+    double table_ns = std::chrono::duration<double, std::nano>(table_end - table_start).count() / repaints;
+
+    std::cout << "=== Color Conversion Benchmark (" << repaints << " matrix repaints) ===" << std::endl;
+    std::cout << "  Float path: " << std::fixed << std::setprecision(1) << float_ns << " ns/repaint" << std::endl;
+    std::cout << "  Table path: " << std::fixed << std::setprecision(1) << table_ns << " ns/repaint" << std::endl;
+    std::cout << "  Speedup:    " << std::fixed << std::setprecision(2) << (table_ns > 0.0 ? float_ns / table_ns : 0.0) << "x"
+              << " (checksum " << checksum << ")" << std::endl;
+}
@@ -1,7 +1,10 @@
 #include "include/led_controller_display.h"
 #include "include/led_controller_base.h"
 
+#include <algorithm>            // For std::min, std::max
+#include <atomic>
 #include <iostream>
+#include <mutex>
 #include <hidapi/hidapi.h>
 
 // =============================================================================
@@ -28,12 +31,264 @@ const uint8_t DIGIT_PATTERNS[11][7] = {
     {0, 0, 0, 0, 0, 0, 0}                 // 10 = blank
 };
 
+// =============================================================================
+// GLYPH TABLE - Segment patterns for characters, built at compile time
+// =============================================================================
+
+/*
+* Builds a glyph from segment flags, in pattern order:
+* middle, lower_right, upper_right, top, upper_left, lower_left, bottom
+*/
+static constexpr DisplayGlyph makeGlyph(bool middle, bool lower_right, bool upper_right, bool top,
+                                        bool upper_left, bool lower_left, bool bottom) {
+    return {(uint8_t)(middle ? 127 : 0), (uint8_t)(lower_right ? 127 : 0), (uint8_t)(upper_right ? 127 : 0),
+            (uint8_t)(top ? 127 : 0), (uint8_t)(upper_left ? 127 : 0), (uint8_t)(lower_left ? 127 : 0),
+            (uint8_t)(bottom ? 127 : 0)};
+}
+
+/*
+* Builds the ASCII glyph table
+* Digits have the same shapes as DIGIT_PATTERNS. Letters that only exist in one
+* case on 7 segments (b, d, n, o, r, t, u, ...) are used for both cases.
+*/
+static constexpr std::array<DisplayGlyph, DISPLAY_GLYPH_COUNT> makeGlyphTable() {
+    std::array<DisplayGlyph, DISPLAY_GLYPH_COUNT> table{};
+
+    struct Entry { char character; DisplayGlyph glyph; };
+    constexpr Entry entries[] = {
+        //        mid    lr     ur     top    ul     ll     bot
+        {'0', makeGlyph(false, true,  true,  true,  true,  true,  true )},
+        {'1', makeGlyph(false, true,  true,  false, false, false, false)},
+        {'2', makeGlyph(true,  false, true,  true,  false, true,  true )},
+        {'3', makeGlyph(true,  true,  true,  true,  false, false, true )},
+        {'4', makeGlyph(true,  true,  true,  false, true,  false, false)},
+        {'5', makeGlyph(true,  true,  false, true,  true,  false, true )},
+        {'6', makeGlyph(true,  true,  false, true,  true,  true,  true )},
+        {'7', makeGlyph(false, true,  true,  true,  false, false, false)},
+        {'8', makeGlyph(true,  true,  true,  true,  true,  true,  true )},
+        {'9', makeGlyph(true,  true,  true,  true,  true,  false, true )},
+        {'A', makeGlyph(true,  true,  true,  true,  true,  true,  false)},
+        {'B', makeGlyph(true,  true,  false, false, true,  true,  true )},   // b
+        {'C', makeGlyph(false, false, false, true,  true,  true,  true )},
+        {'D', makeGlyph(true,  true,  true,  false, false, true,  true )},   // d
+        {'E', makeGlyph(true,  false, false, true,  true,  true,  true )},
+        {'F', makeGlyph(true,  false, false, true,  true,  true,  false)},
+        {'G', makeGlyph(false, true,  false, true,  true,  true,  true )},
+        {'H', makeGlyph(true,  true,  true,  false, true,  true,  false)},
+        {'I', makeGlyph(false, true,  true,  false, false, false, false)},
+        {'J', makeGlyph(false, true,  true,  false, false, true,  true )},
+        {'L', makeGlyph(false, false, false, false, true,  true,  true )},
+        {'N', makeGlyph(true,  true,  false, false, false, true,  false)},   // n
+        {'O', makeGlyph(true,  true,  false, false, false, true,  true )},   // o
+        {'P', makeGlyph(true,  false, true,  true,  true,  true,  false)},
+        {'Q', makeGlyph(true,  true,  true,  true,  true,  false, false)},   // q
+        {'R', makeGlyph(true,  false, false, false, false, true,  false)},   // r
+        {'S', makeGlyph(true,  true,  false, true,  true,  false, true )},
+        {'T', makeGlyph(true,  false, false, false, true,  true,  true )},   // t
+        {'U', makeGlyph(false, true,  true,  false, true,  true,  true )},
+        {'Y', makeGlyph(true,  true,  true,  false, true,  false, true )},   // y
+        {'-', makeGlyph(true,  false, false, false, false, false, false)},
+        {'_', makeGlyph(false, false, false, false, false, false, true )},
+        {'=', makeGlyph(true,  false, false, false, false, false, true )},
+    };
+
+    for (const Entry& entry : entries) {
+        table[(int)entry.character] = entry.glyph;
+        if (entry.character >= 'A' && entry.character <= 'Z') {
+            table[entry.character - 'A' + 'a'] = entry.glyph;
+        }
+    }
+    // Lowercase shapes that differ from the uppercase ones
+    table['c'] = makeGlyph(true, false, false, false, false, true, true);
+    table['h'] = makeGlyph(true, true, false, false, true, true, false);
+    table['i'] = makeGlyph(false, true, false, false, false, false, false);
+    table['u'] = makeGlyph(false, true, false, false, false, true, true);
+    return table;
+}
+
+constexpr std::array<DisplayGlyph, DISPLAY_GLYPH_COUNT> DISPLAY_GLYPHS = makeGlyphTable();
+
+// =============================================================================
+// DISPLAY FRAME CACHE - Complete display bytes, built at compile time
+// =============================================================================
+
+/*
+* Builds a display frame from two glyphs, dots off
+*/
+static constexpr DisplayFrame makeFrameFromGlyphs(const DisplayGlyph& left, const DisplayGlyph& right) {
+    DisplayFrame frame{};
+    for (int segment = 0; segment < DISPLAY_SEGMENT_COUNT; segment++) {
+        frame[1 + segment] = right[segment];    // Right display: bytes 2-8
+        frame[9 + segment] = left[segment];     // Left display: bytes 10-16
+    }
+    return frame;
+}
+
+static constexpr std::array<DisplayFrame, DISPLAY_NUMBER_COUNT> makeNumberFrames() {
+    std::array<DisplayFrame, DISPLAY_NUMBER_COUNT> frames{};
+    for (int number = 0; number < DISPLAY_NUMBER_COUNT; number++) {
+        const DisplayGlyph& left = DISPLAY_GLYPHS[number >= 10 ? '0' + number / 10 : ' '];
+        frames[number] = makeFrameFromGlyphs(left, DISPLAY_GLYPHS['0' + number % 10]);
+    }
+    return frames;
+}
+
+static constexpr std::array<DisplayFrame, DISPLAY_HEX_COUNT> makeHexFrames() {
+    constexpr char HEX_DIGITS[] = "0123456789AbCdEF";
+    std::array<DisplayFrame, DISPLAY_HEX_COUNT> frames{};
+    for (int code = 0; code < DISPLAY_HEX_COUNT; code++) {
+        frames[code] = makeFrameFromGlyphs(DISPLAY_GLYPHS[HEX_DIGITS[code >> 4]], DISPLAY_GLYPHS[HEX_DIGITS[code & 0x0F]]);
+    }
+    return frames;
+}
+
+constexpr std::array<DisplayFrame, DISPLAY_NUMBER_COUNT> DISPLAY_NUMBER_FRAMES = makeNumberFrames();
+constexpr std::array<DisplayFrame, DISPLAY_HEX_COUNT> DISPLAY_HEX_FRAMES = makeHexFrames();
+constexpr DisplayFrame DISPLAY_BLANK_FRAME{};
+
+/*
+* Gets the segment pattern of a character
+*
+* @param character: ASCII character, anything without a shape is blank
+* @return: Segment pattern
+*/
+const DisplayGlyph& getDisplayGlyph(char character) {
+    unsigned char index = (unsigned char)character;
+    return DISPLAY_GLYPHS[index < DISPLAY_GLYPH_COUNT ? index : ' '];
+}
+
+/*
+* Builds a display frame for two characters, e.g. a status code like "Er"
+*
+* @param left: Character on the left display
+* @param right: Character on the right display
+* @return: Display frame with dots off
+*/
+DisplayFrame makeDisplayFrame(char left, char right) {
+    return makeFrameFromGlyphs(getDisplayGlyph(left), getDisplayGlyph(right));
+}
+
+// =============================================================================
+// DISPLAY SCROLLING
+// =============================================================================
+
+/*
+* Scroll state, guarded by scroll_mutex
+* The text is stored padded with a blank on both sides, each position shows
+* two neighbouring characters: " 128 " -> " 1", "12", "28", "8 "
+*/
+static struct {
+    char text[DISPLAY_SCROLL_MAX_LENGTH + 2];
+    int positions;              // Number of two-character windows
+    int step_ms;
+    int repeat;                 // Passes over the text, 0 = until stopped
+    bool started;               // start_ms is set on the first update
+    uint64_t start_ms;
+    int last_position;          // Position in the LED buffer, -1 = none yet
+} display_scroll;
+
+static std::mutex scroll_mutex;                   // Taken before the LED buffer lock
+static std::atomic<bool> scroll_active(false);    // Lets idle ticks skip the lock
+
+/*
+* Writes the segments of both digits, the dots are left alone
+*/
+static void writeDisplayGlyphs(char left, char right) {
+    writeLEDBytes(LED_BYTE_7SEG_LEFT_START + 1, getDisplayGlyph(left).data(), DISPLAY_SEGMENT_COUNT);
+    writeLEDBytes(LED_BYTE_7SEG_RIGHT_START + 1, getDisplayGlyph(right).data(), DISPLAY_SEGMENT_COUNT);
+}
+
+/*
+* Starts scrolling a text, replacing a running scroll
+* The first position is shown on the next animation tick.
+*
+* @param text: Text to scroll (see DISPLAY_GLYPHS), at most DISPLAY_SCROLL_MAX_LENGTH characters
+* @param step_ms: Time each position is shown in milliseconds
+* @param repeat: Passes over the text, 0 = until stopped
+*/
+void startDisplayScroll(const std::string& text, int step_ms, int repeat) {
+    int length = std::min((int)text.size(), DISPLAY_SCROLL_MAX_LENGTH);
+
+    std::lock_guard<std::mutex> lock(scroll_mutex);
+    display_scroll.text[0] = ' ';
+    text.copy(display_scroll.text + 1, length);
+    display_scroll.text[length + 1] = ' ';
+    display_scroll.positions = length + 1;
+    display_scroll.step_ms = std::max(1, step_ms);
+    display_scroll.repeat = std::max(0, repeat);
+    display_scroll.started = false;
+    display_scroll.last_position = -1;
+    scroll_active = true;
+}
+
+/*
+* Stops the scroll, the digits keep the position they show
+*/
+void stopDisplayScroll() {
+    std::lock_guard<std::mutex> lock(scroll_mutex);
+    scroll_active = false;
+}
+
+bool isDisplayScrolling() {
+    return scroll_active;
+}
+
+/*
+* Moves the scroll to the position for the given time
+* Called by the animation engine between beginLEDFrame() and commitLEDFrame().
+* The buffer is only written when the position changes.
+*
+* @param time_ms: Current time in milliseconds (steady clock)
+* @return: true if the display bytes changed
+*/
+bool updateDisplayScroll(uint64_t time_ms) {
+    if (!scroll_active) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(scroll_mutex);
+    if (!scroll_active) {
+        return false;
+    }
+
+    // Step 1: The scroll starts with the first tick that sees it
+    if (!display_scroll.started) {
+        display_scroll.started = true;
+        display_scroll.start_ms = time_ms;
+    }
+    uint64_t step = (time_ms - display_scroll.start_ms) / display_scroll.step_ms;
+
+    // Step 2: A finished scroll leaves the digits blank
+    if (display_scroll.repeat > 0 && step >= (uint64_t)display_scroll.positions * display_scroll.repeat) {
+        scroll_active = false;
+        writeDisplayGlyphs(' ', ' ');
+        return true;
+    }
+
+    // Step 3: Show the current two characters
+    int position = (int)(step % display_scroll.positions);
+    if (position == display_scroll.last_position) {
+        return false;
+    }
+    display_scroll.last_position = position;
+    writeDisplayGlyphs(display_scroll.text[position], display_scroll.text[position + 1]);
+    return true;
+}
+
 // =============================================================================
 // MAIN LED CONTROLLER DISPLAY CLASS IMPLEMENTATION
 // =============================================================================
 
+/*
+* Constructor
+*
+* Both dots start off, like the LED buffer.
+*/
+DisplayController::DisplayController() : left_dot(0), right_dot(0) {
+}
+
 /*
 * Set the display number (1-99)
+* Copies the cached frame of the number, one write into the LED buffer
 *
 * @param number: Number to display (1-99)
 */
@@ -42,13 +297,85 @@ void DisplayController::setDisplayNumber(int number) {
     if (number < 1) number = 1;
     if (number > 99) number = 99;
 
-    // Step 2: Split number into digits
-    int left_digit = (number >= 10) ? (number / 10) : 10; // 10 = blank index
-    int right_digit = number % 10;
-    
-    // Step 3: Set each display
-    setDisplaySegment(1, left_digit);  // Left display
-    setDisplaySegment(2, right_digit); // Right display
+    // Step 2: Show the precomputed frame (left digit blank below 10)
+    setDisplayFrame(DISPLAY_NUMBER_FRAMES[number]);
+}
+
+/*
+* Shows a complete display frame, keeping the current dots
+* Both digits change in one copy, the next flush sends them together.
+*
+* @param frame: Display frame, e.g. from DISPLAY_NUMBER_FRAMES or makeDisplayFrame()
+*/
+void DisplayController::setDisplayFrame(const DisplayFrame& frame) {
+    stopDisplayScroll();
+    DisplayFrame bytes = frame;
+    bytes[0] = right_dot;                                             // Byte 1
+    bytes[LED_BYTE_7SEG_LEFT_START - DISPLAY_FRAME_START] = left_dot;  // Byte 9
+    writeLEDBytes(DISPLAY_FRAME_START, bytes.data(), DISPLAY_FRAME_SIZE);
+}
+
+/*
+* Shows a status code as two hex digits (00-FF)
+*
+* @param code: Code to display
+*/
+void DisplayController::setDisplayHex(uint8_t code) {
+    setDisplayFrame(DISPLAY_HEX_FRAMES[code]);
+}
+
+/*
+* Shows two characters, see DISPLAY_GLYPHS for the ones that have a shape
+*
+* @param left: Character on the left display
+* @param right: Character on the right display
+*/
+void DisplayController::setDisplayText(char left, char right) {
+    setDisplayFrame(makeDisplayFrame(left, right));
+}
+
+/*
+* Blanks both digits, the dots keep their state
+*/
+void DisplayController::clearDisplay() {
+    setDisplayFrame(DISPLAY_BLANK_FRAME);
+}
+
+/*
+* Shows any number, e.g. a BPM or a negative offset
+* -9 to 99 fit on the digits, everything else scrolls.
+*
+* @param value: Number to display
+* @param step_ms: Scroll speed, time each position is shown
+* @param repeat: Scroll passes, 0 = until the display is set again
+*/
+void DisplayController::setDisplayValue(int value, int step_ms, int repeat) {
+    if (value >= 0 && value < DISPLAY_NUMBER_COUNT) {
+        setDisplayFrame(DISPLAY_NUMBER_FRAMES[value]);
+    } else if (value < 0 && value > -10) {
+        setDisplayText('-', (char)('0' - value));
+    } else {
+        startDisplayScroll(std::to_string(value), step_ms, repeat);
+    }
+}
+
+/*
+* Shows a text, texts longer than two characters scroll
+*
+* @param text: Text to display, see DISPLAY_GLYPHS for the characters that have a shape
+* @param step_ms: Scroll speed, time each position is shown
+* @param repeat: Scroll passes, 0 = until the display is set again
+*/
+void DisplayController::scrollDisplayText(const std::string& text, int step_ms, int repeat) {
+    if (text.size() <= 2) {
+        setDisplayText(text.size() == 2 ? text[0] : ' ', text.empty() ? ' ' : text.back());
+        return;
+    }
+    startDisplayScroll(text, step_ms, repeat);
+}
+
+bool DisplayController::isScrolling() const {
+    return isDisplayScrolling();
 }
 
 /*
@@ -59,25 +386,19 @@ void DisplayController::setDisplayNumber(int number) {
 */
 
 void DisplayController::setDisplayDot(int display, bool on) {
-    // Step 1: Access the external led_buffer and device from led_controller
-    extern unsigned char led_buffer[81];
-    extern hid_device* current_device;
-    
-    // Step 2: Set brightness based on on/off state
+    // Step 1: Set brightness based on on/off state
     uint8_t brightness = on ? 127 : 0;
     
-    // Step 3: Set the appropriate dot byte
+    // Step 2: Set the appropriate dot byte, the next flush sends it to the device
+    // The level is remembered so frame copies keep the dot
     if (display == 1) {
         // Left display dot (byte 9)
-        led_buffer[9] = brightness;
+        left_dot = brightness;
+        writeLEDBytes(9, &brightness, 1);
     } else if (display == 2) {
         // Right display dot (byte 1) 
-        led_buffer[1] = brightness;
-    }
-
-    // Step 4: Send updated buffer to device
-    if (current_device != nullptr) {
-        hid_write(current_device, led_buffer, 81);
+        right_dot = brightness;
+        writeLEDBytes(1, &brightness, 1);
     }
 }
 
@@ -95,11 +416,7 @@ void DisplayController::setDisplaySegment(int display, int digit) {
         return; // Invalid digit
     }
 
-    // Step 2: Access the external led_buffer and device from led_controller
-    extern unsigned char led_buffer[81];
-    extern hid_device* current_device;
-
-    // Step 3: Calculate byte positions
+    // Step 2: Calculate byte positions
     int base_byte;
     if (display == 1) {
         // Left display: bytes 10-16 (skip dot at byte 9)
@@ -112,14 +429,8 @@ void DisplayController::setDisplaySegment(int display, int digit) {
         return; // Invalid display
     }
     
-    // Step 4: Set 7 segments using the digit patterns
+    // Step 3: Set 7 segments using the digit patterns
     // Pattern order: [middle, lower_right, upper_right, top, upper_left, lower_left, bottom]
-    for (int i = 0; i < 7; i++) {
-        led_buffer[base_byte + i] = DIGIT_PATTERNS[digit][i];
-    }
-
-    // Step 5: Send updated buffer to device
-    if (current_device != nullptr) {
-        hid_write(current_device, led_buffer, 81);
-    }
+    // The next flush sends the updated buffer to the device
+    writeLEDBytes(base_byte, DIGIT_PATTERNS[digit], 7);
 }
\ No newline at end of file
@@ -0,0 +1,285 @@
+#include "include/led_frame_encoder.h"
+
+#include <iostream>             // For std::cout and std::cerr
+#include <array>                // For the curve tables
+#include <cmath>                // For std::pow (only when a gamma curve is selected)
+#include <mutex>                // For std::mutex guarding the curve tables
+#include <cstring>              // For memset
+
+// =============================================================================
+// CURVE TABLES - One 128-entry table per LED group
+// =============================================================================
+
+using CurveTable = std::array<uint8_t, LED_BRIGHTNESS_LEVELS>;
+using FineCurveTable = std::array<uint16_t, LED_BRIGHTNESS_LEVELS>;    // 7.5 fixed point, for dithering
+
+/*
+* Builds the identity table at compile time
+*/
+static constexpr CurveTable makeLinearCurve() {
+    CurveTable table{};
+    for (int level = 0; level < LED_BRIGHTNESS_LEVELS; level++) {
+        table[level] = (uint8_t)level;
+    }
+    return table;
+}
+
+/*
+* Builds the CIE 1931 lightness curve at compile time
+* The level is treated as perceived lightness L* (0-100) and converted to
+* relative luminance Y, which is what the LED PWM controls.
+*/
+static constexpr CurveTable makePerceptualCurve() {
+    CurveTable table{};
+    for (int level = 0; level < LED_BRIGHTNESS_LEVELS; level++) {
+        double lightness = level * 100.0 / 127.0;
+        double luminance;
+        if (lightness <= 8.0) {
+            luminance = lightness / 903.3;
+        } else {
+            double t = (lightness + 16.0) / 116.0;
+            luminance = t * t * t;
+        }
+        table[level] = (uint8_t)(luminance * 127.0 + 0.5);
+    }
+    return table;
+}
+
+/*
+* Same curves with LED_DITHER_BITS extra fraction bits
+* Output = curve value * 2^LED_DITHER_BITS, so the 7-bit level is output >> 5
+* and the low 5 bits are what temporal dithering adds on average.
+*/
+static constexpr FineCurveTable makeFineLinearCurve() {
+    FineCurveTable table{};
+    for (int level = 0; level < LED_BRIGHTNESS_LEVELS; level++) {
+        table[level] = (uint16_t)(level << LED_DITHER_BITS);
+    }
+    return table;
+}
+
+static constexpr FineCurveTable makeFinePerceptualCurve() {
+    FineCurveTable table{};
+    for (int level = 0; level < LED_BRIGHTNESS_LEVELS; level++) {
+        double lightness = level * 100.0 / 127.0;
+        double luminance;
+        if (lightness <= 8.0) {
+            luminance = lightness / 903.3;
+        } else {
+            double t = (lightness + 16.0) / 116.0;
+            luminance = t * t * t;
+        }
+        table[level] = (uint16_t)(luminance * (127 << LED_DITHER_BITS) + 0.5);
+    }
+    return table;
+}
+
+static constexpr CurveTable LINEAR_CURVE = makeLinearCurve();
+static constexpr CurveTable PERCEPTUAL_CURVE = makePerceptualCurve();
+static constexpr FineCurveTable FINE_LINEAR_CURVE = makeFineLinearCurve();
+static constexpr FineCurveTable FINE_PERCEPTUAL_CURVE = makeFinePerceptualCurve();
+
+// Active curve per group, and the curve type for getLEDGroupCurve()
+static CurveTable group_tables[LED_GROUP_COUNT] = {LINEAR_CURVE, LINEAR_CURVE, LINEAR_CURVE, LINEAR_CURVE};
+static LEDBrightnessCurve group_curves[LED_GROUP_COUNT] = {
+    LEDBrightnessCurve::LINEAR, LEDBrightnessCurve::LINEAR, LEDBrightnessCurve::LINEAR, LEDBrightnessCurve::LINEAR
+};
+static FineCurveTable fine_group_tables[LED_GROUP_COUNT] = {
+    FINE_LINEAR_CURVE, FINE_LINEAR_CURVE, FINE_LINEAR_CURVE, FINE_LINEAR_CURVE
+};
+static bool group_dithering[LED_GROUP_COUNT] = {false, false, false, false};
+static std::mutex curve_mutex;     // Guards the tables, held briefly per encode
+
+// =============================================================================
+// CURVE CONFIGURATION FUNCTIONS
+// =============================================================================
+
+/*
+* Selects the brightness curve of an LED group
+* The table is built here, so encoding never does float math.
+* The LED buffer is marked dirty so the new curve reaches the device.
+*
+* @param group: LED group to configure
+* @param curve: LINEAR, GAMMA or PERCEPTUAL
+* @param gamma: Exponent for GAMMA (ignored otherwise), e.g. 2.2
+*/
+void setLEDGroupCurve(LEDGroup group, LEDBrightnessCurve curve, float gamma) {
+    // Step 1: Build the tables outside the lock
+    CurveTable table;
+    FineCurveTable fine_table;
+    switch (curve) {
+        case LEDBrightnessCurve::LINEAR:
+            table = LINEAR_CURVE;
+            fine_table = FINE_LINEAR_CURVE;
+            break;
+        case LEDBrightnessCurve::PERCEPTUAL:
+            table = PERCEPTUAL_CURVE;
+            fine_table = FINE_PERCEPTUAL_CURVE;
+            break;
+        case LEDBrightnessCurve::GAMMA:
+            if (!(gamma > 0.0f)) {
+                std::cerr << "Error: Invalid gamma in setLEDGroupCurve()" << std::endl;
+                return;
+            }
+            for (int level = 0; level < LED_BRIGHTNESS_LEVELS; level++) {
+                double value = std::pow(level / 127.0, (double)gamma);
+                table[level] = (uint8_t)(value * 127.0 + 0.5);
+                fine_table[level] = (uint16_t)(value * (127 << LED_DITHER_BITS) + 0.5);
+            }
+            break;
+    }
+
+    // Step 2: Install them
+    {
+        std::lock_guard<std::mutex> lock(curve_mutex);
+        group_tables[(int)group] = table;
+        fine_group_tables[(int)group] = fine_table;
+        group_curves[(int)group] = curve;
+    }
+
+    // Step 3: Re-encode on the next flush
+    markLEDBufferDirty();
+}
+
+LEDBrightnessCurve getLEDGroupCurve(LEDGroup group) {
+    std::lock_guard<std::mutex> lock(curve_mutex);
+    return group_curves[(int)group];
+}
+
+/*
+* Enables temporal dithering (frame-rate modulation) for an LED group
+* The group's curve is then rendered with LED_DITHER_BITS extra bits, and the
+* writer thread alternates between the two nearest 7-bit levels on every
+* frame so the average hits the in-between value. This only has an effect
+* with a writer thread attached. The in-between values come from the float
+* brightness given to the setters (for every curve) and from GAMMA and
+* PERCEPTUAL curves, whose low end falls between 7-bit levels.
+*
+* @param group: LED group to configure
+* @param enabled: true to dither, false to round to the nearest level
+*/
+void setLEDGroupDithering(LEDGroup group, bool enabled) {
+    {
+        std::lock_guard<std::mutex> lock(curve_mutex);
+        group_dithering[(int)group] = enabled;
+    }
+    markLEDBufferDirty();
+}
+
+bool isLEDGroupDithering(LEDGroup group) {
+    std::lock_guard<std::mutex> lock(curve_mutex);
+    return group_dithering[(int)group];
+}
+
+/*
+* Gets the LED group a byte of the LED report belongs to
+*
+* @param byte_position: Byte in the LED report (1-80)
+* @return: LEDGroup of that byte
+*/
+LEDGroup getLEDGroupForByte(int byte_position) {
+    if (byte_position < LED_BYTE_SPECIAL_START) return LEDGroup::DISPLAY;
+    if (byte_position < LED_BYTE_MATRIX_START) return LEDGroup::BUTTONS;
+    if (byte_position < LED_BYTE_STOP_START) return LEDGroup::MATRIX;
+    return LEDGroup::STOP;
+}
+
+// =============================================================================
+// FRAME ENCODING
+// =============================================================================
+
+/*
+* Applies one group's curve table to a byte range
+* Dithered groups are split into the 7-bit level below the curve value and
+* the fraction above it, all others are rounded to the nearest level. With
+* fine levels, dithered groups interpolate the curve between the two table
+* entries around the input.
+*
+* @return: true if any byte of the range has a fraction
+*/
+static bool encodeRange(const unsigned char* source, const uint16_t* fine_source, unsigned char* frame,
+                        unsigned char* fractions, int start, int end, LEDGroup group) {
+    if (fractions == nullptr || !group_dithering[(int)group]) {
+        const CurveTable& table = group_tables[(int)group];
+        for (int i = start; i < end; i++) {
+            frame[i] = table[source[i]];
+        }
+        if (fractions != nullptr) {
+            memset(fractions + start, 0, end - start);
+        }
+        return false;
+    }
+
+    const FineCurveTable& table = fine_group_tables[(int)group];
+    uint8_t any_fraction = 0;
+    for (int i = start; i < end; i++) {
+        uint16_t value;
+        if (fine_source != nullptr) {
+            int level = fine_source[i] >> LED_DITHER_BITS;
+            int fraction = fine_source[i] & LED_DITHER_MASK;
+            if (level >= LED_BRIGHTNESS_LEVELS - 1) {
+                value = table[LED_BRIGHTNESS_LEVELS - 1];
+            } else {
+                value = (uint16_t)(table[level] + ((table[level + 1] - table[level]) * fraction +
+                                                   (1 << (LED_DITHER_BITS - 1))) / (1 << LED_DITHER_BITS));
+            }
+        } else {
+            value = table[source[i]];
+        }
+        frame[i] = (uint8_t)(value >> LED_DITHER_BITS);
+        fractions[i] = (uint8_t)(value & LED_DITHER_MASK);
+        any_fraction |= fractions[i];
+    }
+    return any_fraction != 0;
+}
+
+/*
+* Encodes linear LED levels into the report that is sent to the F1
+* One table lookup per byte, the report ID is copied unchanged.
+*
+* @param source: Linear 81-byte LED buffer, levels 0-127 (the setters clamp)
+* @param frame: Output 81-byte report (may not alias source)
+* @param fractions: Optional 81-byte output, dither fraction of each byte
+*                   (0 - LED_DITHER_MASK), nullptr to round every group
+* @param fine_source: Optional source levels with LED_DITHER_BITS fraction
+*                     bits, used by dithered groups instead of source
+* @return: true if fractions were written and at least one is not zero
+*/
+bool encodeLEDFrame(const unsigned char* source, unsigned char* frame, unsigned char* fractions,
+                    const uint16_t* fine_source) {
+    std::lock_guard<std::mutex> lock(curve_mutex);
+
+    frame[0] = source[0];
+    if (fractions != nullptr) {
+        fractions[0] = 0;
+    }
+    bool dithered = false;
+    dithered |= encodeRange(source, fine_source, frame, fractions, LED_BYTE_7SEG_RIGHT_START, LED_BYTE_SPECIAL_START, LEDGroup::DISPLAY);
+    dithered |= encodeRange(source, fine_source, frame, fractions, LED_BYTE_SPECIAL_START, LED_BYTE_MATRIX_START, LEDGroup::BUTTONS);
+    dithered |= encodeRange(source, fine_source, frame, fractions, LED_BYTE_MATRIX_START, LED_BYTE_STOP_START, LEDGroup::MATRIX);
+    dithered |= encodeRange(source, fine_source, frame, fractions, LED_BYTE_STOP_START, LED_REPORT_SIZE, LEDGroup::STOP);
+    return dithered;
+}
+
+/*
+* Renders one dithered frame (first-order sigma-delta over time)
+* Each byte's fraction is added to its accumulator every frame; whenever it
+* overflows, that frame shows the next higher level. Over 2^LED_DITHER_BITS
+* frames the average is level + fraction / 2^LED_DITHER_BITS.
+*
+* @param frame: Encoded 81-byte report (levels rounded down)
+* @param fractions: Fractions from encodeLEDFrame()
+* @param accumulators: 81 bytes of per-LED state, kept between frames (start with zeros)
+* @param output: Output 81-byte report
+*/
+void ditherLEDFrame(const unsigned char* frame, const unsigned char* fractions,
+                    unsigned char* accumulators, unsigned char* output) {
+    output[0] = frame[0];
+    for (int i = 1; i < LED_REPORT_SIZE; i++) {
+        uint8_t sum = accumulators[i] + fractions[i];
+        uint8_t carry = sum >> LED_DITHER_BITS;
+        accumulators[i] = sum & LED_DITHER_MASK;
+        uint8_t level = frame[i] + carry;
+        output[i] = level > 127 ? 127 : level;
+    }
+}
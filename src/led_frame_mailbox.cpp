@@ -0,0 +1,108 @@
+#include "include/led_frame_mailbox.h"
+
+#include <cstring>              // For memcpy
+
+// =============================================================================
+// LED FRAME MAILBOX CLASS IMPLEMENTATION
+// =============================================================================
+
+/*
+* Constructor
+*
+* Slot 0 starts as back buffer, slot 1 as middle, slot 2 as front.
+* All slots start as an empty report (all LEDs off).
+*/
+LEDFrameMailbox::LEDFrameMailbox() : middle_state(1), sequence(0), back_index(0), front_index(2) {
+    for (int i = 0; i < 3; i++) {
+        slots[i].fill(0);
+        slots[i][0] = LED_REPORT_ID;
+        fraction_slots[i].fill(0);
+        has_fractions[i] = false;
+        origins[i] = 0;
+    }
+}
+
+/*
+* Publishes a complete frame, replacing any frame that was not fetched yet
+* Never blocks: the frame is copied into the back slot, which is then swapped
+* with the middle slot in one atomic exchange.
+*
+* @param frame: Complete 81-byte LED report
+* @param fractions: Optional dither fractions of the frame, see encodeLEDFrame()
+* @param origin_ns: Optional event time the frame shows, for latency statistics
+*/
+void LEDFrameMailbox::publish(const unsigned char* frame, const unsigned char* fractions, int64_t origin_ns) {
+    // Step 1: Fill the producer-owned back slot
+    memcpy(slots[back_index].data(), frame, LED_REPORT_SIZE);
+    has_fractions[back_index] = fractions != nullptr;
+    if (fractions != nullptr) {
+        memcpy(fraction_slots[back_index].data(), fractions, LED_REPORT_SIZE);
+    }
+    origins[back_index] = origin_ns;
+
+    // Step 2: Swap it into the middle and take the old middle as new back slot
+    uint8_t previous = middle_state.exchange(back_index | FRESH_BIT, std::memory_order_acq_rel);
+    back_index = previous & INDEX_MASK;
+
+    // Step 3: Wake the consumer
+    sequence.fetch_add(1, std::memory_order_release);
+    sequence.notify_one();
+}
+
+/*
+* Takes the newest published frame, if there is one
+*
+* @return: Pointer to the frame (valid until the next fetch), or nullptr if
+*          nothing was published since the last fetch
+*/
+const unsigned char* LEDFrameMailbox::fetch() {
+    // Step 1: Nothing new in the middle slot
+    if ((middle_state.load(std::memory_order_acquire) & FRESH_BIT) == 0) {
+        return nullptr;
+    }
+
+    // Step 2: Swap our front slot into the middle and take the fresh frame
+    uint8_t previous = middle_state.exchange(front_index, std::memory_order_acq_rel);
+    front_index = previous & INDEX_MASK;
+    return slots[front_index].data();
+}
+
+/*
+* Gets the dither fractions of the frame returned by the last fetch()
+*
+* @return: Pointer to the fractions, or nullptr if the frame has none
+*/
+const unsigned char* LEDFrameMailbox::fetchedFractions() const {
+    return has_fractions[front_index] ? fraction_slots[front_index].data() : nullptr;
+}
+
+/*
+* Gets the event time of the frame returned by the last fetch()
+* A frame that was replaced before it was fetched takes its event time with
+* it, that sample is not counted.
+*
+* @return: Event time in nanoseconds, 0 if the frame has none
+*/
+int64_t LEDFrameMailbox::fetchedOrigin() const {
+    return origins[front_index];
+}
+
+/*
+* Sleeps until publish() or wake() was called after last_sequence
+*
+* @param last_sequence: Sequence value returned by the previous call (start with 0)
+* @return: Current sequence value, pass it to the next call
+*/
+uint32_t LEDFrameMailbox::waitForPublish(uint32_t last_sequence) const {
+    sequence.wait(last_sequence, std::memory_order_acquire);
+    return sequence.load(std::memory_order_acquire);
+}
+
+/*
+* Wakes a consumer sleeping in waitForPublish() without publishing a frame
+* Used to shut the writer thread down
+*/
+void LEDFrameMailbox::wake() {
+    sequence.fetch_add(1, std::memory_order_release);
+    sequence.notify_all();
+}
@@ -0,0 +1,457 @@
+#include "include/led_layers.h"
+#include "include/led_frame_encoder.h"   // For LED_DITHER_BITS
+
+#include <iostream>             // For std::cout and std::cerr
+#include <cstring>              // For memset and memcpy
+#include <mutex>                // For std::mutex guarding the layers
+
+// =============================================================================
+// LAYER STORAGE - Levels and coverage of the layers above BASE
+// =============================================================================
+
+/*
+* Every layer above BASE has a full 81-byte report of levels and a coverage
+* mask: 0xFF where the layer was painted, 0x00 where it is transparent.
+* Index 0 (BASE) is unused, BASE is the LED buffer that is passed in.
+* Lock order: led_buffer_mutex (held by the commit) before layer_mutex.
+*/
+static unsigned char layer_values[LED_LAYER_COUNT][LED_REPORT_SIZE];
+static unsigned char layer_masks[LED_LAYER_COUNT][LED_REPORT_SIZE];
+static bool layer_used[LED_LAYER_COUNT];                    // Any byte covered, skip the layer if not
+static uint8_t layer_opacity[LED_LAYER_COUNT] = {255, 255, 255};
+static LEDBlendMode layer_modes[LED_LAYER_COUNT] = {LEDBlendMode::NORMAL, LEDBlendMode::NORMAL, LEDBlendMode::NORMAL};
+static std::mutex layer_mutex;
+
+/*
+* Layer painting of the calling thread's open frame (see beginLEDFrame())
+* Kept per thread until the frame is committed, then merged byte by byte,
+* so another thread's commit never publishes half of it.
+*/
+struct LEDLayerFrame {
+    unsigned char values[LED_LAYER_COUNT][LED_REPORT_SIZE];
+    unsigned char masks[LED_LAYER_COUNT][LED_REPORT_SIZE];
+    bool touched[LED_LAYER_COUNT][LED_REPORT_SIZE];
+    bool painted;                                           // Anything to merge
+};
+static thread_local LEDLayerFrame layer_frame;
+
+static const char* LAYER_NAMES[LED_LAYER_COUNT] = {"BASE", "OVERLAY", "FEEDBACK"};
+
+/*
+* Validates a layer for painting: BASE is handled by the callers
+*/
+static bool isValidLayer(LEDLayer layer) {
+    int index = (int)layer;
+    return index >= 0 && index < LED_LAYER_COUNT;
+}
+
+/*
+* Covers bytes of a layer with levels, or uncovers them
+* Inside an open frame the bytes go to the thread's frame instead.
+* Levels above 127 are stored as 127.
+*
+* @param bytes: Levels to write, nullptr to uncover
+*/
+static void storeLayerBytes(int layer, int start_byte, const uint8_t* bytes, int count) {
+    if (isLEDFrameOpen()) {
+        for (int i = 0; i < count; i++) {
+            layer_frame.values[layer][start_byte + i] = bytes != nullptr ? (bytes[i] > 127 ? 127 : bytes[i]) : 0;
+            layer_frame.masks[layer][start_byte + i] = bytes != nullptr ? 0xFF : 0x00;
+            layer_frame.touched[layer][start_byte + i] = true;
+        }
+        layer_frame.painted = true;
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(layer_mutex);
+    if (bytes != nullptr) {
+        for (int i = 0; i < count; i++) {
+            layer_values[layer][start_byte + i] = bytes[i] > 127 ? 127 : bytes[i];
+        }
+        memset(layer_masks[layer] + start_byte, 0xFF, count);
+        layer_used[layer] = true;
+    } else {
+        memset(layer_masks[layer] + start_byte, 0x00, count);
+    }
+}
+
+// =============================================================================
+// LAYER CONFIGURATION FUNCTIONS
+// =============================================================================
+
+/*
+* Sets how strongly a layer covers the layers below
+* For BASE, the opacity dims the application LEDs.
+*
+* @param layer: Layer to configure
+* @param opacity: 0.0 = invisible, 1.0 = fully covering
+*/
+void setLEDLayerOpacity(LEDLayer layer, float opacity) {
+    if (!isValidLayer(layer)) {
+        std::cerr << "Error: Invalid layer in setLEDLayerOpacity()" << std::endl;
+        return;
+    }
+    if (opacity < 0.0f) opacity = 0.0f;
+    if (opacity > 1.0f) opacity = 1.0f;
+    {
+        std::lock_guard<std::mutex> lock(layer_mutex);
+        layer_opacity[(int)layer] = (uint8_t)(opacity * 255.0f + 0.5f);
+    }
+    markLEDBufferDirty();
+}
+
+float getLEDLayerOpacity(LEDLayer layer) {
+    if (!isValidLayer(layer)) {
+        return 0.0f;
+    }
+    std::lock_guard<std::mutex> lock(layer_mutex);
+    return layer_opacity[(int)layer] / 255.0f;
+}
+
+/*
+* Sets how a layer combines with the layers below
+*
+* @param layer: Layer to configure (ignored for BASE)
+* @param mode: NORMAL, ADD, MAX or MULTIPLY
+*/
+void setLEDLayerBlendMode(LEDLayer layer, LEDBlendMode mode) {
+    if (!isValidLayer(layer)) {
+        std::cerr << "Error: Invalid layer in setLEDLayerBlendMode()" << std::endl;
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(layer_mutex);
+        layer_modes[(int)layer] = mode;
+    }
+    markLEDBufferDirty();
+}
+
+LEDBlendMode getLEDLayerBlendMode(LEDLayer layer) {
+    if (!isValidLayer(layer)) {
+        return LEDBlendMode::NORMAL;
+    }
+    std::lock_guard<std::mutex> lock(layer_mutex);
+    return layer_modes[(int)layer];
+}
+
+const char* getLEDLayerName(LEDLayer layer) {
+    return isValidLayer(layer) ? LAYER_NAMES[(int)layer] : "INVALID";
+}
+
+// =============================================================================
+// LAYER PAINTING FUNCTIONS
+// =============================================================================
+
+/*
+* Writes levels into a layer and covers those bytes
+* For BASE this is writeLEDBytes().
+*
+* @param layer: Layer to paint
+* @param start_byte: First byte in the LED report (1-80)
+* @param bytes: 7-bit levels to write, levels above 127 are stored as 127
+* @param count: Number of bytes
+* @return: true if the layer was updated, false if the range is invalid
+*/
+bool writeLEDLayerBytes(LEDLayer layer, int start_byte, const uint8_t* bytes, int count) {
+    if (layer == LEDLayer::BASE) {
+        return writeLEDBytes(start_byte, bytes, count);
+    }
+    if (!isValidLayer(layer) || start_byte < 1 || count < 0 || start_byte + count > LED_REPORT_SIZE) {
+        std::cerr << "Error: Invalid layer or byte range in writeLEDLayerBytes()" << std::endl;
+        return false;
+    }
+
+    storeLayerBytes((int)layer, start_byte, bytes, count);
+    markLEDBufferDirty();
+    return true;
+}
+
+/*
+* Sets a matrix button on a layer
+*
+* @param layer: Layer to paint
+* @param row: Matrix row (0-3)
+* @param col: Matrix column (0-3)
+* @param color: Color to set (using LEDColor enum)
+* @param brightness: Brightness level (0.0 = off, 1.0 = full brightness)
+* @return: true if the layer was updated, false if error
+*/
+bool setLayerMatrixButtonLED(LEDLayer layer, int row, int col, LEDColor color, float brightness) {
+    if (layer == LEDLayer::BASE) {
+        return setMatrixButtonLED(row, col, color, brightness);
+    }
+    int byte_position = getMatrixButtonByte(row, col);
+    int color_index = (int)color;
+    if (byte_position < 0 || color_index < 0 || color_index >= LED_COLOR_COUNT) {
+        std::cerr << "Error: Invalid matrix button in setLayerMatrixButtonLED()" << std::endl;
+        return false;
+    }
+    BRGColor value = LED_COLOR_TABLE[color_index][brightnessToLevel(brightness)];
+    const uint8_t bytes[MATRIX_LEDS_PER_BUTTON] = {value.blue, value.red, value.green};
+    return writeLEDLayerBytes(layer, byte_position, bytes, MATRIX_LEDS_PER_BUTTON);
+}
+
+/*
+* Sets a button on a layer
+*
+* @param layer: Layer to paint
+* @param button: Which button (using enum)
+* @param brightness: Brightness level (0.0 = off, 1.0 = full brightness)
+* @return: true if the layer was updated, false if error
+*/
+bool setLayerButtonLED(LEDLayer layer, LEDButton button, float brightness) {
+    if (layer == LEDLayer::BASE) {
+        return setButtonLED(button, brightness);
+    }
+    int byte_position = getButtonByte(button);
+    if (byte_position < 0) {
+        std::cerr << "Error: Invalid button in setLayerButtonLED()" << std::endl;
+        return false;
+    }
+    const uint8_t level = brightnessToLevel(brightness);
+    return writeLEDLayerBytes(layer, byte_position, &level, 1);
+}
+
+/*
+* Sets both LEDs of a stop button on a layer
+*
+* @param layer: Layer to paint
+* @param index: Which stop button (0-3)
+* @param brightness: Brightness level (0.0 = off, 1.0 = full brightness)
+* @return: true if the layer was updated, false if error
+*/
+bool setLayerStopButtonLED(LEDLayer layer, int index, float brightness) {
+    if (layer == LEDLayer::BASE) {
+        return setStopButtonLED(index, brightness);
+    }
+    int left_byte = getStopButtonByte(index);
+    if (left_byte < 0) {
+        std::cerr << "Error: Invalid stop button in setLayerStopButtonLED()" << std::endl;
+        return false;
+    }
+    uint8_t level = brightnessToLevel(brightness);
+    const uint8_t bytes[2] = {level, level};
+    return writeLEDLayerBytes(layer, left_byte - 1, bytes, 2);
+}
+
+// =============================================================================
+// LAYER CLEARING FUNCTIONS - Let the layers below show through again
+// =============================================================================
+
+/*
+* Uncovers bytes of a layer
+* For BASE there is nothing below, the bytes are turned off instead.
+*
+* @param layer: Layer to clear
+* @param start_byte: First byte in the LED report (1-80)
+* @param count: Number of bytes
+* @return: true if the layer was updated, false if the range is invalid
+*/
+bool clearLEDLayerBytes(LEDLayer layer, int start_byte, int count) {
+    if (layer == LEDLayer::BASE) {
+        uint8_t zeros[LED_REPORT_SIZE] = {0};
+        return count >= 0 && count <= LED_REPORT_SIZE && writeLEDBytes(start_byte, zeros, count);
+    }
+    if (!isValidLayer(layer) || start_byte < 1 || count < 0 || start_byte + count > LED_REPORT_SIZE) {
+        std::cerr << "Error: Invalid layer or byte range in clearLEDLayerBytes()" << std::endl;
+        return false;
+    }
+
+    storeLayerBytes((int)layer, start_byte, nullptr, count);
+    markLEDBufferDirty();
+    return true;
+}
+
+bool clearLayerMatrixButtonLED(LEDLayer layer, int row, int col) {
+    int byte_position = getMatrixButtonByte(row, col);
+    return byte_position >= 0 && clearLEDLayerBytes(layer, byte_position, MATRIX_LEDS_PER_BUTTON);
+}
+
+bool clearLayerButtonLED(LEDLayer layer, LEDButton button) {
+    int byte_position = getButtonByte(button);
+    return byte_position >= 0 && clearLEDLayerBytes(layer, byte_position, 1);
+}
+
+bool clearLayerStopButtonLED(LEDLayer layer, int index) {
+    int left_byte = getStopButtonByte(index);
+    return left_byte >= 0 && clearLEDLayerBytes(layer, left_byte - 1, 2);
+}
+
+/*
+* Uncovers a whole layer
+* For BASE this is clearAllLEDs().
+*
+* @param layer: Layer to clear
+*/
+void clearLEDLayer(LEDLayer layer) {
+    if (layer == LEDLayer::BASE) {
+        clearAllLEDs();
+        return;
+    }
+    if (!isValidLayer(layer)) {
+        std::cerr << "Error: Invalid layer in clearLEDLayer()" << std::endl;
+        return;
+    }
+
+    if (isLEDFrameOpen()) {
+        storeLayerBytes((int)layer, 1, nullptr, LED_REPORT_SIZE - 1);
+    } else {
+        std::lock_guard<std::mutex> lock(layer_mutex);
+        memset(layer_masks[(int)layer], 0x00, LED_REPORT_SIZE);
+        layer_used[(int)layer] = false;
+    }
+    markLEDBufferDirty();
+}
+
+// =============================================================================
+// LAYER FRAMES - Merge painted frames, snapshot them for the flush
+// =============================================================================
+
+/*
+* Merges the layer bytes the calling thread painted in its frame
+* Called by the outermost commitLEDFrame(), before the snapshot.
+*
+* @return: true if the frame painted any layer bytes
+*/
+bool mergeLEDLayerFrame() {
+    if (!layer_frame.painted) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(layer_mutex);
+    for (int layer = (int)LEDLayer::BASE + 1; layer < LED_LAYER_COUNT; layer++) {
+        bool merged = false;
+        for (int i = 1; i < LED_REPORT_SIZE; i++) {
+            if (layer_frame.touched[layer][i]) {
+                layer_values[layer][i] = layer_frame.values[layer][i];
+                layer_masks[layer][i] = layer_frame.masks[layer][i];
+                layer_frame.touched[layer][i] = false;
+                merged = true;
+            }
+        }
+        if (merged) {
+            bool used = false;
+            for (int i = 1; i < LED_REPORT_SIZE; i++) {
+                used |= layer_masks[layer][i] != 0;
+            }
+            layer_used[layer] = used;
+        }
+    }
+    layer_frame.painted = false;
+    return true;
+}
+
+/*
+* Copies all layers for the flush, taken when the back buffer is committed
+*
+* @param snapshot: Output, composited by compositeLEDLayers()
+*/
+void snapshotLEDLayers(LEDLayerSnapshot& snapshot) {
+    std::lock_guard<std::mutex> lock(layer_mutex);
+    memcpy(snapshot.values, layer_values, sizeof(layer_values));
+    memcpy(snapshot.masks, layer_masks, sizeof(layer_masks));
+    memcpy(snapshot.used, layer_used, sizeof(layer_used));
+    memcpy(snapshot.opacity, layer_opacity, sizeof(layer_opacity));
+    memcpy(snapshot.modes, layer_modes, sizeof(layer_modes));
+}
+
+// =============================================================================
+// COMPOSITING - Blend the layers into one report at flush time
+// =============================================================================
+
+/*
+* Blends one layer over the frame
+*
+* The loops run over the fixed 80 LED bytes (five 16-byte vectors, the 48
+* matrix bytes are the bulk of them) with 16-bit integer math and no
+* branches, so the compiler vectorizes them even at -O2. Uncovered bytes have
+* alpha 0 and stay unchanged: the mask is 0x00 or 0xFF, so mask & opacity
+* is the byte's alpha.
+*
+* @param frame: Frame composited so far, updated in place
+* @param values: Levels of the layer
+* @param mask: Coverage of the layer
+* @param mode: Blend mode of the layer
+* @param opacity: Opacity of the layer (0-255)
+*/
+static void blendLayer(unsigned char* __restrict__ frame, const unsigned char* __restrict__ values,
+                       const unsigned char* __restrict__ mask, LEDBlendMode mode, uint8_t opacity) {
+    switch (mode) {
+        case LEDBlendMode::NORMAL:
+            for (int i = 1; i < LED_REPORT_SIZE; i++) {
+                uint16_t alpha = mask[i] & opacity;
+                frame[i] = (uint8_t)((frame[i] * (255 - alpha) + values[i] * alpha + 127) / 255);
+            }
+            break;
+        case LEDBlendMode::ADD:
+            for (int i = 1; i < LED_REPORT_SIZE; i++) {
+                uint16_t alpha = mask[i] & opacity;
+                uint16_t sum = frame[i] + (values[i] * alpha + 127) / 255;
+                frame[i] = (uint8_t)(sum < 127 ? sum : 127);
+            }
+            break;
+        case LEDBlendMode::MAX:
+            for (int i = 1; i < LED_REPORT_SIZE; i++) {
+                uint16_t alpha = mask[i] & opacity;
+                uint16_t level = (values[i] * alpha + 127) / 255;
+                frame[i] = (uint8_t)(frame[i] > level ? frame[i] : level);
+            }
+            break;
+        case LEDBlendMode::MULTIPLY:
+            for (int i = 1; i < LED_REPORT_SIZE; i++) {
+                uint16_t alpha = mask[i] & opacity;
+                uint16_t scaled = (frame[i] * values[i] + 63) / 127;
+                frame[i] = (uint8_t)((frame[i] * (255 - alpha) + scaled * alpha + 127) / 255);
+            }
+            break;
+    }
+}
+
+/*
+* Composites all layers into the frame that is encoded and sent
+* Called by the flush with the committed LED buffer as BASE and the layers
+* committed with it.
+*
+* @param layers: Layer snapshot from snapshotLEDLayers()
+* @param base: Linear 81-byte LED buffer (BASE layer)
+* @param frame: Output 81-byte report of linear levels (may not alias base)
+* @param base_fine: Optional BASE levels with fraction bits (see encodeLEDFrame())
+* @param fine: Output for base_fine's composite: BASE's fine levels where no
+*              layer covers them, the composited level elsewhere
+*/
+void compositeLEDLayers(const LEDLayerSnapshot& layers, const unsigned char* base, unsigned char* frame,
+                        const uint16_t* base_fine, uint16_t* fine) {
+    // Step 1: Start from BASE, dimmed by its opacity
+    uint8_t base_opacity = layers.opacity[(int)LEDLayer::BASE];
+    if (base_opacity == 255) {
+        memcpy(frame, base, LED_REPORT_SIZE);
+    } else {
+        for (int i = 0; i < LED_REPORT_SIZE; i++) {
+            frame[i] = (uint8_t)((base[i] * base_opacity + 127) / 255);
+        }
+        frame[0] = base[0];
+    }
+
+    // Step 2: Blend the layers above bottom to top, skipping empty ones
+    for (int layer = (int)LEDLayer::BASE + 1; layer < LED_LAYER_COUNT; layer++) {
+        if (layers.used[layer]) {
+            blendLayer(frame, layers.values[layer], layers.masks[layer], layers.modes[layer], layers.opacity[layer]);
+        }
+    }
+
+    // Step 3: Fine levels follow BASE, covered bytes lose their fraction
+    if (base_fine == nullptr || fine == nullptr) {
+        return;
+    }
+    for (int i = 0; i < LED_REPORT_SIZE; i++) {
+        fine[i] = (uint16_t)((base_fine[i] * base_opacity + 127) / 255);
+    }
+    for (int layer = (int)LEDLayer::BASE + 1; layer < LED_LAYER_COUNT; layer++) {
+        if (layers.used[layer] && layers.opacity[layer] != 0) {
+            for (int i = 1; i < LED_REPORT_SIZE; i++) {
+                if (layers.masks[layer][i] != 0) {
+                    fine[i] = (uint16_t)(frame[i] << LED_DITHER_BITS);
+                }
+            }
+        }
+    }
+}
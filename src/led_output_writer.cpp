@@ -0,0 +1,225 @@
+#include "include/led_output_writer.h"
+
+#include <iostream>             // For std::cout and std::cerr
+#include <cstring>              // For memcpy
+
+// =============================================================================
+// LED OUTPUT WRITER CLASS IMPLEMENTATION
+// =============================================================================
+
+/*
+* Constructor
+*
+* The writer is idle until start() hands it a device.
+*/
+LEDOutputWriter::LEDOutputWriter()
+    : device(nullptr), running(false), frame_interval_ns(0), frames_submitted(0), frames_written(0), dither_frame_rate(0) {
+    setFrameRate(LED_WRITER_DEFAULT_FRAME_RATE);
+}
+
+/*
+* Destructor stops the thread so it never outlives the writer
+*/
+LEDOutputWriter::~LEDOutputWriter() {
+    stop();
+}
+
+/*
+* Starts the writer thread for a device
+* From now on only this thread calls hid_write() for LED reports.
+*
+* @param device: Pointer to the opened HID device
+* @param frame_rate: Maximum reports per second (1-1000)
+* @return: true if the thread is running, false if error
+*/
+bool LEDOutputWriter::start(hid_device* device, int frame_rate) {
+    // Step 1: Check if device is valid
+    if (device == nullptr) {
+        std::cerr << "Error: Device is null in LEDOutputWriter::start()" << std::endl;
+        return false;
+    }
+
+    // Step 2: Only one thread per writer
+    if (running) {
+        return true;
+    }
+
+    // Step 3: Configure and launch the thread
+    this->device = device;
+    setFrameRate(frame_rate);
+    running = true;
+    writer_thread = std::thread(&LEDOutputWriter::writerLoop, this);
+
+    std::cout << "  - LED writer thread started (" << getFrameRate() << " fps max)" << std::endl;
+    return true;
+}
+
+/*
+* Stops the writer thread
+* A frame that is still waiting in the mailbox is sent before the thread exits.
+*/
+void LEDOutputWriter::stop() {
+    if (!running.exchange(false)) {
+        return;
+    }
+    mailbox.wake();
+    if (writer_thread.joinable()) {
+        writer_thread.join();
+    }
+}
+
+bool LEDOutputWriter::isRunning() const {
+    return running;
+}
+
+/*
+* Hands a complete frame to the writer thread
+* Returns immediately, an unsent older frame is replaced by this one.
+*
+* @param frame: Complete 81-byte LED report
+* @param fractions: Optional dither fractions, the frame is then dithered
+*                   at the frame rate until the next submit
+* @param origin_ns: Optional event time the frame shows, its latency is
+*                   recorded once the frame is written (see recordLEDLatency())
+*/
+void LEDOutputWriter::submit(const unsigned char* frame, const unsigned char* fractions, int64_t origin_ns) {
+    frames_submitted++;
+    mailbox.publish(frame, fractions, origin_ns);
+}
+
+/*
+* Runs the writer thread SCHED_FIFO and/or pinned, see realtime_mode.h
+* Applies to the running thread only, a restarted thread is normal again.
+*
+* @param priority: SCHED_FIFO priority, 0 = keep the current policy
+* @param cpu: CPU to pin to, -1 = no pinning
+* @param status: Optional, receives what took effect
+* @return: true if everything requested took effect
+*/
+bool LEDOutputWriter::setRealtime(int priority, int cpu, RealtimeStatus* status) {
+    if (!running) {
+        return false;
+    }
+    return setThreadRealtime(writer_thread.native_handle(), priority, cpu, status);
+}
+
+/*
+* Sets the maximum number of reports per second
+* Values are clamped to 1 - LED_WRITER_MAX_FRAME_RATE (the USB interval).
+*
+* @param frame_rate: Reports per second
+*/
+void LEDOutputWriter::setFrameRate(int frame_rate) {
+    if (frame_rate < 1) frame_rate = 1;
+    if (frame_rate > LED_WRITER_MAX_FRAME_RATE) frame_rate = LED_WRITER_MAX_FRAME_RATE;
+    frame_interval_ns = 1000000000LL / frame_rate;
+}
+
+int LEDOutputWriter::getFrameRate() const {
+    return (int)(1000000000LL / frame_interval_ns);
+}
+
+uint64_t LEDOutputWriter::getFramesSubmitted() const {
+    return frames_submitted;
+}
+
+uint64_t LEDOutputWriter::getFramesWritten() const {
+    return frames_written;
+}
+
+/*
+* Gets the rate dithered frames actually reach the device
+* This is the effective modulation rate: it is limited by the frame rate and
+* by how fast hid_write() returns. 0 while nothing is dithered.
+*
+* @return: Dithered frames per second, measured over the last second
+*/
+int LEDOutputWriter::getDitherFrameRate() const {
+    return dither_frame_rate;
+}
+
+// =============================================================================
+// PRIVATE HELPER FUNCTIONS
+// =============================================================================
+
+/*
+* Writer thread body
+* Sleeps until a frame is published, sends the newest one, then waits out the
+* frame interval so the device never gets more than the configured rate.
+*/
+void LEDOutputWriter::writerLoop() {
+    uint32_t sequence = 0;
+    auto next_frame_time = std::chrono::steady_clock::now();
+
+    // Dithering state: the frame being modulated and its per-LED accumulators
+    LEDFrame dither_frame{};
+    LEDFrame dither_fractions{};
+    LEDFrame accumulators{};
+    bool dithering = false;
+    uint64_t window_frames = 0;
+    auto window_start = next_frame_time;
+
+    while (true) {
+        // Step 1: Sleep until a frame is published (or stop() wakes us)
+        // While dithering there is always a frame to send, so don't sleep here
+        if (!dithering) {
+            sequence = mailbox.waitForPublish(sequence);
+        }
+
+        // Step 2: Respect the frame rate cap
+        if (running) {
+            std::this_thread::sleep_until(next_frame_time);
+        }
+
+        // Step 3: Take the newest frame, anything older was collapsed into it
+        const unsigned char* frame = mailbox.fetch();
+        int64_t origin_ns = 0;
+        if (frame != nullptr) {
+            origin_ns = mailbox.fetchedOrigin();
+            const unsigned char* fractions = mailbox.fetchedFractions();
+            dithering = fractions != nullptr;
+            if (dithering) {
+                memcpy(dither_frame.data(), frame, LED_REPORT_SIZE);
+                memcpy(dither_fractions.data(), fractions, LED_REPORT_SIZE);
+            } else {
+                dither_frame_rate = 0;
+            }
+        }
+
+        // Step 4: Send it - a dithered frame is rendered anew on every interval
+        if (frame != nullptr || dithering) {
+            unsigned char output[LED_REPORT_SIZE];
+            if (dithering) {
+                ditherLEDFrame(dither_frame.data(), dither_fractions.data(), accumulators.data(), output);
+                frame = output;
+            }
+            if (sendLEDFrame(device, frame) == LEDSendResult::SENT) {
+                frames_written++;
+                if (origin_ns != 0) {
+                    recordLEDLatency(origin_ns);
+                }
+            }
+            auto now = std::chrono::steady_clock::now();
+            next_frame_time = now + std::chrono::nanoseconds(frame_interval_ns.load());
+
+            // Measure the effective dither rate once per second
+            if (dithering) {
+                window_frames++;
+                if (now - window_start >= std::chrono::seconds(1)) {
+                    dither_frame_rate = (int)(window_frames / std::chrono::duration<double>(now - window_start).count() + 0.5);
+                    window_frames = 0;
+                    window_start = now;
+                }
+            } else {
+                window_frames = 0;
+                window_start = now;
+            }
+        }
+
+        // Step 5: Exit once stopped and drained
+        if (!running) {
+            break;
+        }
+    }
+    dither_frame_rate = 0;
+}
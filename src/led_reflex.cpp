@@ -0,0 +1,237 @@
+#include "include/led_reflex.h"
+
+#include <iostream>             // For std::cout and std::cerr
+#include "include/led_layers.h"
+
+// =============================================================================
+// LED REFLEX TABLE CLASS IMPLEMENTATION
+// =============================================================================
+
+/*
+* Constructor
+*
+* All reflexes start OFF.
+*/
+LEDReflexTable::LEDReflexTable() {
+    clear();
+    for (int row = 0; row < MATRIX_ROWS; row++) {
+        for (int col = 0; col < MATRIX_COLS; col++) {
+            matrix_lit[row][col] = false;
+        }
+    }
+    for (int i = 0; i < LED_BUTTON_COUNT; i++) {
+        button_lit[i] = false;
+    }
+    for (int i = 0; i < LED_STOP_COUNT; i++) {
+        stop_lit[i] = false;
+    }
+}
+
+/*
+* Packs an entry into one word: mode in bits 16-23, color in 8-15, level in 0-7
+*/
+uint32_t LEDReflexTable::pack(LEDReflex reflex) {
+    uint8_t level = reflex.level > 127 ? 127 : reflex.level;
+    return ((uint32_t)reflex.mode << 16) | ((uint32_t)(uint8_t)reflex.color << 8) | level;
+}
+
+LEDReflex LEDReflexTable::unpack(uint32_t entry) {
+    return {(LEDReflexMode)((entry >> 16) & 0xFF), (LEDColor)((entry >> 8) & 0xFF), (uint8_t)(entry & 0xFF)};
+}
+
+// =============================================================================
+// CONFIGURATION FUNCTIONS
+// =============================================================================
+
+/*
+* Sets the reflex of a matrix button
+*
+* @param row: Matrix row (0-3)
+* @param col: Matrix column (0-3)
+* @param reflex: Mode, color and level while held
+* @return: true if the entry was set, false if the position or color is invalid
+*/
+bool LEDReflexTable::setMatrixReflex(int row, int col, LEDReflex reflex) {
+    int color_index = (int)reflex.color;
+    if (row < 0 || row >= MATRIX_ROWS || col < 0 || col >= MATRIX_COLS ||
+        color_index < 0 || color_index >= LED_COLOR_COUNT) {
+        std::cerr << "Error: Invalid matrix reflex (" << row << "," << col << ")" << std::endl;
+        return false;
+    }
+    matrix_entries[row][col].store(pack(reflex), std::memory_order_release);
+    return true;
+}
+
+/*
+* Sets the reflex of a button (color is ignored, buttons are single color)
+*
+* @param button: Which button (using enum)
+* @param reflex: Mode and level while held
+* @return: true if the entry was set, false if the button is invalid
+*/
+bool LEDReflexTable::setButtonReflex(LEDButton button, LEDReflex reflex) {
+    int index = (int)button;
+    if (index < 0 || index >= LED_BUTTON_COUNT) {
+        std::cerr << "Error: Invalid button reflex" << std::endl;
+        return false;
+    }
+    reflex.color = LEDColor::white;
+    button_entries[index].store(pack(reflex), std::memory_order_release);
+    return true;
+}
+
+/*
+* Sets the reflex of a stop button (both LEDs, color is ignored)
+*
+* @param index: Which stop button (0-3)
+* @param reflex: Mode and level while held
+* @return: true if the entry was set, false if the index is invalid
+*/
+bool LEDReflexTable::setStopReflex(int index, LEDReflex reflex) {
+    if (index < 0 || index >= LED_STOP_COUNT) {
+        std::cerr << "Error: Invalid stop button reflex" << std::endl;
+        return false;
+    }
+    reflex.color = LEDColor::white;
+    stop_entries[index].store(pack(reflex), std::memory_order_release);
+    return true;
+}
+
+/*
+* Turns all reflexes OFF, LEDs that are lit go dark on release
+*/
+void LEDReflexTable::clear() {
+    uint32_t off = pack({LEDReflexMode::OFF, LEDColor::black, 0});
+    for (int row = 0; row < MATRIX_ROWS; row++) {
+        for (int col = 0; col < MATRIX_COLS; col++) {
+            matrix_entries[row][col].store(off, std::memory_order_release);
+        }
+    }
+    for (int i = 0; i < LED_BUTTON_COUNT; i++) {
+        button_entries[i].store(off, std::memory_order_release);
+    }
+    for (int i = 0; i < LED_STOP_COUNT; i++) {
+        stop_entries[i].store(off, std::memory_order_release);
+    }
+}
+
+LEDReflex LEDReflexTable::getMatrixReflex(int row, int col) const {
+    if (row < 0 || row >= MATRIX_ROWS || col < 0 || col >= MATRIX_COLS) {
+        return {LEDReflexMode::OFF, LEDColor::black, 0};
+    }
+    return unpack(matrix_entries[row][col].load(std::memory_order_acquire));
+}
+
+LEDReflex LEDReflexTable::getButtonReflex(LEDButton button) const {
+    int index = (int)button;
+    if (index < 0 || index >= LED_BUTTON_COUNT) {
+        return {LEDReflexMode::OFF, LEDColor::black, 0};
+    }
+    return unpack(button_entries[index].load(std::memory_order_acquire));
+}
+
+LEDReflex LEDReflexTable::getStopReflex(int index) const {
+    if (index < 0 || index >= LED_STOP_COUNT) {
+        return {LEDReflexMode::OFF, LEDColor::black, 0};
+    }
+    return unpack(stop_entries[index].load(std::memory_order_acquire));
+}
+
+// =============================================================================
+// INPUT EDGE FUNCTIONS - Called by the input path on press and release
+// =============================================================================
+
+/*
+* Echoes a matrix button edge on the FEEDBACK layer
+* Press: paints the reflex color (BRIGHTEN: the pad's current color).
+* Release: uncovers the pad, the app's color shows again.
+*
+* @param row: Matrix row (0-3)
+* @param col: Matrix column (0-3)
+* @param pressed: true on press, false on release
+* @return: true if the FEEDBACK layer was changed
+*/
+bool LEDReflexTable::onMatrixButton(int row, int col, bool pressed) {
+    if (row < 0 || row >= MATRIX_ROWS || col < 0 || col >= MATRIX_COLS) {
+        return false;
+    }
+
+    // Step 1: Release uncovers whatever a press lit, even if the entry changed since
+    if (!pressed) {
+        if (!matrix_lit[row][col]) {
+            return false;
+        }
+        matrix_lit[row][col] = false;
+        return clearLayerMatrixButtonLED(LEDLayer::FEEDBACK, row, col);
+    }
+
+    // Step 2: Press paints the entry, if there is one
+    LEDReflex reflex = unpack(matrix_entries[row][col].load(std::memory_order_acquire));
+    if (reflex.mode == LEDReflexMode::OFF) {
+        return false;
+    }
+    LEDColor color = reflex.color;
+    if (reflex.mode == LEDReflexMode::BRIGHTEN) {
+        LEDColor current = getMatrixButtonState(row, col).color;
+        if (current != LEDColor::black) {
+            color = current;
+        }
+    }
+    matrix_lit[row][col] = setLayerMatrixButtonLED(LEDLayer::FEEDBACK, row, col, color, reflex.level / 127.0f);
+    return matrix_lit[row][col];
+}
+
+/*
+* Echoes a button edge on the FEEDBACK layer
+*
+* @param button: Which button (using enum)
+* @param pressed: true on press, false on release
+* @return: true if the FEEDBACK layer was changed
+*/
+bool LEDReflexTable::onButton(LEDButton button, bool pressed) {
+    int index = (int)button;
+    if (index < 0 || index >= LED_BUTTON_COUNT) {
+        return false;
+    }
+    if (!pressed) {
+        if (!button_lit[index]) {
+            return false;
+        }
+        button_lit[index] = false;
+        return clearLayerButtonLED(LEDLayer::FEEDBACK, button);
+    }
+
+    LEDReflex reflex = unpack(button_entries[index].load(std::memory_order_acquire));
+    if (reflex.mode == LEDReflexMode::OFF) {
+        return false;
+    }
+    button_lit[index] = setLayerButtonLED(LEDLayer::FEEDBACK, button, reflex.level / 127.0f);
+    return button_lit[index];
+}
+
+/*
+* Echoes a stop button edge on the FEEDBACK layer
+*
+* @param index: Which stop button (0-3)
+* @param pressed: true on press, false on release
+* @return: true if the FEEDBACK layer was changed
+*/
+bool LEDReflexTable::onStopButton(int index, bool pressed) {
+    if (index < 0 || index >= LED_STOP_COUNT) {
+        return false;
+    }
+    if (!pressed) {
+        if (!stop_lit[index]) {
+            return false;
+        }
+        stop_lit[index] = false;
+        return clearLayerStopButtonLED(LEDLayer::FEEDBACK, index);
+    }
+
+    LEDReflex reflex = unpack(stop_entries[index].load(std::memory_order_acquire));
+    if (reflex.mode == LEDReflexMode::OFF) {
+        return false;
+    }
+    stop_lit[index] = setLayerStopButtonLED(LEDLayer::FEEDBACK, index, reflex.level / 127.0f);
+    return stop_lit[index];
+}
@@ -0,0 +1,285 @@
+#include "include/led_scene_cache.h"
+
+#include <cstring>              // For memset
+#include <iostream>             // For std::cout and std::cerr
+
+// =============================================================================
+// LED SCENE CACHE CLASS IMPLEMENTATION
+// =============================================================================
+
+/*
+* Constructor
+*
+* All pages start dark and no page is active.
+*/
+LEDSceneCache::LEDSceneCache() : active_page(0) {
+    for (int page = LED_SCENE_FIRST_PAGE; page <= LED_SCENE_LAST_PAGE; page++) {
+        clearPage(page);
+    }
+}
+
+/*
+* Returns the scene of a page
+*
+* @param page: Page number (1-99)
+* @return: Pointer to the scene, or nullptr if the page is invalid
+*/
+LEDScene* LEDSceneCache::getScene(int page) {
+    if (page < LED_SCENE_FIRST_PAGE || page > LED_SCENE_LAST_PAGE) {
+        std::cerr << "Error: Invalid scene page " << page << std::endl;
+        return nullptr;
+    }
+    return &scenes[page - LED_SCENE_FIRST_PAGE];
+}
+
+/*
+* Sets a matrix button of a page
+* Encodes the color the same way setMatrixButtonLED() does
+*
+* @param page: Page number (1-99)
+* @param row: Matrix row (0-3)
+* @param col: Matrix column (0-3)
+* @param color: Color to set (using LEDColor enum)
+* @param brightness: Brightness level (0.0 = off, 1.0 = full brightness)
+* @return: true if the scene was updated, false if error
+*/
+bool LEDSceneCache::setMatrixButton(int page, int row, int col, LEDColor color, float brightness) {
+    // Step 1: Validate the position and color
+    int color_index = (int)color;
+    if (row < 0 || row >= MATRIX_ROWS || col < 0 || col >= MATRIX_COLS ||
+        color_index < 0 || color_index >= LED_COLOR_COUNT) {
+        std::cerr << "Error: Invalid matrix button in LEDSceneCache::setMatrixButton()" << std::endl;
+        return false;
+    }
+    if (brightness < 0.0f) brightness = 0.0f;
+    if (brightness > 1.0f) brightness = 1.0f;
+
+    std::lock_guard<std::mutex> lock(scene_mutex);
+    LEDScene* scene = getScene(page);
+    if (scene == nullptr) {
+        return false;
+    }
+
+    // Step 2: Store the encoded BRG bytes and the original state
+    BRGColor value = LED_COLOR_TABLE[color_index][brightnessToLevel(brightness)];
+    int offset = getMatrixButtonByte(row, col) - LED_SCENE_START_BYTE;
+    scene->bytes[offset]     = value.blue;
+    scene->bytes[offset + 1] = value.red;
+    scene->bytes[offset + 2] = value.green;
+    scene->matrix_states[row][col] = {color, brightness};
+
+    // Step 3: The active page is also shown right away
+    if (page == active_page) {
+        setMatrixButtonLED(row, col, color, brightness, true);
+    }
+    return true;
+}
+
+/*
+* Sets a matrix button of a page to any 8-bit BRG color
+* Encodes the color the same way setMatrixButtonLED() does, the state keeps
+* the closest LEDColor (see getNearestColor())
+*
+* @param page: Page number (1-99)
+* @param row: Matrix row (0-3)
+* @param col: Matrix column (0-3)
+* @param color: 8-bit BRG color
+* @param brightness: Brightness level (0.0 = off, 1.0 = full brightness)
+* @return: true if the scene was updated, false if error
+*/
+bool LEDSceneCache::setMatrixButton(int page, int row, int col, BRGColor color, float brightness) {
+    // Step 1: Validate the position
+    if (row < 0 || row >= MATRIX_ROWS || col < 0 || col >= MATRIX_COLS) {
+        std::cerr << "Error: Invalid matrix button in LEDSceneCache::setMatrixButton()" << std::endl;
+        return false;
+    }
+    if (brightness < 0.0f) brightness = 0.0f;
+    if (brightness > 1.0f) brightness = 1.0f;
+
+    std::lock_guard<std::mutex> lock(scene_mutex);
+    LEDScene* scene = getScene(page);
+    if (scene == nullptr) {
+        return false;
+    }
+
+    // Step 2: Store the scaled BRG bytes and the closest original state
+    uint8_t level = brightnessToLevel(brightness);
+    int offset = getMatrixButtonByte(row, col) - LED_SCENE_START_BYTE;
+    scene->bytes[offset]     = LED_SCALE_TABLE[color.blue][level];
+    scene->bytes[offset + 1] = LED_SCALE_TABLE[color.red][level];
+    scene->bytes[offset + 2] = LED_SCALE_TABLE[color.green][level];
+    scene->matrix_states[row][col] = {getNearestColor(color), brightness};
+
+    // Step 3: The active page is also shown right away
+    if (page == active_page) {
+        setMatrixButtonLED(row, col, color, brightness, true);
+    }
+    return true;
+}
+
+/*
+* Sets a button of a page
+*
+* @param page: Page number (1-99)
+* @param button: Which button to set (using enum)
+* @param brightness: Brightness level (0.0 = off, 1.0 = full brightness)
+* @return: true if the scene was updated, false if error
+*/
+bool LEDSceneCache::setButton(int page, LEDButton button, float brightness) {
+    // Step 1: Validate the button
+    int index = (int)button;
+    if (index < 0 || index >= LED_BUTTON_COUNT) {
+        std::cerr << "Error: Invalid button in LEDSceneCache::setButton()" << std::endl;
+        return false;
+    }
+    if (brightness < 0.0f) brightness = 0.0f;
+    if (brightness > 1.0f) brightness = 1.0f;
+
+    std::lock_guard<std::mutex> lock(scene_mutex);
+    LEDScene* scene = getScene(page);
+    if (scene == nullptr) {
+        return false;
+    }
+
+    // Step 2: Store the level and the original state
+    scene->bytes[getButtonByte(button) - LED_SCENE_START_BYTE] = brightnessToLevel(brightness);
+    scene->button_states[index] = {brightness};
+
+    // Step 3: The active page is also shown right away
+    if (page == active_page) {
+        setButtonLED(button, brightness, true);
+    }
+    return true;
+}
+
+/*
+* Sets both LEDs of a stop button of a page
+*
+* @param page: Page number (1-99)
+* @param index: Which stop button to set (0-3)
+* @param brightness: Brightness level (0.0 = off, 1.0 = full brightness)
+* @return: true if the scene was updated, false if error
+*/
+bool LEDSceneCache::setStopButton(int page, int index, float brightness) {
+    // Step 1: Validate the stop button
+    if (index < 0 || index >= LED_STOP_COUNT) {
+        std::cerr << "Error: Invalid stop button in LEDSceneCache::setStopButton()" << std::endl;
+        return false;
+    }
+    if (brightness < 0.0f) brightness = 0.0f;
+    if (brightness > 1.0f) brightness = 1.0f;
+
+    std::lock_guard<std::mutex> lock(scene_mutex);
+    LEDScene* scene = getScene(page);
+    if (scene == nullptr) {
+        return false;
+    }
+
+    // Step 2: Store the level in both LED bytes and the original state
+    uint8_t level = brightnessToLevel(brightness);
+    int left_byte = getStopButtonByte(index);
+    scene->bytes[left_byte - LED_SCENE_START_BYTE] = level;
+    scene->bytes[left_byte - 1 - LED_SCENE_START_BYTE] = level;
+    scene->stop_states[index] = {brightness};
+
+    // Step 3: The active page is also shown right away
+    if (page == active_page) {
+        setStopButtonLED(index, brightness, true);
+    }
+    return true;
+}
+
+/*
+* Turns all button LEDs of a page off
+* Like the other page edits, an active page goes dark right away.
+*
+* @param page: Page number (1-99)
+*/
+void LEDSceneCache::clearPage(int page) {
+    std::lock_guard<std::mutex> lock(scene_mutex);
+    LEDScene* scene = getScene(page);
+    if (scene == nullptr) {
+        return;
+    }
+    memset(scene->bytes, 0, LED_SCENE_SIZE);
+    for (int row = 0; row < MATRIX_ROWS; row++) {
+        for (int col = 0; col < MATRIX_COLS; col++) {
+            scene->matrix_states[row][col] = {LEDColor::black, 0.0f};
+        }
+    }
+    for (int i = 0; i < LED_BUTTON_COUNT; i++) {
+        scene->button_states[i] = {0.0f};
+    }
+    for (int i = 0; i < LED_STOP_COUNT; i++) {
+        scene->stop_states[i] = {0.0f};
+    }
+    if (page == active_page) {
+        showScene(*scene);
+    }
+}
+
+/*
+* Copies the LEDs that are shown back into the active page's scene
+* LEDs are also written without the cache (BRG colors of other callers,
+* MIDI, SysEx, OSC, the daemon). Saving them when the page is left keeps
+* them with the page they were written to. Requires scene_mutex to be held.
+*/
+void LEDSceneCache::saveActivePage() {
+    int page = active_page;
+    if (page == 0) {
+        return;
+    }
+    LEDScene* scene = getScene(page);
+    readLEDBytes(LED_SCENE_START_BYTE, scene->bytes, LED_SCENE_SIZE);
+    saveLEDStates(scene->matrix_states, scene->button_states, scene->stop_states);
+}
+
+/*
+* Writes a scene into the LED buffer as one frame
+* Bytes and states are swapped in together, a flush never sees half a page.
+* Requires scene_mutex to be held.
+*/
+void LEDSceneCache::showScene(const LEDScene& scene) {
+    beginLEDFrame();
+    writeLEDBytes(LED_SCENE_START_BYTE, scene.bytes, LED_SCENE_SIZE);
+    loadLEDStates(scene.matrix_states, scene.button_states, scene.stop_states);
+    commitLEDFrame();
+}
+
+/*
+* Shows a page: copies its scene into the LED buffer as one frame
+* The page that was shown keeps the LEDs it shows now, see saveActivePage().
+* The caller flushes, so changes made with the page switch (e.g. the page
+* number on the display) go out in the same report.
+*
+* @param page: Page number (1-99)
+* @return: true if the page is active now, false if the page is invalid
+*/
+bool LEDSceneCache::activatePage(int page) {
+    std::lock_guard<std::mutex> lock(scene_mutex);
+    LEDScene* scene = getScene(page);
+    if (scene == nullptr) {
+        return false;
+    }
+    saveActivePage();
+    showScene(*scene);
+    active_page = page;
+    return true;
+}
+
+/*
+* Stops showing pages, the LED buffer keeps its current contents
+* The page that was shown keeps them too.
+*/
+void LEDSceneCache::deactivate() {
+    std::lock_guard<std::mutex> lock(scene_mutex);
+    saveActivePage();
+    active_page = 0;
+}
+
+/*
+* Returns the page that is shown (0 = none)
+*/
+int LEDSceneCache::getActivePage() const {
+    return active_page;
+}
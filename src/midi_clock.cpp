@@ -0,0 +1,258 @@
+#include "include/midi_clock.h"
+
+#include <algorithm>            // For std::clamp, std::max
+#include <cmath>                // For std::fabs
+
+// =============================================================================
+// HELPER FUNCTIONS
+// =============================================================================
+
+// Tick periods of the supported tempo range, in nanoseconds
+static const double MIN_PERIOD_NS = 60e9 / (MIDI_CLOCK_MAX_BPM * MIDI_CLOCK_PPQN);
+static const double MAX_PERIOD_NS = 60e9 / (MIDI_CLOCK_MIN_BPM * MIDI_CLOCK_PPQN);
+
+// Weight of a new sample in the smoothed error (1/16)
+static const double ERROR_SMOOTHING = 1.0 / 16.0;
+
+// =============================================================================
+// MIDI CLOCK FOLLOWER CLASS IMPLEMENTATION
+// =============================================================================
+
+/*
+* Constructor
+*
+* The follower starts stopped, without a tempo.
+*/
+MidiClockFollower::MidiClockFollower() {
+    reset();
+}
+
+/*
+* Dispatches a clock related message
+*
+* @param status: Status byte (0xF8, 0xFA, 0xFB, 0xFC or 0xF2)
+* @param data1: First data byte (Song Position LSB)
+* @param data2: Second data byte (Song Position MSB)
+* @param time_ns: Arrival time, from getLEDTimeNs()
+* @return: true if it was a clock message, false if it was ignored
+*/
+bool MidiClockFollower::handleMessage(uint8_t status, uint8_t data1, uint8_t data2, int64_t time_ns) {
+    switch (status) {
+        case MIDI_CLOCK_TICK:
+            onClock(time_ns);
+            return true;
+        case MIDI_CLOCK_START:
+            onStart();
+            return true;
+        case MIDI_CLOCK_CONTINUE:
+            onContinue();
+            return true;
+        case MIDI_CLOCK_STOP:
+            onStop();
+            return true;
+        case MIDI_SONG_POSITION:
+            onSongPosition((data1 & 0x7F) | ((data2 & 0x7F) << 7));
+            return true;
+    }
+    return false;
+}
+
+/*
+* Feeds one clock tick into the PLL
+* Ticks are followed while stopped too, most sources send them all the time,
+* so the tempo is already known when Start arrives.
+*
+* @param time_ns: Arrival time, from getLEDTimeNs()
+*/
+void MidiClockFollower::onClock(int64_t time_ns) {
+    std::lock_guard<std::mutex> lock(clock_mutex);
+    ticks++;
+    if (running) {
+        tick_index++;    // The first tick after Start is tick 0
+    }
+
+    // Step 1: The first two ticks only give a start time and a period
+    if (last_arrival_ns == 0 || period_ns == 0.0) {
+        if (last_arrival_ns != 0) {
+            period_ns = std::clamp((double)(time_ns - last_arrival_ns), MIN_PERIOD_NS, MAX_PERIOD_NS);
+        }
+        tick_time_ns = (double)time_ns;
+        last_arrival_ns = time_ns;
+        locked_ticks = 0;
+        return;
+    }
+
+    // Step 2: Compare the tick with the time the loop predicted for it
+    double predicted_ns = tick_time_ns + period_ns;
+    double error_ns = (double)time_ns - predicted_ns;
+    phase_error_us = error_ns / 1000.0;
+
+    // Step 3: Errors of half a tick are no jitter but a tempo jump or a
+    // dropout, start over from this tick instead of slewing for beats
+    if (std::fabs(error_ns) > period_ns / 2.0) {
+        resync(time_ns, last_arrival_ns);
+        return;
+    }
+
+    // Step 4: Correct phase and period by a fraction of the error
+    tick_time_ns = predicted_ns + MIDI_CLOCK_PHASE_GAIN * error_ns;
+    period_ns = std::clamp(period_ns + MIDI_CLOCK_PERIOD_GAIN * error_ns, MIN_PERIOD_NS, MAX_PERIOD_NS);
+    last_arrival_ns = time_ns;
+
+    // Step 5: Error statistics
+    average_error_us += (std::fabs(phase_error_us) - average_error_us) * ERROR_SMOOTHING;
+    if (locked_ticks < MIDI_CLOCK_LOCK_TICKS) {
+        locked_ticks++;
+    } else {
+        max_error_us = std::max(max_error_us, std::fabs(phase_error_us));
+    }
+}
+
+/*
+* Jumps to the incoming clock: the tick is taken as is and the raw interval
+* becomes the period, unless it is outside the tempo range (a dropout)
+* Requires clock_mutex to be held.
+*
+* @param time_ns: Arrival time of the tick
+* @param arrival_ns: Arrival time of the tick before
+*/
+void MidiClockFollower::resync(int64_t time_ns, int64_t arrival_ns) {
+    double interval_ns = (double)(time_ns - arrival_ns);
+    if (interval_ns >= MIN_PERIOD_NS && interval_ns <= MAX_PERIOD_NS) {
+        period_ns = interval_ns;
+    }
+    tick_time_ns = (double)time_ns;
+    last_arrival_ns = time_ns;
+    locked_ticks = 0;
+    resyncs++;
+}
+
+/*
+* Start: the next tick is beat 0
+*/
+void MidiClockFollower::onStart() {
+    std::lock_guard<std::mutex> lock(clock_mutex);
+    running = true;
+    tick_index = -1;
+}
+
+/*
+* Continue: counting goes on from the position at Stop (or Song Position)
+*/
+void MidiClockFollower::onContinue() {
+    std::lock_guard<std::mutex> lock(clock_mutex);
+    running = true;
+}
+
+/*
+* Stop: the position is kept, the tempo keeps following the ticks
+*/
+void MidiClockFollower::onStop() {
+    std::lock_guard<std::mutex> lock(clock_mutex);
+    running = false;
+}
+
+/*
+* Song Position Pointer: the next tick after Continue is this position
+*
+* @param sixteenths: Position in 16th notes (6 ticks each)
+*/
+void MidiClockFollower::onSongPosition(int sixteenths) {
+    std::lock_guard<std::mutex> lock(clock_mutex);
+    tick_index = (int64_t)sixteenths * MIDI_CLOCK_TICKS_PER_16TH - 1;
+}
+
+/*
+* Forgets tempo, position and statistics
+*/
+void MidiClockFollower::reset() {
+    std::lock_guard<std::mutex> lock(clock_mutex);
+    running = false;
+    last_arrival_ns = 0;
+    tick_time_ns = 0.0;
+    period_ns = 0.0;
+    tick_index = -1;
+    locked_ticks = 0;
+    ticks = 0;
+    resyncs = 0;
+    phase_error_us = 0.0;
+    average_error_us = 0.0;
+    max_error_us = 0.0;
+}
+
+/*
+* Extrapolates the beat position from the last smoothed tick
+* At most one tick is extrapolated, so LEDs hold still instead of running
+* ahead when the ticks stop arriving. Requires clock_mutex to be held.
+*
+* @param time_ns: Point in time, from getLEDTimeNs()
+* @return: Beats since Start, or -1.0 before the first tick
+*/
+double MidiClockFollower::getBeatsLocked(int64_t time_ns) const {
+    if (tick_index < 0) {
+        return -1.0;
+    }
+    double elapsed_ticks = 0.0;
+    if (period_ns > 0.0) {
+        elapsed_ticks = std::clamp(((double)time_ns - tick_time_ns) / period_ns, -1.0, 1.0);
+    }
+    return std::max(0.0, (tick_index + elapsed_ticks) / MIDI_CLOCK_PPQN);
+}
+
+/*
+* Beat position for BEAT LED modes, see LEDBeatClock
+*
+* @param time_ns: Point in time, from getLEDTimeNs()
+* @param beats: Set to the beats since Start
+* @return: true if the clock is running and has ticked since Start
+*/
+bool MidiClockFollower::getBeatPosition(int64_t time_ns, double& beats) {
+    std::lock_guard<std::mutex> lock(clock_mutex);
+    if (!running) {
+        return false;
+    }
+    double position = getBeatsLocked(time_ns);
+    if (position < 0.0) {
+        return false;
+    }
+    beats = position;
+    return true;
+}
+
+bool MidiClockFollower::isRunning() const {
+    std::lock_guard<std::mutex> lock(clock_mutex);
+    return running;
+}
+
+double MidiClockFollower::getBPM() const {
+    std::lock_guard<std::mutex> lock(clock_mutex);
+    return period_ns > 0.0 ? 60e9 / (period_ns * MIDI_CLOCK_PPQN) : 0.0;
+}
+
+/*
+* Returns tempo, position and phase error in one consistent snapshot
+*/
+MidiClockStats MidiClockFollower::getStats() const {
+    int64_t now_ns = getLEDTimeNs();
+    std::lock_guard<std::mutex> lock(clock_mutex);
+    MidiClockStats stats;
+    stats.running = running;
+    stats.locked = period_ns > 0.0 && locked_ticks >= MIDI_CLOCK_LOCK_TICKS;
+    stats.bpm = period_ns > 0.0 ? 60e9 / (period_ns * MIDI_CLOCK_PPQN) : 0.0;
+    stats.beat_position = std::max(0.0, getBeatsLocked(now_ns));
+    stats.ticks = ticks;
+    stats.resyncs = resyncs;
+    stats.phase_error_us = phase_error_us;
+    stats.average_error_us = average_error_us;
+    stats.max_error_us = max_error_us;
+    return stats;
+}
+
+void MidiClockFollower::resetStats() {
+    std::lock_guard<std::mutex> lock(clock_mutex);
+    ticks = 0;
+    resyncs = 0;
+    phase_error_us = 0.0;
+    average_error_us = 0.0;
+    max_error_us = 0.0;
+}
@@ -0,0 +1,125 @@
+#include "include/midi_event_queue.h"
+
+#include <cstring>              // For memcpy
+
+// =============================================================================
+// MIDI EVENT QUEUE CLASS IMPLEMENTATION
+// =============================================================================
+
+/*
+* Constructor
+*
+* The queue starts empty.
+*/
+MidiEventQueue::MidiEventQueue() : head(0), sysex_head(0), tail(0), sysex_tail(0), sequence(0), dropped(0) {
+}
+
+/*
+* Appends an event, never blocks
+*
+* @param event: Event to queue (copied)
+* @return: true if queued, false if the queue was full and the event was dropped
+*/
+bool MidiEventQueue::push(const MidiEvent& event) {
+    // Step 1: Check for room, the consumer may free slots concurrently
+    uint32_t write_index = head.load(std::memory_order_relaxed);
+    if (write_index - tail.load(std::memory_order_acquire) >= (uint32_t)MIDI_EVENT_QUEUE_SIZE) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // Step 2: Fill the slot, then make it visible to the consumer
+    events[write_index & INDEX_MASK] = event;
+    head.store(write_index + 1, std::memory_order_release);
+
+    // Step 3: Wake the consumer
+    sequence.fetch_add(1, std::memory_order_release);
+    sequence.notify_one();
+    return true;
+}
+
+/*
+* Appends a SysEx message, never blocks
+* The bytes are copied into the next payload slot, the slot is queued as an
+* 0xF0 event. Call from the producer thread only.
+*
+* @param bytes: Complete message, F0 to F7
+* @param size: Message length, at most MIDI_SYSEX_MAX_SIZE
+* @param receive_ns: Arrival time
+* @return: true if queued, false if too long or no slot was free (dropped)
+*/
+bool MidiEventQueue::pushSysEx(const uint8_t* bytes, int size, int64_t receive_ns) {
+    // Step 1: Check for a free payload slot
+    uint32_t slot = sysex_head.load(std::memory_order_relaxed);
+    if (size > MIDI_SYSEX_MAX_SIZE ||
+        slot - sysex_tail.load(std::memory_order_acquire) >= (uint32_t)MIDI_SYSEX_SLOT_COUNT) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // Step 2: Fill it, it becomes visible with the event
+    MidiSysExSlot& payload = sysex_slots[slot & SYSEX_MASK];
+    memcpy(payload.bytes, bytes, size);
+    payload.size = size;
+    if (!push({0xF0, 0, 0, receive_ns})) {
+        return false;
+    }
+    sysex_head.store(slot + 1, std::memory_order_relaxed);
+    return true;
+}
+
+/*
+* Takes the oldest event, if there is one
+*
+* @param event: Receives the event
+* @return: true if an event was taken, false if the queue is empty
+*/
+bool MidiEventQueue::pop(MidiEvent& event) {
+    uint32_t read_index = tail.load(std::memory_order_relaxed);
+    if (read_index == head.load(std::memory_order_acquire)) {
+        return false;
+    }
+    event = events[read_index & INDEX_MASK];
+    tail.store(read_index + 1, std::memory_order_release);
+    return true;
+}
+
+/*
+* Gets the payload of the 0xF0 event returned by the last pop()
+* Valid until releaseSysEx()
+*/
+const MidiSysExSlot& MidiEventQueue::sysExPayload() const {
+    return sysex_slots[sysex_tail.load(std::memory_order_relaxed) & SYSEX_MASK];
+}
+
+/*
+* Frees the payload slot of the current 0xF0 event
+* Must be called once for every popped 0xF0 event.
+*/
+void MidiEventQueue::releaseSysEx() {
+    sysex_tail.fetch_add(1, std::memory_order_release);
+}
+
+/*
+* Sleeps until push() or wake() was called after last_sequence
+*
+* @param last_sequence: Sequence value returned by the previous call (start with 0)
+* @return: Current sequence value, pass it to the next call
+*/
+uint32_t MidiEventQueue::waitForPush(uint32_t last_sequence) const {
+    sequence.wait(last_sequence, std::memory_order_acquire);
+    return sequence.load(std::memory_order_acquire);
+}
+
+/*
+* Wakes a consumer sleeping in waitForPush() without queueing an event
+* Used to shut the consumer thread down
+*/
+void MidiEventQueue::wake() {
+    sequence.fetch_add(1, std::memory_order_release);
+    sequence.notify_all();
+}
+
+uint64_t MidiEventQueue::getDropped() const {
+    return dropped;
+}
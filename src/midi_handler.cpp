@@ -0,0 +1,613 @@
+#include "include/midi_handler.h"
+
+#include <iostream>             // For std::cout and std::cerr
+#include <thread>               // For std::this_thread::yield
+
+// =============================================================================
+// CONSTANTS - Note to button mapping
+// =============================================================================
+
+/*
+* Notes 60-64 are the special buttons in the order the input report lists
+* them, notes 65-67 the control buttons
+*/
+const LEDButton MIDI_NOTE_BUTTONS[LED_BUTTON_COUNT] = {
+    LEDButton::SHIFT, LEDButton::REVERSE, LEDButton::TYPE, LEDButton::SIZE, LEDButton::BROWSE,
+    LEDButton::CAPTURE, LEDButton::QUANT, LEDButton::SYNC
+};
+
+// RtMidi backend: ALSA sequencer on Linux, CoreMIDI on macOS
+#ifdef __APPLE__
+static const RtMidi::Api MIDI_API = RtMidi::MACOSX_CORE;
+#else
+static const RtMidi::Api MIDI_API = RtMidi::LINUX_ALSA;
+#endif
+
+// =============================================================================
+// MIDI HANDLER CLASS IMPLEMENTATION
+// =============================================================================
+
+MidiHandler::MidiHandler()
+    : display(nullptr), led_command_hook(nullptr), led_command_user_data(nullptr), running(false), led_thread_running(false), reactor(nullptr), notify_fd(-1),
+      notify_pending(false), notify_users(0), events_received(0), events_applied(0), nrpn_parameter(-1),
+      messages_sent(0), bytes_sent(0) {
+    for (int i = 0; i < MIDI_ANALOG_CONTROL_COUNT; i++) {
+        analog_modes[i] = MidiAnalogMode::CC7;
+        analog_sent_modes[i] = MidiAnalogMode::CC7;
+        analog_raw[i] = -1;
+        analog_values[i] = -1;
+        analog_pending[i] = -1;
+    }
+}
+
+/*
+* Destructor closes the ports and stops the LED thread
+*/
+MidiHandler::~MidiHandler() {
+    cleanup();
+}
+
+/*
+* Opens the virtual ports and starts the MIDI LED thread
+*
+* @param display: Display controller for CC 15-17, nullptr ignores them
+* @param open_ports: false only starts the LED thread, for apps that own
+*                    their MIDI input and forward it with receiveMessage()
+* @return: true if MIDI is running, false if the ports could not be opened
+*/
+bool MidiHandler::initializeMIDI(DisplayController* display, bool open_ports) {
+    if (running) {
+        return true;
+    }
+    this->display = display;
+
+    // Step 1: Open the virtual ports, the callback is set before the input
+    // port opens so no message is missed
+    if (open_ports) {
+        try {
+            midi_out = std::make_unique<RtMidiOut>(MIDI_API, MIDI_CLIENT_NAME);
+            midi_out->openVirtualPort(MIDI_OUT_PORT_NAME);
+
+            midi_in = std::make_unique<RtMidiIn>(MIDI_API, MIDI_CLIENT_NAME);
+            midi_in->ignoreTypes(false, false, true);   // SysEx for LED frames, clock for BEAT modes, no active sensing
+            midi_in->setCallback(&MidiHandler::receiveLEDMIDI, this);
+            midi_in->openVirtualPort(MIDI_IN_PORT_NAME);
+        } catch (RtMidiError& error) {
+            std::cerr << "Error: Unable to open MIDI ports: " << error.getMessage() << std::endl;
+            midi_in.reset();
+            midi_out.reset();
+            return false;
+        }
+    }
+
+    // Step 2: Start draining the queue into the LED buffer
+    running = true;
+    led_thread_running = true;
+    led_thread = std::thread(&MidiHandler::ledLoop, this);
+
+    if (open_ports) {
+        std::cout << "- MIDI ports " << MIDI_OUT_PORT_NAME << " / " << MIDI_IN_PORT_NAME << " opened" << std::endl;
+    }
+    return true;
+}
+
+/*
+* Closes the ports and stops the MIDI LED thread
+* Messages still in the queue are applied before the thread exits.
+*/
+void MidiHandler::cleanup() {
+    // Step 1: No more messages from RtMidi
+    if (midi_in) {
+        midi_in->cancelCallback();
+        midi_in->closePort();
+        midi_in.reset();
+    }
+    if (midi_out) {
+        midi_out->closePort();
+        midi_out.reset();
+    }
+
+    // Step 2: Stop the LED thread or leave the reactor
+    if (!running.exchange(false)) {
+        return;
+    }
+    releaseReactor();
+    stopLEDThread();
+}
+
+/*
+* Drains the queue on a reactor thread instead of the MIDI LED thread
+* Detach before the reactor is closed.
+*
+* @param reactor: Open reactor, its run() thread then applies all MIDI LED messages
+* @return: true if attached, false if MIDI is not running or the reactor is not open
+*/
+bool MidiHandler::attachReactor(EventReactor& reactor) {
+    if (!running || this->reactor != nullptr) {
+        return this->reactor == &reactor;
+    }
+    int fd = reactor.addNotifier(&MidiHandler::onReactorNotify, this);
+    if (fd < 0) {
+        return false;
+    }
+
+    // The thread applies what is queued before it exits, the notifier takes over
+    stopLEDThread();
+    this->reactor = &reactor;
+    notify_pending = false;
+    notify_fd = fd;
+    processLEDMessages();
+    return true;
+}
+
+/*
+* Goes back to the MIDI LED thread
+*/
+void MidiHandler::detachReactor() {
+    if (reactor == nullptr) {
+        return;
+    }
+    releaseReactor();
+    if (running) {
+        led_thread_running = true;
+        led_thread = std::thread(&MidiHandler::ledLoop, this);
+    }
+}
+
+/*
+* Sets the hook called before MIDI and SysEx LED commands are painted
+* Call before initializeMIDI(), the MIDI LED thread reads it unlocked.
+*
+* @param hook: Function to call, nullptr for none
+* @param user_data: Passed to the hook
+*/
+void MidiHandler::setLEDCommandHook(LEDCommandHook hook, void* user_data) {
+    led_command_hook = hook;
+    led_command_user_data = user_data;
+}
+
+bool MidiHandler::isOpen() const {
+    return midi_out != nullptr;
+}
+
+/*
+* Sends a button press or release
+*
+* @param note: Note of the button (see MIDI_NOTE_* constants)
+* @param pressed: true sends Note On with velocity 127, false Note Off
+*/
+void MidiHandler::sendButtonMIDI(int note, bool pressed) {
+    if (note < 0 || note > 127) {
+        std::cerr << "Error: Invalid note in sendButtonMIDI()" << std::endl;
+        return;
+    }
+    sendMessage(pressed ? 0x90 : 0x80, (uint8_t)note, pressed ? 127 : 0);
+}
+
+/*
+* Sends a knob or fader value
+*
+* @param controller: Controller number (see MIDI_CC_* constants)
+* @param value: Value 0-127, clamped
+*/
+void MidiHandler::sendAnalogMIDI(int controller, int value) {
+    if (controller < 0 || controller > 127) {
+        std::cerr << "Error: Invalid controller in sendAnalogMIDI()" << std::endl;
+        return;
+    }
+    if (value < 0) value = 0;
+    if (value > 127) value = 127;
+    sendMessage(0xB0, (uint8_t)controller, (uint8_t)value);
+}
+
+/*
+* Sends one selector wheel step as relative value
+*
+* @param clockwise: true sends 1, false sends 127 (-1)
+*/
+void MidiHandler::sendWheelMIDI(bool clockwise) {
+    sendMessage(0xB0, MIDI_CC_WHEEL, clockwise ? 1 : 127);
+}
+
+/*
+* Sets an analog control's value for this report, flushOutput() sends it in
+* its mode (see MidiAnalogMode). Unchanged values and ADC noise below
+* MIDI_ANALOG_DEADBAND are not sent.
+*
+* @param control: Knob 0-3 = control 0-3, fader 0-3 = control 4-7
+* @param raw_value: Raw 12-bit value (0-4095)
+*/
+void MidiHandler::sendAnalogControl(int control, uint16_t raw_value) {
+    if (control < 0 || control >= MIDI_ANALOG_CONTROL_COUNT) {
+        std::cerr << "Error: Invalid control in sendAnalogControl()" << std::endl;
+        return;
+    }
+    analog_pending[control] = raw_value > 0x0FFF ? 0x0FFF : raw_value;
+}
+
+/*
+* Sends the analog values collected since the last flush
+* ControllerHandler::run() calls this once per input report. Each control
+* sends only its latest value, every message goes out on its own: CoreMIDI
+* rejects longer non-SysEx packets and ALSA cannot parse them.
+*/
+void MidiHandler::flushOutput() {
+    for (int control = 0; control < MIDI_ANALOG_CONTROL_COUNT; control++) {
+        if (analog_pending[control] >= 0) {
+            sendAnalogValue(control, analog_pending[control]);
+            analog_pending[control] = -1;
+        }
+    }
+}
+
+/*
+* Selects how an analog control is sent
+*
+* @param control: Knob 0-3 = control 0-3, fader 0-3 = control 4-7
+* @param mode: CC7, CC14 or NRPN
+*/
+void MidiHandler::setAnalogMode(int control, MidiAnalogMode mode) {
+    if (control < 0 || control >= MIDI_ANALOG_CONTROL_COUNT) {
+        std::cerr << "Error: Invalid control in setAnalogMode()" << std::endl;
+        return;
+    }
+    analog_modes[control] = mode;
+}
+
+MidiAnalogMode MidiHandler::getAnalogMode(int control) const {
+    if (control < 0 || control >= MIDI_ANALOG_CONTROL_COUNT) {
+        return MidiAnalogMode::CC7;
+    }
+    return analog_modes[control];
+}
+
+/*
+* RtMidi callback, runs on RtMidi's thread
+*
+* @param deltatime: Seconds since the previous message (unused)
+* @param message: Complete MIDI message
+* @param user_data: The MidiHandler
+*/
+void MidiHandler::receiveLEDMIDI(double deltatime, std::vector<unsigned char>* message, void* user_data) {
+    (void)deltatime;
+    MidiHandler* handler = static_cast<MidiHandler*>(user_data);
+    if (handler != nullptr && message != nullptr) {
+        handler->receiveMessage(message->data(), message->size());
+    }
+}
+
+/*
+* Queues an incoming channel, SysEx or clock message for the MIDI LED thread
+* Never blocks and never allocates. Only one thread may call this.
+*
+* @param bytes: Complete MIDI message, starting with the status byte
+* @param size: Message length in bytes
+* @return: true if queued, false if ignored or the queue was full
+*/
+bool MidiHandler::receiveMessage(const unsigned char* bytes, size_t size) {
+    // Step 1: LED frames arrive as SysEx, see midi_sysex.h
+    if (bytes != nullptr && size > 0 && bytes[0] == 0xF0) {
+        events_received++;
+        if (!queue.pushSysEx(bytes, (int)size, getLEDTimeNs())) {
+            return false;
+        }
+        notifyReactor();
+        return true;
+    }
+
+    // Step 2: Clock messages are mostly a single byte, they feed the clock follower
+    bool clock_message = bytes != nullptr && size > 0 &&
+        (bytes[0] == MIDI_CLOCK_TICK || bytes[0] == MIDI_CLOCK_START || bytes[0] == MIDI_CLOCK_CONTINUE ||
+         bytes[0] == MIDI_CLOCK_STOP || (bytes[0] == MIDI_SONG_POSITION && size >= 3));
+
+    // Step 3: Otherwise only channel messages (0x80-0xEF) drive LEDs
+    if (!clock_message && (bytes == nullptr || size < 2 || bytes[0] < 0x80 || bytes[0] >= 0xF0)) {
+        return false;
+    }
+
+    // Step 4: Stamp and hand over
+    events_received++;
+    MidiEvent event = {bytes[0], size > 1 ? bytes[1] : (uint8_t)0, size > 2 ? bytes[2] : (uint8_t)0, getLEDTimeNs()};
+    if (!queue.push(event)) {
+        return false;
+    }
+    notifyReactor();
+    return true;
+}
+
+/*
+* Applies all queued messages as one LED frame and flushes it
+* Called by the MIDI LED thread or the reactor. The flush ignores the flush
+* policy, MIDI LED changes always go out right away.
+*
+* @return: Number of messages that changed LEDs
+*/
+int MidiHandler::processLEDMessages() {
+    // Step 1: Paint everything that is waiting into one frame
+    int applied = 0;
+    int64_t origin_ns = 0;
+    MidiEvent event;
+    beginLEDFrame();
+    {
+        std::lock_guard<std::mutex> lock(map_mutex);
+        while (queue.pop(event)) {
+            if (applyLEDMessage(event)) {
+                if (applied == 0) {
+                    origin_ns = event.receive_ns;
+                }
+                applied++;
+            }
+        }
+    }
+    commitLEDFrame();
+
+    // Step 2: One report for all of them, timed from the oldest message
+    if (applied > 0) {
+        events_applied += applied;
+        markLEDFrameOrigin(origin_ns);
+        flushLEDReport();
+    }
+    return applied;
+}
+
+/*
+* Replaces the note/CC mapping with a config file, see midi_led_map.h
+*
+* @param path: Config file
+* @return: true if loaded, false if the file has errors (mapping unchanged)
+*/
+bool MidiHandler::loadLEDMap(const std::string& path) {
+    MidiLEDMap loaded;
+    if (!loaded.loadFile(path)) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(map_mutex);
+    led_map = loaded;
+    return true;
+}
+
+/*
+* Goes back to the protocol from Project-planning
+*/
+void MidiHandler::resetLEDMap() {
+    std::lock_guard<std::mutex> lock(map_mutex);
+    led_map.loadDefaults();
+}
+
+bool MidiHandler::setNoteMapping(int note, const MidiLEDMapping& mapping) {
+    std::lock_guard<std::mutex> lock(map_mutex);
+    return led_map.setNoteMapping(note, mapping);
+}
+
+bool MidiHandler::setControllerMapping(int controller, const MidiLEDMapping& mapping) {
+    std::lock_guard<std::mutex> lock(map_mutex);
+    return led_map.setControllerMapping(controller, mapping);
+}
+
+/*
+* Returns the clock follower, to attach it with setLEDBeatClock()
+*/
+MidiClockFollower* MidiHandler::getClock() {
+    return &clock;
+}
+
+MidiClockStats MidiHandler::getClockStats() const {
+    return clock.getStats();
+}
+
+uint64_t MidiHandler::getEventsReceived() const {
+    return events_received;
+}
+
+uint64_t MidiHandler::getEventsApplied() const {
+    return events_applied;
+}
+
+uint64_t MidiHandler::getEventsDropped() const {
+    return queue.getDropped();
+}
+
+uint64_t MidiHandler::getMessagesSent() const {
+    return messages_sent;
+}
+
+uint64_t MidiHandler::getBytesSent() const {
+    return bytes_sent;
+}
+
+/*
+* Gets the latency from a message arriving to the report that shows it
+*/
+LEDLatencyStats MidiHandler::getLatencyStats() const {
+    return getLEDLatencyStats();
+}
+
+// =============================================================================
+// PRIVATE HELPER FUNCTIONS
+// =============================================================================
+
+/*
+* Applies one message to the LED buffer through the mapping tables
+* Called with map_mutex held
+*
+* @param event: Queued message
+* @return: true if it addressed an LED or the display
+*/
+bool MidiHandler::applyLEDMessage(const MidiEvent& event) {
+    // A SysEx frame replaces many Note On messages with one buffer copy
+    if (event.status == 0xF0) {
+        if (led_command_hook != nullptr) {
+            led_command_hook(led_command_user_data);
+        }
+        const MidiSysExSlot& payload = queue.sysExPayload();
+        bool applied = applyLEDSysEx(payload.bytes, payload.size);
+        queue.releaseSysEx();
+        return applied;
+    }
+    // Clock messages move the beat position, the animation tick paints it
+    if (event.status >= 0xF0) {
+        clock.handleMessage(event.status, event.data1, event.data2, event.receive_ns);
+        return false;
+    }
+    uint8_t type = event.status & 0xF0;
+    if (led_command_hook != nullptr && (type == 0x90 || type == 0x80 || type == 0xB0)) {
+        led_command_hook(led_command_user_data);
+    }
+    switch (type) {
+        case 0x90:
+            return led_map.applyNote(event.data1, event.data2, display);     // Velocity 0 turns off, like Note Off
+        case 0x80:
+            return led_map.applyNote(event.data1, 0, display);
+        case 0xB0:
+            return led_map.applyControlChange(event.data1, event.data2, display);
+    }
+    return false;
+}
+
+/*
+* Sends one control's value in its mode, if it moved past the deadband
+* The MSB is only sent when it changed.
+*
+* @param control: Knob 0-3 = control 0-3, fader 0-3 = control 4-7
+* @param raw_value: 12-bit ADC value
+*/
+void MidiHandler::sendAnalogValue(int control, int raw_value) {
+    // Step 1: A mode change starts over
+    MidiAnalogMode mode = analog_modes[control];
+    if (mode != analog_sent_modes[control]) {
+        analog_sent_modes[control] = mode;
+        analog_raw[control] = -1;
+        analog_values[control] = -1;
+    }
+
+    // Step 2: Skip noise, but always reach both ends
+    int previous = analog_raw[control];
+    int difference = previous > raw_value ? previous - raw_value : raw_value - previous;
+    if (previous >= 0 && difference < MIDI_ANALOG_DEADBAND && raw_value != 0 && raw_value != 0x0FFF) {
+        return;
+    }
+    analog_raw[control] = raw_value;
+
+    // Step 3: Scale to the mode's resolution, skip if the receiver already has it
+    uint8_t controller = control < KNOB_COUNT ? MIDI_CC_KNOB_FIRST + control : MIDI_CC_FADER_FIRST + control - KNOB_COUNT;
+    int value = mode == MidiAnalogMode::CC7 ? raw_value >> 5 : (raw_value * 16383 + 2047) / 4095;
+    int last_value = analog_values[control];
+    if (value == last_value) {
+        return;
+    }
+    analog_values[control] = value;
+    uint8_t msb = (uint8_t)(value >> 7);
+    uint8_t lsb = (uint8_t)(value & 0x7F);
+    bool msb_changed = last_value < 0 || (last_value >> 7) != msb;
+
+    // Step 4: Send
+    switch (mode) {
+        case MidiAnalogMode::CC7:
+            sendMessage(0xB0, controller, (uint8_t)value);
+            break;
+        case MidiAnalogMode::CC14:
+            if (msb_changed) {
+                sendMessage(0xB0, controller, msb);
+            }
+            sendMessage(0xB0, controller + MIDI_CC_LSB_OFFSET, lsb);
+            break;
+        case MidiAnalogMode::NRPN:
+            if (nrpn_parameter != controller) {
+                sendMessage(0xB0, MIDI_CC_NRPN_MSB, 0);
+                sendMessage(0xB0, MIDI_CC_NRPN_LSB, controller);
+                nrpn_parameter = controller;
+                msb_changed = true;     // Data entry MSB belongs to the newly selected parameter
+            }
+            if (msb_changed) {
+                sendMessage(0xB0, MIDI_CC_DATA_ENTRY_MSB, msb);
+            }
+            sendMessage(0xB0, MIDI_CC_DATA_ENTRY_LSB, lsb);
+            break;
+    }
+}
+
+/*
+* Sends a 3-byte message on the output port, if it is open
+* One complete message per call, RtMidi backends do not take running status.
+*/
+void MidiHandler::sendMessage(uint8_t status, uint8_t data1, uint8_t data2) {
+    if (!midi_out) {
+        return;
+    }
+    unsigned char message[3] = {status, data1, data2};
+    try {
+        midi_out->sendMessage(message, sizeof(message));
+        messages_sent++;
+        bytes_sent += sizeof(message);
+    } catch (RtMidiError& error) {
+        std::cerr << "Error: Unable to send MIDI: " << error.getMessage() << std::endl;
+    }
+}
+
+/*
+* MIDI LED thread body
+* Sleeps until the callback queues a message, then applies everything queued
+*/
+void MidiHandler::ledLoop() {
+    uint32_t sequence = 0;
+    while (true) {
+        sequence = queue.waitForPush(sequence);
+        processLEDMessages();
+        if (!led_thread_running) {
+            break;
+        }
+    }
+}
+
+/*
+* Stops the MIDI LED thread, messages still in the queue are applied first
+*/
+void MidiHandler::stopLEDThread() {
+    if (!led_thread_running.exchange(false)) {
+        return;
+    }
+    queue.wake();
+    if (led_thread.joinable()) {
+        led_thread.join();
+    }
+}
+
+/*
+* Removes the notifier once no callback can still be signalling it
+* Applies what was queued meanwhile.
+*/
+void MidiHandler::releaseReactor() {
+    if (reactor == nullptr) {
+        return;
+    }
+    int fd = notify_fd.exchange(-1);
+    while (notify_users.load() != 0) {
+        std::this_thread::yield();
+    }
+    reactor->remove(fd);
+    reactor = nullptr;
+    processLEDMessages();
+}
+
+/*
+* Wakes the reactor after a push (callback thread), at most once per batch
+*/
+void MidiHandler::notifyReactor() {
+    notify_users++;
+    int fd = notify_fd.load();
+    if (fd >= 0 && !notify_pending.exchange(true)) {
+        EventReactor::notify(fd);
+    }
+    notify_users--;
+}
+
+/*
+* Reactor callback: applies everything queued as one frame, like ledLoop()
+*/
+void MidiHandler::onReactorNotify(int fd, uint32_t count, void* user_data) {
+    (void)fd;
+    (void)count;
+    MidiHandler* handler = static_cast<MidiHandler*>(user_data);
+    handler->notify_pending = false;
+    handler->processLEDMessages();
+}
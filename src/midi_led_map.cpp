@@ -0,0 +1,365 @@
+#include "include/midi_led_map.h"
+#include "include/midi_handler.h"   // For the default note and controller numbers
+
+#include <cstdlib>              // For atoi
+#include <fstream>              // For reading config files
+#include <iostream>             // For std::cout and std::cerr
+#include <sstream>              // For splitting config lines
+#include <strings.h>            // For strcasecmp
+
+// =============================================================================
+// CONSTANTS - Names used in config files
+// =============================================================================
+
+static const char* const COLOR_NAMES[LED_COLOR_COUNT] = {
+    "black", "red", "orange", "lightorange", "warmyellow", "yellow", "lime", "green", "mint",
+    "cyan", "turquise", "blue", "plum", "violet", "purple", "magenta", "fuchsia", "white"
+};
+
+static const char* const BUTTON_NAMES[LED_BUTTON_COUNT] = {
+    "CAPTURE", "QUANT", "SYNC", "BROWSE", "SIZE", "TYPE", "REVERSE", "SHIFT"
+};
+
+static int findName(const char* const* names, int count, const char* name) {
+    for (int i = 0; i < count; i++) {
+        if (strcasecmp(names[i], name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int findLEDColorName(const char* name) {
+    return name != nullptr ? findName(COLOR_NAMES, LED_COLOR_COUNT, name) : -1;
+}
+
+int findLEDButtonName(const char* name) {
+    return name != nullptr ? findName(BUTTON_NAMES, LED_BUTTON_COUNT, name) : -1;
+}
+
+// =============================================================================
+// MAPPING BUILDERS - Resolve LED positions to report bytes once
+// =============================================================================
+
+/*
+* Pad whose level follows the value, in a fixed color
+*
+* @param row: Matrix row (0-3)
+* @param col: Matrix column (0-3)
+* @param color: Color at full level
+* @return: Mapping, transform NONE if the position is invalid
+*/
+MidiLEDMapping makeMatrixMapping(int row, int col, LEDColor color) {
+    int byte = getMatrixButtonByte(row, col);
+    if (byte < 0 || (int)color < 0 || (int)color >= LED_COLOR_COUNT) {
+        return {};
+    }
+    return {MidiLEDTransform::COLOR_LEVEL, (uint8_t)byte, MATRIX_LEDS_PER_BUTTON, (uint8_t)color};
+}
+
+/*
+* Pad whose color is selected by the value (LEDColor order, 0 = black)
+*/
+MidiLEDMapping makeMatrixPaletteMapping(int row, int col) {
+    int byte = getMatrixButtonByte(row, col);
+    if (byte < 0) {
+        return {};
+    }
+    return {MidiLEDTransform::PALETTE, (uint8_t)byte, MATRIX_LEDS_PER_BUTTON, 0};
+}
+
+/*
+* Single-color button
+*
+* @param on_off: true switches at value 64 instead of following the value
+*/
+MidiLEDMapping makeButtonMapping(LEDButton button, bool on_off) {
+    int byte = getButtonByte(button);
+    if (byte < 0) {
+        return {};
+    }
+    return {on_off ? MidiLEDTransform::SWITCH : MidiLEDTransform::LEVEL, (uint8_t)byte, 1, 0};
+}
+
+/*
+* Stop button, both of its LEDs
+*
+* @param index: Stop button (0-3)
+* @param on_off: true switches at value 64 instead of following the value
+*/
+MidiLEDMapping makeStopMapping(int index, bool on_off) {
+    int left_byte = getStopButtonByte(index);
+    if (left_byte < 0) {
+        return {};
+    }
+    // The right LED is the byte before the left one
+    return {on_off ? MidiLEDTransform::SWITCH : MidiLEDTransform::LEVEL, (uint8_t)(left_byte - 1), 2, 0};
+}
+
+MidiLEDMapping makeDisplayNumberMapping() {
+    return {MidiLEDTransform::DISPLAY_NUMBER, 0, 0, 0};
+}
+
+/*
+* Display dot
+*
+* @param display: 1 for left, 2 for right
+*/
+MidiLEDMapping makeDisplayDotMapping(int display) {
+    if (display != 1 && display != 2) {
+        return {};
+    }
+    return {MidiLEDTransform::DISPLAY_DOT, 0, 0, (uint8_t)display};
+}
+
+// =============================================================================
+// MIDI LED MAP CLASS IMPLEMENTATION
+// =============================================================================
+
+/*
+* Constructor
+*
+* Starts with the protocol from Project-planning (loadDefaults()).
+*/
+MidiLEDMap::MidiLEDMap() {
+    loadDefaults();
+}
+
+/*
+* Unmaps every note and controller
+*/
+void MidiLEDMap::clear() {
+    for (int i = 0; i < 128; i++) {
+        notes[i] = {};
+        controllers[i] = {};
+    }
+}
+
+/*
+* Maps notes 36-51 to white pads, 60-67 to the buttons, 68-71 to the stop
+* buttons and CC 15-17 to the display
+*/
+void MidiLEDMap::loadDefaults() {
+    clear();
+    for (int pad = 0; pad < MATRIX_ROWS * MATRIX_COLS; pad++) {
+        notes[MIDI_NOTE_MATRIX_FIRST + pad] = makeMatrixMapping(pad / MATRIX_COLS, pad % MATRIX_COLS, LEDColor::white);
+    }
+    for (int i = 0; i < LED_BUTTON_COUNT; i++) {
+        notes[MIDI_NOTE_BUTTON_FIRST + i] = makeButtonMapping(MIDI_NOTE_BUTTONS[i]);
+    }
+    for (int i = 0; i < LED_STOP_COUNT; i++) {
+        notes[MIDI_NOTE_STOP_FIRST + i] = makeStopMapping(i);
+    }
+    controllers[MIDI_CC_DISPLAY_NUMBER] = makeDisplayNumberMapping();
+    controllers[MIDI_CC_DISPLAY_LEFT_DOT] = makeDisplayDotMapping(1);
+    controllers[MIDI_CC_DISPLAY_RIGHT_DOT] = makeDisplayDotMapping(2);
+}
+
+/*
+* Replaces the map with the mappings of a config file
+*
+* @param path: Config file, see the format in midi_led_map.h
+* @return: true if loaded, false if the file is missing or has errors
+*          (the map is unchanged then)
+*/
+bool MidiLEDMap::loadFile(const std::string& path) {
+    // Step 1: Open the file
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "Error: Unable to open MIDI LED map " << path << std::endl;
+        return false;
+    }
+
+    // Step 2: Compile every line into a fresh map
+    MidiLEDMap loaded;
+    loaded.clear();
+    std::string line;
+    int line_number = 0;
+    while (std::getline(file, line)) {
+        line_number++;
+        std::string error;
+        if (!loaded.parseLine(line, error)) {
+            std::cerr << "Error: " << path << ":" << line_number << ": " << error << std::endl;
+            return false;
+        }
+    }
+
+    // Step 3: Take it over as a whole
+    *this = loaded;
+    std::cout << "- MIDI LED map loaded from " << path << std::endl;
+    return true;
+}
+
+/*
+* Compiles one config line into the tables
+*
+* @param line: Config line, empty lines and comments are accepted
+* @param error: Receives the reason if the line is invalid
+* @return: true if the line was valid
+*/
+bool MidiLEDMap::parseLine(const std::string& line, std::string& error) {
+    // Step 1: Split off comments and read the message part
+    std::istringstream words(line.substr(0, line.find('#')));
+    std::string kind, target;
+    int number = -1;
+    if (!(words >> kind)) {
+        return true;    // Empty line or comment
+    }
+    if ((kind != "note" && kind != "cc") || !(words >> number) || number < 0 || number > 127 || !(words >> target)) {
+        error = "expected 'note|cc <0-127> <target> ...'";
+        return false;
+    }
+
+    // Step 2: Resolve the target to report bytes
+    MidiLEDMapping mapping;
+    if (target == "matrix") {
+        int row = 0, col = 0;
+        if (!(words >> row >> col) || row < 1 || row > MATRIX_ROWS || col < 1 || col > MATRIX_COLS) {
+            error = "expected 'matrix <row 1-4> <col 1-4>'";
+            return false;
+        }
+        mapping = makeMatrixMapping(row - 1, col - 1, LEDColor::white);
+        std::string option;
+        while (words >> option) {
+            if (option == "palette") {
+                mapping = makeMatrixPaletteMapping(row - 1, col - 1);
+            } else if (option.rfind("color=", 0) == 0 && findName(COLOR_NAMES, LED_COLOR_COUNT, option.substr(6).c_str()) >= 0) {
+                mapping.param = (uint8_t)findName(COLOR_NAMES, LED_COLOR_COUNT, option.substr(6).c_str());
+            } else {
+                error = "unknown matrix option '" + option + "'";
+                return false;
+            }
+        }
+    } else if (target == "button" || target == "stop") {
+        std::string name, option;
+        words >> name;
+        bool on_off = (words >> option) && option == "switch";
+        if (!option.empty() && !on_off) {
+            error = "unknown option '" + option + "'";
+            return false;
+        }
+        if (target == "button") {
+            int button = findName(BUTTON_NAMES, LED_BUTTON_COUNT, name.c_str());
+            if (button < 0) {
+                error = "unknown button '" + name + "'";
+                return false;
+            }
+            mapping = makeButtonMapping((LEDButton)button, on_off);
+        } else {
+            int index = atoi(name.c_str());
+            if (index < 1 || index > LED_STOP_COUNT) {
+                error = "expected 'stop <1-4>'";
+                return false;
+            }
+            mapping = makeStopMapping(index - 1, on_off);
+        }
+    } else if (target == "display") {
+        std::string part;
+        words >> part;
+        if (part == "number") {
+            mapping = makeDisplayNumberMapping();
+        } else if (part == "left_dot" || part == "right_dot") {
+            mapping = makeDisplayDotMapping(part == "left_dot" ? 1 : 2);
+        } else {
+            error = "expected 'display number|left_dot|right_dot'";
+            return false;
+        }
+    } else {
+        error = "unknown target '" + target + "'";
+        return false;
+    }
+
+    // Step 3: Store it in the table of its message type
+    return kind == "note" ? setNoteMapping(number, mapping) : setControllerMapping(number, mapping);
+}
+
+bool MidiLEDMap::setNoteMapping(int note, const MidiLEDMapping& mapping) {
+    if (note < 0 || note > 127) {
+        std::cerr << "Error: Invalid note in MidiLEDMap::setNoteMapping()" << std::endl;
+        return false;
+    }
+    notes[note] = mapping;
+    return true;
+}
+
+bool MidiLEDMap::setControllerMapping(int controller, const MidiLEDMapping& mapping) {
+    if (controller < 0 || controller > 127) {
+        std::cerr << "Error: Invalid controller in MidiLEDMap::setControllerMapping()" << std::endl;
+        return false;
+    }
+    controllers[controller] = mapping;
+    return true;
+}
+
+MidiLEDMapping MidiLEDMap::getNoteMapping(int note) const {
+    return (note >= 0 && note <= 127) ? notes[note] : MidiLEDMapping{};
+}
+
+MidiLEDMapping MidiLEDMap::getControllerMapping(int controller) const {
+    return (controller >= 0 && controller <= 127) ? controllers[controller] : MidiLEDMapping{};
+}
+
+/*
+* Applies a Note On/Off (Note Off is velocity 0)
+*
+* @return: true if the note is mapped
+*/
+bool MidiLEDMap::applyNote(uint8_t note, uint8_t velocity, DisplayController* display) const {
+    return apply(notes[note & 0x7F], velocity & 0x7F, display);
+}
+
+/*
+* Applies a Control Change
+*
+* @return: true if the controller is mapped
+*/
+bool MidiLEDMap::applyControlChange(uint8_t controller, uint8_t value, DisplayController* display) const {
+    return apply(controllers[controller & 0x7F], value & 0x7F, display);
+}
+
+// =============================================================================
+// PRIVATE HELPER FUNCTIONS
+// =============================================================================
+
+/*
+* Turns the value into report bytes and writes them in one call
+* LED bytes bypass the state storage (like animations), the display goes
+* through the display controller, which keeps track of its dots.
+*/
+bool MidiLEDMap::apply(const MidiLEDMapping& mapping, uint8_t value, DisplayController* display) const {
+    uint8_t bytes[MATRIX_LEDS_PER_BUTTON];
+    switch (mapping.transform) {
+        case MidiLEDTransform::NONE:
+            return false;
+        case MidiLEDTransform::LEVEL:
+        case MidiLEDTransform::SWITCH: {
+            uint8_t level = mapping.transform == MidiLEDTransform::LEVEL ? value : (value >= 64 ? 127 : 0);
+            bytes[0] = bytes[1] = bytes[2] = level;
+            return writeLEDBytes(mapping.byte, bytes, mapping.count);
+        }
+        case MidiLEDTransform::COLOR_LEVEL:
+        case MidiLEDTransform::PALETTE: {
+            const BRGColor& color = mapping.transform == MidiLEDTransform::COLOR_LEVEL
+                ? LED_COLOR_TABLE[mapping.param][value]
+                : LED_COLOR_TABLE[value % LED_COLOR_COUNT][LED_BRIGHTNESS_LEVELS - 1];
+            bytes[0] = color.blue;
+            bytes[1] = color.red;
+            bytes[2] = color.green;
+            return writeLEDBytes(mapping.byte, bytes, MATRIX_LEDS_PER_BUTTON);
+        }
+        case MidiLEDTransform::DISPLAY_NUMBER:
+            if (display == nullptr) {
+                return false;
+            }
+            // Cached frame, values above 99 show 99 instead of starting a scroll
+            display->setDisplayFrame(DISPLAY_NUMBER_FRAMES[value > 99 ? 99 : value]);
+            return true;
+        case MidiLEDTransform::DISPLAY_DOT:
+            if (display == nullptr) {
+                return false;
+            }
+            display->setDisplayDot(mapping.param, value >= 64);
+            return true;
+    }
+    return false;
+}
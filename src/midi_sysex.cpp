@@ -0,0 +1,84 @@
+#include "include/midi_sysex.h"
+
+#include <iostream>             // For std::cout and std::cerr
+
+// =============================================================================
+// LED FRAME SYSEX FUNCTIONS
+// =============================================================================
+
+/*
+* Applies a full or partial LED frame message to the LED buffer
+* The message is validated completely before the first byte is written, so
+* a broken message never leaves half a frame behind. The caller paints
+* inside beginLEDFrame()/commitLEDFrame() and flushes once.
+*
+* @param message: Complete SysEx message, F0 to F7
+* @param size: Message length
+* @return: true if applied, false if it is no valid LED frame message
+*/
+bool applyLEDSysEx(const uint8_t* message, int size) {
+    // Step 1: Check the header and the end marker
+    if (message == nullptr || size < LED_SYSEX_HEADER_SIZE + 1 || message[0] != 0xF0 || message[size - 1] != 0xF7 ||
+        message[1] != LED_SYSEX_MANUFACTURER || message[2] != LED_SYSEX_DEVICE[0] || message[3] != LED_SYSEX_DEVICE[1]) {
+        return false;
+    }
+    const uint8_t* data = message + LED_SYSEX_HEADER_SIZE;
+    int data_size = size - LED_SYSEX_HEADER_SIZE - 1;
+
+    // Step 2: Full frame - one copy of report bytes 1-80
+    if (message[4] == LED_SYSEX_FULL_FRAME) {
+        if (data_size != LED_REPORT_SIZE - 1) {
+            std::cerr << "Error: Full LED frame SysEx needs " << LED_REPORT_SIZE - 1 << " bytes, got " << data_size << std::endl;
+            return false;
+        }
+        return writeLEDBytes(1, data, data_size);
+    }
+    if (message[4] != LED_SYSEX_PARTIAL_FRAME) {
+        return false;
+    }
+
+    // Step 3: Partial frame - check all runs first
+    int position = 0;
+    while (position < data_size) {
+        if (position + 2 > data_size) {
+            std::cerr << "Error: Truncated run in LED frame SysEx" << std::endl;
+            return false;
+        }
+        int start = data[position];
+        int count = data[position + 1];
+        if (start < 1 || start + count > LED_REPORT_SIZE || position + 2 + count > data_size) {
+            std::cerr << "Error: Invalid run in LED frame SysEx (start " << start << ", count " << count << ")" << std::endl;
+            return false;
+        }
+        position += 2 + count;
+    }
+
+    // Step 4: Write the runs
+    position = 0;
+    while (position < data_size) {
+        int count = data[position + 1];
+        writeLEDBytes(data[position], data + position + 2, count);
+        position += 2 + count;
+    }
+    return true;
+}
+
+/*
+* Builds a full frame message, e.g. for a lighting desk or for testing
+*
+* @param report: Complete 81-byte LED report (byte 0 is skipped)
+* @param message: Receives LED_SYSEX_FULL_SIZE bytes
+* @return: Message size
+*/
+int encodeLEDSysExFrame(const unsigned char* report, uint8_t* message) {
+    message[0] = 0xF0;
+    message[1] = LED_SYSEX_MANUFACTURER;
+    message[2] = LED_SYSEX_DEVICE[0];
+    message[3] = LED_SYSEX_DEVICE[1];
+    message[4] = LED_SYSEX_FULL_FRAME;
+    for (int i = 1; i < LED_REPORT_SIZE; i++) {
+        message[LED_SYSEX_HEADER_SIZE + i - 1] = report[i] & 0x7F;
+    }
+    message[LED_SYSEX_FULL_SIZE - 1] = 0xF7;
+    return LED_SYSEX_FULL_SIZE;
+}
@@ -0,0 +1,332 @@
+#include "include/osc_codec.h"
+
+#include <chrono>               // For the time tag
+#include <cmath>                // For std::isfinite
+#include <cstring>              // For memcpy, strlen, memchr
+
+// =============================================================================
+// HELPER FUNCTIONS - Big-endian numbers and padded strings
+// =============================================================================
+
+// Seconds from 1900 (NTP epoch) to 1970 (Unix epoch)
+static const uint64_t NTP_UNIX_OFFSET = 2208988800ULL;
+
+static uint32_t readUInt32(const uint8_t* data) {
+    return ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | data[3];
+}
+
+// Float argument to int, clamped: the cast is undefined outside the int32 range
+static int32_t floatToInt32(float value) {
+    if (value >= 2147483648.0f) return INT32_MAX;
+    if (value <= -2147483648.0f) return INT32_MIN;
+    return (int32_t)value;
+}
+
+static int paddedSize(int size) {
+    return (size + 3) & ~3;
+}
+
+/*
+* Reads a null-terminated, 4-byte padded string
+*
+* @param data: Start of the string
+* @param size: Bytes left in the packet
+* @return: Bytes used incl. padding, or -1 if the string is not terminated
+*/
+static int readPaddedString(const uint8_t* data, int size) {
+    const void* end = memchr(data, '\0', size);
+    if (end == nullptr) {
+        return -1;
+    }
+    int used = paddedSize((int)((const uint8_t*)end - data) + 1);
+    return used <= size ? used : -1;
+}
+
+// =============================================================================
+// OSC WRITER CLASS IMPLEMENTATION
+// =============================================================================
+
+/*
+* Constructor
+*
+* @param buffer: Output buffer, owned by the caller
+* @param capacity: Size of the buffer in bytes
+*/
+OSCWriter::OSCWriter(uint8_t* buffer, int capacity) : buffer(buffer), capacity(capacity) {
+    reset();
+}
+
+/*
+* Empties the buffer, the next message starts a new packet
+*/
+void OSCWriter::reset() {
+    size = 0;
+    message_start = -1;
+    message_count = 0;
+    in_bundle = false;
+    overflow = false;
+}
+
+void OSCWriter::writeBytes(const void* bytes, int count) {
+    if (overflow || size + count > capacity) {
+        overflow = true;
+        return;
+    }
+    memcpy(buffer + size, bytes, count);
+    size += count;
+}
+
+void OSCWriter::writePadded(const char* text) {
+    static const uint8_t zeros[4] = {0, 0, 0, 0};
+    int length = (int)strlen(text);
+    writeBytes(text, length);
+    writeBytes(zeros, paddedSize(length + 1) - length);
+}
+
+void OSCWriter::writeUInt32(uint32_t value) {
+    uint8_t bytes[4] = {(uint8_t)(value >> 24), (uint8_t)(value >> 16), (uint8_t)(value >> 8), (uint8_t)value};
+    writeBytes(bytes, 4);
+}
+
+/*
+* Starts a bundle, all following messages go into it
+* Call on an empty writer.
+*
+* @param timetag: OSC time tag of the bundle, see getOSCTimeTag()
+*/
+void OSCWriter::beginBundle(uint64_t timetag) {
+    reset();
+    writeBytes(OSC_BUNDLE_TAG, sizeof(OSC_BUNDLE_TAG));
+    writeUInt32((uint32_t)(timetag >> 32));
+    writeUInt32((uint32_t)timetag);
+    in_bundle = true;
+}
+
+/*
+* Starts a message
+*
+* @param address: OSC address, e.g. "/f1/knob"
+* @param typetags: Type tags without the ',' (e.g. "if"), one add*() call each
+* @return: false if a message is already open
+*/
+bool OSCWriter::beginMessage(const char* address, const char* typetags) {
+    if (message_start >= 0) {
+        return false;
+    }
+    message_start = size;
+    overflow = false;
+    if (in_bundle) {
+        writeUInt32(0);     // Element size, filled in by endMessage()
+    }
+    writePadded(address);
+
+    // Type tag string: ',' + tags, padded
+    static const uint8_t zeros[4] = {0, 0, 0, 0};
+    int length = (int)strlen(typetags) + 1;
+    writeBytes(",", 1);
+    writeBytes(typetags, length - 1);
+    writeBytes(zeros, paddedSize(length + 1) - length);
+    return true;
+}
+
+void OSCWriter::addInt(int32_t value) {
+    writeUInt32((uint32_t)value);
+}
+
+void OSCWriter::addFloat(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    writeUInt32(bits);
+}
+
+void OSCWriter::addString(const char* value) {
+    writePadded(value);
+}
+
+/*
+* Closes the open message
+*
+* @return: true if it fits, false if it was taken out again
+*/
+bool OSCWriter::endMessage() {
+    if (message_start < 0) {
+        return false;
+    }
+    bool fits = !overflow;
+    if (!fits) {
+        size = message_start;
+    } else {
+        if (in_bundle) {
+            uint32_t element_size = (uint32_t)(size - message_start - 4);
+            uint8_t bytes[4] = {(uint8_t)(element_size >> 24), (uint8_t)(element_size >> 16), (uint8_t)(element_size >> 8), (uint8_t)element_size};
+            memcpy(buffer + message_start, bytes, 4);
+        }
+        message_count++;
+    }
+    message_start = -1;
+    overflow = false;
+    return fits;
+}
+
+const uint8_t* OSCWriter::getData() const {
+    return buffer;
+}
+
+int OSCWriter::getSize() const {
+    return size;
+}
+
+int OSCWriter::getMessageCount() const {
+    return message_count;
+}
+
+// =============================================================================
+// OSC PARSER FUNCTIONS
+// =============================================================================
+
+/*
+* Parses one message into a caller-provided OSCMessage
+*
+* @return: true if the message is well-formed and its types are supported
+*/
+static bool parseOSCMessage(const uint8_t* data, int size, uint64_t timetag, OSCMessage& message) {
+    // Step 1: Address and type tags
+    int used = readPaddedString(data, size);
+    if (used < 0 || data[0] != '/') {
+        return false;
+    }
+    message.address = (const char*)data;
+    int position = used;
+    if (position >= size || data[position] != ',') {
+        return false;
+    }
+    used = readPaddedString(data + position, size - position);
+    if (used < 0) {
+        return false;
+    }
+    message.typetags = (const char*)data + position + 1;
+    position += used;
+    message.timetag = timetag;
+
+    // Step 2: Arguments, numbers are converted both ways for convenience
+    message.argument_count = 0;
+    for (const char* tag = message.typetags; *tag != '\0'; tag++) {
+        if (message.argument_count >= OSC_MAX_ARGUMENTS) {
+            return false;
+        }
+        OSCArgument& argument = message.arguments[message.argument_count++];
+        argument = {*tag, 0, 0.0f, nullptr};
+        switch (*tag) {
+            case 'i':
+            case 'f': {
+                if (position + 4 > size) {
+                    return false;
+                }
+                uint32_t bits = readUInt32(data + position);
+                position += 4;
+                if (*tag == 'i') {
+                    argument.int_value = (int32_t)bits;
+                    argument.float_value = (float)argument.int_value;
+                } else {
+                    memcpy(&argument.float_value, &bits, sizeof(bits));
+                    if (!std::isfinite(argument.float_value)) {
+                        return false;   // NaN and infinity are no valid index or level
+                    }
+                    argument.int_value = floatToInt32(argument.float_value);
+                }
+                break;
+            }
+            case 's':
+                used = readPaddedString(data + position, size - position);
+                if (used < 0) {
+                    return false;
+                }
+                argument.string_value = (const char*)data + position;
+                position += used;
+                break;
+            case 'T':
+            case 'F':
+                argument.int_value = *tag == 'T' ? 1 : 0;
+                argument.float_value = (float)argument.int_value;
+                break;
+            default:
+                return false;      // Blobs, doubles etc. are not used by the F1
+        }
+    }
+    return true;
+}
+
+/*
+* Parses a message or a bundle, recursing into nested bundles
+*
+* @return: Number of messages, or -1 if malformed
+*/
+static int parseOSCElement(const uint8_t* data, int size, uint64_t timetag, int depth,
+                           OSCMessageCallback callback, void* user_data) {
+    // Step 1: A single message
+    if (size < 4 || size % 4 != 0) {
+        return -1;
+    }
+    if (data[0] == '/') {
+        OSCMessage message;
+        if (!parseOSCMessage(data, size, timetag, message)) {
+            return -1;
+        }
+        callback(message, user_data);
+        return 1;
+    }
+
+    // Step 2: A bundle - time tag, then size-prefixed elements
+    if (depth >= OSC_MAX_BUNDLE_DEPTH || size < 16 || memcmp(data, OSC_BUNDLE_TAG, sizeof(OSC_BUNDLE_TAG)) != 0) {
+        return -1;
+    }
+    uint64_t bundle_timetag = ((uint64_t)readUInt32(data + 8) << 32) | readUInt32(data + 12);
+    int count = 0;
+    int position = 16;
+    while (position < size) {
+        if (position + 4 > size) {
+            return -1;
+        }
+        int element_size = (int)readUInt32(data + position);
+        position += 4;
+        if (element_size <= 0 || element_size > size - position) {
+            return -1;
+        }
+        int parsed = parseOSCElement(data + position, element_size, bundle_timetag, depth + 1, callback, user_data);
+        if (parsed < 0) {
+            return -1;
+        }
+        count += parsed;
+        position += element_size;
+    }
+    return count;
+}
+
+/*
+* Parses a received datagram in place, nothing is copied or allocated
+* The strings in the messages point into data. Messages before a malformed
+* part of a bundle have already been passed to the callback.
+*
+* @param data: Datagram
+* @param size: Datagram length
+* @param callback: Called once per message
+* @param user_data: Passed to the callback
+* @return: Number of messages, or -1 if the packet is malformed
+*/
+int parseOSCPacket(const uint8_t* data, int size, OSCMessageCallback callback, void* user_data) {
+    if (data == nullptr || callback == nullptr) {
+        return -1;
+    }
+    return parseOSCElement(data, size, OSC_TIMETAG_IMMEDIATE, 0, callback, user_data);
+}
+
+/*
+* Returns the current wall clock time as an OSC time tag
+*/
+uint64_t getOSCTimeTag() {
+    auto since_epoch = std::chrono::system_clock::now().time_since_epoch();
+    uint64_t nanoseconds = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(since_epoch).count();
+    uint64_t seconds = nanoseconds / 1000000000ULL;
+    uint64_t fraction = ((nanoseconds % 1000000000ULL) << 32) / 1000000000ULL;
+    return ((seconds + NTP_UNIX_OFFSET) << 32) | fraction;
+}
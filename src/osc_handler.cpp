@@ -0,0 +1,451 @@
+#include "include/osc_handler.h"
+#include "include/midi_led_map.h"   // For findLEDColorName() and findLEDButtonName()
+
+#include <arpa/inet.h>          // For inet_pton, htons
+#include <cerrno>               // For errno
+#include <cstring>              // For strcmp, strlen, strerror
+#include <fcntl.h>              // For fcntl
+#include <iostream>             // For std::cout and std::cerr
+#include <poll.h>               // For poll
+#include <sys/socket.h>         // For socket, bind, sendto, recv
+#include <unistd.h>             // For close, pipe, write
+
+// =============================================================================
+// HELPER FUNCTIONS
+// =============================================================================
+
+static bool isNumber(const OSCArgument& argument) {
+    return argument.type == 'i' || argument.type == 'f' || argument.type == 'T' || argument.type == 'F';
+}
+
+// 0.0 - 1.0 to an 8-bit color value
+static uint8_t toColorValue(const OSCArgument& argument) {
+    float value = argument.float_value;
+    if (value < 0.0f) value = 0.0f;
+    if (value > 1.0f) value = 1.0f;
+    return (uint8_t)(value * 255.0f + 0.5f);
+}
+
+static bool makeLocalAddress(int port, sockaddr_in& address) {
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons((uint16_t)port);
+    return port > 0 && port <= 65535 && inet_pton(AF_INET, OSC_HOST, &address.sin_addr) == 1;
+}
+
+// =============================================================================
+// OSC HANDLER CLASS IMPLEMENTATION
+// =============================================================================
+
+OSCHandler::OSCHandler()
+    : socket_fd(-1), wake_pipe{-1, -1}, display(nullptr), led_command_hook(nullptr), led_command_user_data(nullptr), running(false), reactor(nullptr),
+      writer(output_buffer, OSC_MAX_PACKET_SIZE), report_timetag(OSC_TIMETAG_IMMEDIATE), applied_in_packet(0),
+      messages_sent(0), bundles_sent(0), messages_received(0), messages_applied(0), packets_rejected(0) {
+    memset(&send_address, 0, sizeof(send_address));
+    for (int i = 0; i < OSC_ANALOG_CONTROL_COUNT; i++) {
+        analog_raw[i] = -1;
+    }
+}
+
+OSCHandler::~OSCHandler() {
+    cleanup();
+}
+
+/*
+* Opens the UDP endpoint on localhost and starts the receive thread
+*
+* @param listen_port: Port OSC messages for the LEDs are received on
+* @param send_port: Port controller events are sent to
+* @param display: Display controller for /f1/display messages, may be null
+* @return: true if OSC is running, false if the socket could not be opened
+*/
+bool OSCHandler::initializeOSC(int listen_port, int send_port, DisplayController* display) {
+    if (running) {
+        return true;
+    }
+    this->display = display;
+
+    // Step 1: Resolve both addresses
+    sockaddr_in listen_address;
+    if (!makeLocalAddress(listen_port, listen_address) || !makeLocalAddress(send_port, send_address)) {
+        std::cerr << "Error: Invalid OSC port " << listen_port << " / " << send_port << std::endl;
+        return false;
+    }
+
+    // Step 2: One socket receives and sends, sends never block the input thread
+    socket_fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (socket_fd < 0 || bind(socket_fd, (const sockaddr*)&listen_address, sizeof(listen_address)) != 0 ||
+        fcntl(socket_fd, F_SETFL, fcntl(socket_fd, F_GETFL) | O_NONBLOCK) != 0 || pipe(wake_pipe) != 0 ||
+        fcntl(wake_pipe[0], F_SETFL, O_NONBLOCK) != 0) {
+        std::cerr << "Error: Unable to open OSC port " << listen_port << ": " << strerror(errno) << std::endl;
+        cleanup();
+        return false;
+    }
+
+    // Step 3: Start applying datagrams to the LEDs
+    running = true;
+    receive_thread = std::thread(&OSCHandler::receiveLoop, this);
+    std::cout << "- OSC on " << OSC_HOST << " port " << listen_port << ", sending to port " << send_port << std::endl;
+    return true;
+}
+
+/*
+* Stops the receive thread and closes the socket
+*/
+void OSCHandler::cleanup() {
+    // Step 1: Leave the reactor, join the receive thread
+    running = false;
+    if (reactor != nullptr) {
+        reactor->remove(socket_fd);
+        reactor = nullptr;
+    }
+    stopReceiveThread();
+
+    // Step 2: Close all descriptors
+    for (int* fd : {&socket_fd, &wake_pipe[0], &wake_pipe[1]}) {
+        if (*fd >= 0) {
+            close(*fd);
+            *fd = -1;
+        }
+    }
+    writer.reset();
+}
+
+/*
+* Sets the hook called before /f1/led messages are painted
+* Call before initializeOSC(), the receiving thread reads it unlocked.
+*
+* @param hook: Function to call, nullptr for none
+* @param user_data: Passed to the hook
+*/
+void OSCHandler::setLEDCommandHook(LEDCommandHook hook, void* user_data) {
+    led_command_hook = hook;
+    led_command_user_data = user_data;
+}
+
+bool OSCHandler::isOpen() const {
+    return socket_fd >= 0;
+}
+
+/*
+* Receives on a reactor thread instead of the receive thread
+* Detach before the reactor is closed.
+*
+* @param reactor: Open reactor, its run() thread then applies all OSC LED messages
+* @return: true if attached, false if OSC is not running or the reactor is not open
+*/
+bool OSCHandler::attachReactor(EventReactor& reactor) {
+    if (!running || this->reactor != nullptr) {
+        return this->reactor == &reactor;
+    }
+    stopReceiveThread();
+    if (!reactor.addReader(socket_fd, &OSCHandler::onReactorReadable, this)) {
+        receive_thread = std::thread(&OSCHandler::receiveLoop, this);
+        return false;
+    }
+    this->reactor = &reactor;
+    receivePending();
+    return true;
+}
+
+/*
+* Goes back to the receive thread
+*/
+void OSCHandler::detachReactor() {
+    if (reactor == nullptr) {
+        return;
+    }
+    reactor->remove(socket_fd);
+    reactor = nullptr;
+    if (running) {
+        receive_thread = std::thread(&OSCHandler::receiveLoop, this);
+    }
+}
+
+/*
+* Starts the bundle of a new input report, time tagged with the current time
+* Call once per report before the send*() calls.
+*/
+void OSCHandler::beginReport() {
+    report_timetag = getOSCTimeTag();
+}
+
+/*
+* Adds one event to the bundle of the current report
+* A full bundle is sent and the event goes into the next one.
+*
+* @param address: OSC address
+* @param typetags: Type tags, one argument each
+* @param arguments: Values, in the order of the type tags
+*/
+void OSCHandler::sendEvent(const char* address, const char* typetags, const OSCArgument* arguments) {
+    if (socket_fd < 0) {
+        return;
+    }
+    for (int attempt = 0; attempt < 2; attempt++) {
+        if (writer.getSize() == 0) {
+            writer.beginBundle(report_timetag);
+        }
+        writer.beginMessage(address, typetags);
+        for (int i = 0; typetags[i] != '\0'; i++) {
+            switch (typetags[i]) {
+                case 'i': writer.addInt(arguments[i].int_value); break;
+                case 'f': writer.addFloat(arguments[i].float_value); break;
+                case 's': writer.addString(arguments[i].string_value); break;
+            }
+        }
+        if (writer.endMessage()) {
+            messages_sent++;
+            return;
+        }
+        flushOutput();
+    }
+}
+
+void OSCHandler::sendMatrixButton(int row, int col, bool pressed) {
+    OSCArgument arguments[3] = {{'i', row, 0.0f, nullptr}, {'i', col, 0.0f, nullptr}, {'i', pressed ? 1 : 0, 0.0f, nullptr}};
+    sendEvent("/f1/matrix", "iii", arguments);
+}
+
+void OSCHandler::sendButton(const char* name, bool pressed) {
+    OSCArgument arguments[2] = {{'s', 0, 0.0f, name}, {'i', pressed ? 1 : 0, 0.0f, nullptr}};
+    sendEvent("/f1/button", "si", arguments);
+}
+
+void OSCHandler::sendStopButton(int index, bool pressed) {
+    OSCArgument arguments[2] = {{'i', index, 0.0f, nullptr}, {'i', pressed ? 1 : 0, 0.0f, nullptr}};
+    sendEvent("/f1/stop", "ii", arguments);
+}
+
+/*
+* Sends a knob or fader with its full 12-bit resolution as 0.0 - 1.0
+* Call once per input report for every control, unchanged values and ADC
+* noise below OSC_ANALOG_DEADBAND are not sent.
+*
+* @param control: Knob 0-3 = control 0-3, fader 0-3 = control 4-7
+* @param raw_value: Raw 12-bit value (0-4095)
+*/
+void OSCHandler::sendAnalogControl(int control, uint16_t raw_value) {
+    if (control < 0 || control >= OSC_ANALOG_CONTROL_COUNT) {
+        std::cerr << "Error: Invalid control in OSCHandler::sendAnalogControl()" << std::endl;
+        return;
+    }
+    if (raw_value > 0x0FFF) raw_value = 0x0FFF;
+
+    // Skip noise, but always reach both ends
+    int previous = analog_raw[control];
+    int difference = previous > raw_value ? previous - raw_value : raw_value - previous;
+    if (previous >= 0 && (difference == 0 || (difference < OSC_ANALOG_DEADBAND && raw_value != 0 && raw_value != 0x0FFF))) {
+        return;
+    }
+    analog_raw[control] = raw_value;
+
+    bool knob = control < OSC_ANALOG_CONTROL_COUNT / 2;
+    int index = knob ? control : control - OSC_ANALOG_CONTROL_COUNT / 2;
+    OSCArgument arguments[2] = {{'i', index, 0.0f, nullptr}, {'f', 0, raw_value / 4095.0f, nullptr}};
+    sendEvent(knob ? "/f1/knob" : "/f1/fader", "if", arguments);
+}
+
+void OSCHandler::sendWheel(bool clockwise) {
+    OSCArgument arguments[1] = {{'i', clockwise ? 1 : -1, 0.0f, nullptr}};
+    sendEvent("/f1/wheel", "i", arguments);
+}
+
+/*
+* Sends the events of the current report as one datagram
+* ControllerHandler::run() calls this once per input report.
+*/
+void OSCHandler::flushOutput() {
+    if (writer.getMessageCount() > 0 && socket_fd >= 0) {
+        if (sendto(socket_fd, writer.getData(), writer.getSize(), 0, (const sockaddr*)&send_address, sizeof(send_address)) ==
+            (ssize_t)writer.getSize()) {
+            bundles_sent++;
+        }
+    }
+    writer.reset();
+}
+
+/*
+* Applies a datagram as one LED frame and flushes it
+* Called by the receive thread, or directly with a datagram the app received.
+*
+* @param data: Datagram, an OSC message or bundle
+* @param size: Datagram length
+* @return: Number of messages that changed LEDs
+*/
+int OSCHandler::receivePacket(const uint8_t* data, int size) {
+    // Step 1: Paint all messages into one frame
+    int64_t receive_ns = getLEDTimeNs();
+    applied_in_packet = 0;
+    beginLEDFrame();
+    int parsed = parseOSCPacket(data, size, &OSCHandler::onMessage, this);
+    commitLEDFrame();
+    if (parsed < 0) {
+        packets_rejected++;
+        std::cerr << "Error: Malformed OSC packet (" << size << " bytes)" << std::endl;
+    }
+
+    // Step 2: One report for all of them
+    if (applied_in_packet > 0) {
+        messages_applied += applied_in_packet;
+        markLEDFrameOrigin(receive_ns);
+        flushLEDReport();
+    }
+    return applied_in_packet;
+}
+
+void OSCHandler::onMessage(const OSCMessage& message, void* user_data) {
+    OSCHandler* handler = static_cast<OSCHandler*>(user_data);
+    handler->messages_received++;
+    if (handler->applyMessage(message)) {
+        handler->applied_in_packet++;
+    }
+}
+
+/*
+* Applies one message to the LED buffer (no flush)
+* Unknown addresses are ignored, OSC senders often broadcast more than the
+* receiver understands.
+*
+* @return: true if LEDs were changed
+*/
+bool OSCHandler::applyMessage(const OSCMessage& message) {
+    const OSCArgument* arguments = message.arguments;
+    int count = message.argument_count;
+    if (led_command_hook != nullptr && strncmp(message.address, "/f1/led/", 8) == 0) {
+        led_command_hook(led_command_user_data);
+    }
+
+    // Matrix pads: named color and brightness, or red/green/blue
+    if (strcmp(message.address, "/f1/led/matrix") == 0) {
+        if (count >= 3 && isNumber(arguments[0]) && isNumber(arguments[1])) {
+            int row = arguments[0].int_value;
+            int col = arguments[1].int_value;
+            if (arguments[2].type == 's') {
+                int color = findLEDColorName(arguments[2].string_value);
+                if (color >= 0) {
+                    float brightness = count >= 4 && isNumber(arguments[3]) ? arguments[3].float_value : 1.0f;
+                    return setMatrixButtonLED(row, col, (LEDColor)color, brightness, true);
+                }
+            } else if (count >= 5 && isNumber(arguments[2]) && isNumber(arguments[3]) && isNumber(arguments[4])) {
+                BRGColor color = {toColorValue(arguments[4]), toColorValue(arguments[2]), toColorValue(arguments[3])};
+                return setMatrixButtonLED(row, col, color, 1.0f, false);
+            }
+        }
+    } else if (strcmp(message.address, "/f1/led/button") == 0) {
+        if (count >= 2 && isNumber(arguments[1])) {
+            int button = arguments[0].type == 's' ? findLEDButtonName(arguments[0].string_value) : arguments[0].int_value;
+            if (button >= 0 && button < LED_BUTTON_COUNT) {
+                return setButtonLED((LEDButton)button, arguments[1].float_value);
+            }
+        }
+    } else if (strcmp(message.address, "/f1/led/stop") == 0) {
+        if (count >= 2 && isNumber(arguments[0]) && isNumber(arguments[1])) {
+            return setStopButtonLED(arguments[0].int_value, arguments[1].float_value);
+        }
+    } else if (strncmp(message.address, "/f1/display/", 12) == 0) {
+        // Displays: value, text and dots
+        const char* target = message.address + 12;
+        if (display == nullptr) {
+            return false;
+        }
+        if (strcmp(target, "number") == 0 && count >= 1 && isNumber(arguments[0])) {
+            display->setDisplayValue(arguments[0].int_value);
+            return true;
+        }
+        if (strcmp(target, "text") == 0 && count >= 1 && arguments[0].type == 's') {
+            const char* text = arguments[0].string_value;
+            size_t length = strlen(text);
+            if (length <= 2) {
+                display->setDisplayText(length == 2 ? text[0] : ' ', length >= 1 ? text[length - 1] : ' ');
+            } else {
+                display->scrollDisplayText(text);
+            }
+            return true;
+        }
+        if (strcmp(target, "dot") == 0 && count >= 2 && isNumber(arguments[0]) && isNumber(arguments[1]) &&
+            (arguments[0].int_value == 1 || arguments[0].int_value == 2)) {
+            display->setDisplayDot(arguments[0].int_value, arguments[1].int_value != 0);
+            return true;
+        }
+    } else {
+        return false;
+    }
+    std::cerr << "Error: Invalid arguments for OSC " << message.address << " ," << message.typetags << std::endl;
+    return false;
+}
+
+/*
+* Receive thread: waits for datagrams or the wake pipe
+*/
+void OSCHandler::receiveLoop() {
+    pollfd fds[2] = {{socket_fd, POLLIN, 0}, {wake_pipe[0], POLLIN, 0}};
+    while (running) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "Error: OSC poll failed: " << strerror(errno) << std::endl;
+            break;
+        }
+        if (fds[1].revents != 0) {
+            break;
+        }
+        receivePending();
+    }
+}
+
+/*
+* Applies everything that arrived, one frame per datagram
+*/
+void OSCHandler::receivePending() {
+    while (true) {
+        ssize_t size = recv(socket_fd, input_buffer, sizeof(input_buffer), 0);
+        if (size <= 0) {
+            break;
+        }
+        receivePacket(input_buffer, (int)size);
+    }
+}
+
+/*
+* Wakes and joins the receive thread, the wake pipe is emptied for a restart
+*/
+void OSCHandler::stopReceiveThread() {
+    if (!receive_thread.joinable()) {
+        return;
+    }
+    char wake = 1;
+    if (write(wake_pipe[1], &wake, 1) < 0) {
+        std::cerr << "Error: Unable to wake the OSC thread" << std::endl;
+    }
+    receive_thread.join();
+    while (read(wake_pipe[0], &wake, 1) > 0) {
+    }
+}
+
+void OSCHandler::onReactorReadable(int fd, uint32_t events, void* user_data) {
+    (void)fd;
+    (void)events;
+    static_cast<OSCHandler*>(user_data)->receivePending();
+}
+
+uint64_t OSCHandler::getMessagesSent() const {
+    return messages_sent;
+}
+
+uint64_t OSCHandler::getBundlesSent() const {
+    return bundles_sent;
+}
+
+uint64_t OSCHandler::getMessagesReceived() const {
+    return messages_received;
+}
+
+uint64_t OSCHandler::getMessagesApplied() const {
+    return messages_applied;
+}
+
+uint64_t OSCHandler::getPacketsRejected() const {
+    return packets_rejected;
+}
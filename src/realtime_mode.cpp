@@ -0,0 +1,170 @@
+#include "include/realtime_mode.h"
+
+#include <alloca.h>             // For alloca
+#include <cerrno>               // For errno, ENOTSUP
+#include <cstdlib>              // For malloc, free
+#include <cstring>              // For strerror
+#include <iostream>             // For std::cout and std::cerr
+#include <sched.h>              // For sched_param, SCHED_FIFO
+#include <sys/mman.h>           // For mlockall
+
+#ifdef __GLIBC__
+#include <malloc.h>             // For mallopt
+#endif
+
+// =============================================================================
+// HELPER FUNCTIONS
+// =============================================================================
+
+/*
+* Touches stack pages below the caller so later calls do not fault them in
+* Not inlined, the block must live in its own frame. Keep size_kb well
+* below the thread's stack size.
+*/
+__attribute__((noinline)) static void prefaultStack(int size_kb) {
+    size_t size = (size_t)size_kb * 1024;
+    volatile unsigned char* stack = static_cast<volatile unsigned char*>(alloca(size));
+    for (size_t i = 0; i < size; i += 4096) {
+        stack[i] = 0;
+    }
+}
+
+/*
+* Maps and touches heap memory, then keeps it in malloc's pool
+* With trimming and mmap off, later allocations reuse these (locked) pages
+* instead of asking the kernel. On failure malloc gets glibc's defaults
+* back. glibc only.
+*/
+static bool prefaultHeap(int size_kb) {
+#ifdef __GLIBC__
+    size_t size = (size_t)size_kb * 1024;
+    unsigned char* block = nullptr;
+    if (mallopt(M_TRIM_THRESHOLD, -1) == 0 || mallopt(M_MMAP_MAX, 0) == 0 ||
+        (block = static_cast<unsigned char*>(malloc(size))) == nullptr) {
+        mallopt(M_TRIM_THRESHOLD, 128 * 1024);  // glibc defaults
+        mallopt(M_MMAP_MAX, 65536);
+        return false;
+    }
+    for (size_t i = 0; i < size; i += 4096) {
+        ((volatile unsigned char*)block)[i] = 0;
+    }
+    free(block);
+    return true;
+#else
+    (void)size_kb;
+    return false;
+#endif
+}
+
+// =============================================================================
+// REALTIME FUNCTIONS
+// =============================================================================
+
+/*
+* Sets SCHED_FIFO and CPU pinning for a thread
+* Each setting is tried on its own, one failing leaves the thread as it was
+* for that setting.
+*
+* @param thread: Thread to change
+* @param priority: SCHED_FIFO priority (1-99), 0 = keep the current policy
+* @param cpu: CPU to pin to, -1 = no pinning
+* @param status: Optional, receives what took effect
+* @return: true if everything requested took effect
+*/
+bool setThreadRealtime(pthread_t thread, int priority, int cpu, RealtimeStatus* status) {
+    RealtimeStatus result = {};
+    result.priority = priority;
+    result.cpu = cpu;
+
+    // Step 1: Scheduling, needs CAP_SYS_NICE or an RLIMIT_RTPRIO >= priority
+    if (priority > 0) {
+        sched_param param = {};
+        int min_priority = sched_get_priority_min(SCHED_FIFO);
+        int max_priority = sched_get_priority_max(SCHED_FIFO);
+        param.sched_priority = priority < min_priority ? min_priority : (priority > max_priority ? max_priority : priority);
+        result.priority = param.sched_priority;
+        result.scheduling_error = pthread_setschedparam(thread, SCHED_FIFO, &param);
+        result.scheduling = result.scheduling_error == 0;
+    }
+
+    // Step 2: Affinity, Linux only
+    if (cpu >= 0) {
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        result.affinity_error = pthread_setaffinity_np(thread, sizeof(set), &set);
+        result.affinity = result.affinity_error == 0;
+#else
+        result.affinity_error = ENOTSUP;
+#endif
+    }
+
+    if (status != nullptr) {
+        *status = result;
+    }
+    return (priority <= 0 || result.scheduling) && (cpu < 0 || result.affinity);
+}
+
+/*
+* Makes the calling thread real-time and keeps its memory resident
+* Without privileges the failing settings are skipped and reported, the
+* thread keeps running as before for those.
+*
+* @param config: Settings to apply
+* @return: What took effect
+*/
+RealtimeStatus enableRealtimeThread(const RealtimeConfig& config) {
+    RealtimeStatus status;
+    setThreadRealtime(pthread_self(), config.priority, config.cpu, &status);
+
+    // Step 1: Lock everything mapped now and later, needs CAP_IPC_LOCK or a
+    // large enough RLIMIT_MEMLOCK
+    if (config.lock_memory) {
+#ifdef __linux__
+        if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0) {
+            status.memory_locked = true;
+        } else {
+            status.memory_error = errno;
+        }
+#else
+        status.memory_error = ENOTSUP;
+#endif
+    }
+
+    // Step 2: Heap only once it is locked (MCL_FUTURE locks the new pages),
+    // an unlocked pool could be paged out and malloc would be left with
+    // trimming and mmap off for nothing
+    if (config.heap_prefault_kb > 0 && status.memory_locked) {
+        status.heap_prefaulted = prefaultHeap(config.heap_prefault_kb);
+    }
+
+    // Step 3: Stack last, its pages are then locked as they are touched
+    if (config.stack_prefault_kb > 0) {
+        prefaultStack(config.stack_prefault_kb);
+        status.stack_prefaulted = true;
+    }
+    return status;
+}
+
+/*
+* Prints one line per requested setting
+*/
+void printRealtimeStatus(const char* thread_name, const RealtimeStatus& status) {
+    std::cout << "- Real-time mode for the " << thread_name << " thread:" << std::endl;
+    if (status.scheduling || status.scheduling_error != 0) {
+        std::cout << "  - SCHED_FIFO priority " << status.priority << ": "
+                  << (status.scheduling ? "on" : strerror(status.scheduling_error)) << std::endl;
+    }
+    if (status.affinity || status.affinity_error != 0) {
+        std::cout << "  - Pinned to CPU " << status.cpu << ": "
+                  << (status.affinity ? "on" : strerror(status.affinity_error)) << std::endl;
+    }
+    if (status.memory_locked || status.memory_error != 0) {
+        std::cout << "  - Memory locked: " << (status.memory_locked ? "on" : strerror(status.memory_error)) << std::endl;
+    }
+    if (status.stack_prefaulted || status.heap_prefaulted) {
+        std::cout << "  - Prefaulted: " << (status.stack_prefaulted ? "stack " : "")
+                  << (status.heap_prefaulted ? "heap" : "") << std::endl;
+    }
+}
@@ -2,198 +2,127 @@
 #include "include/led_controller_base.h"         // Include LED controller header file
 
 #include <iostream>      // iostream gives std::cout
-#include <unistd.h>      // unistd.h gives usleep() — sleep for microseconds
-#include <cstring>       // cstring gives memset() — memory manipulation
+#include <algorithm>            // For std::max
 #include <thread>               // For std::this_thread::sleep_for (modern C++ sleep)
 #include <chrono>               // For std::chrono::milliseconds
 // #include <hidapi/hidapi.h>   // included already in header
 
 
 // =============================================================================
-// START UP SEQUENCE
+// START UP SEQUENCE DATA
 // =============================================================================
 
 /*
-* Runs a LED wave animation on the F1 matrix buttons
-* Creates a diagonal wave pattern that spreads across the 4x4 matrix
-* 
-* @param device: Pointer to the opened HID device
+* LED wave animation on the F1 matrix buttons, as keyframes
+* Creates a diagonal wave pattern that spreads across the 4x4 matrix:
+* the pattern moves from bottom-right to top-left in diagonal waves, each
+* diagonal first lights dim (64), then full (127), then fades out.
+*
+* {step, target, color, level} - one step every STARTUP_STEP_MS
 */
+static const LEDKeyframe STARTUP_KEYFRAMES[] = {
+    // First diagonal: corner (3,3) fades in
+    {0, matrixTarget(3, 3), LEDColor::green, 64},
+    {1, matrixTarget(3, 3), LEDColor::green, 127},
 
-void startupSequence(hid_device* device) {
-    
-    // Step 1: Check if device is valid
-    if (device == nullptr) {
-        std::cerr << "Error: Invalid device handle for startup sequence" << std::endl;
-        return;
-    }
-    
-    // Step 1,: Animation timing configuration
-    const int step_delay_ms = 50;  // 50ms between each animation step
-    
-    // Step 2: Start the animation
-    std::cout << "  - Running startup LED sequence..." << std::endl;
-    
-    // Animation creates a diagonal wave pattern:
-    // The pattern moves from bottom-right to top-left in diagonal waves
-    // Each step lights up LEDs along diagonal lines, creating a wave effect
-    
-    // =============================================================================
-    // ANIMATION STEP 1-1,: First diagonal
-    // =============================================================================
-    
-    // Step 1: Start with single LED at (3,4) - dim green
-    setMatrixButtonLED(3, 3, LEDColor::green, 0.5f, false);
-    std::this_thread::sleep_for(std::chrono::milliseconds(step_delay_ms));
-    
-    // Step 1,:
-    setMatrixButtonLED(3, 3, LEDColor::green, 1.0f, false);
-    std::this_thread::sleep_for(std::chrono::milliseconds(step_delay_ms));
-    
-    // =============================================================================
-    // ANIMATION STEP 2-4: Second diagonal
-    // =============================================================================
-    
-    // Step 2:
-    setMatrixButtonLED(2, 3, LEDColor::green, 0.5f, false);
-    setMatrixButtonLED(3, 2, LEDColor::green, 0.5f, false);
-    std::this_thread::sleep_for(std::chrono::milliseconds(step_delay_ms));
-    
-    // Step 4:
-    setMatrixButtonLED(2, 3, LEDColor::green, 1.0f, false);
-    setMatrixButtonLED(3, 2, LEDColor::green, 1.0f, false);
-    std::this_thread::sleep_for(std::chrono::milliseconds(step_delay_ms));
-    
-    // =============================================================================
-    // ANIMATION STEP 5-6: Third diagonal
-    // =============================================================================
-    
-    // Step 5:
-    setMatrixButtonLED(3, 3, LEDColor::green, 0.5f, false);  // Fade corner
-    setMatrixButtonLED(1, 3, LEDColor::green, 0.5f, false);  // New LEDs dim
-    setMatrixButtonLED(2, 2, LEDColor::green, 0.5f, false);
-    setMatrixButtonLED(3, 1, LEDColor::green, 0.5f, false);
-    std::this_thread::sleep_for(std::chrono::milliseconds(step_delay_ms));
-    
-    // Step 6:
-    setMatrixButtonLED(3, 3, LEDColor::black, 0.0f, false); // Turn off
-    setMatrixButtonLED(1, 3, LEDColor::green, 1.0f, false);
-    setMatrixButtonLED(2, 2, LEDColor::green, 1.0f, false);
-    setMatrixButtonLED(3, 1, LEDColor::green, 1.0f, false);
-    std::this_thread::sleep_for(std::chrono::milliseconds(step_delay_ms));
-    
-    // =============================================================================
-    // ANIMATION STEP 7-8: Fourth diagonal (main diagonal)
-    // =============================================================================
-    
-    // Step 7:
-    setMatrixButtonLED(2, 3, LEDColor::green, 0.5f, false);  // Fade second diagonal
-    setMatrixButtonLED(3, 2, LEDColor::green, 0.5f, false);
-    setMatrixButtonLED(0, 3, LEDColor::green, 0.5f, false);  // New main diagonal dim
-    setMatrixButtonLED(1, 2, LEDColor::green, 0.5f, false);
-    setMatrixButtonLED(2, 1, LEDColor::green, 0.5f, false);
-    setMatrixButtonLED(3, 0, LEDColor::green, 0.5f, false);
-    std::this_thread::sleep_for(std::chrono::milliseconds(step_delay_ms));
-    
-    // Step 8:
-    setMatrixButtonLED(2, 3, LEDColor::black, 0.0f, false);
-    setMatrixButtonLED(3, 2, LEDColor::black, 0.0f, false);
-    setMatrixButtonLED(0, 3, LEDColor::green, 1.0f, false);
-    setMatrixButtonLED(1, 2, LEDColor::green, 1.0f, false);
-    setMatrixButtonLED(2, 1, LEDColor::green, 1.0f, false);
-    setMatrixButtonLED(3, 0, LEDColor::green, 1.0f, false);
-    std::this_thread::sleep_for(std::chrono::milliseconds(step_delay_ms));
-    
-    // =============================================================================
-    // ANIMATION STEP 9-10: Fifth diagonal
-    // =============================================================================
-    
-    // Step 9:
-    setMatrixButtonLED(1, 3, LEDColor::green, 0.5f, false);  // Fade third diagonal
-    setMatrixButtonLED(2, 2, LEDColor::green, 0.5f, false);
-    setMatrixButtonLED(3, 1, LEDColor::green, 0.5f, false);
-    setMatrixButtonLED(0, 2, LEDColor::green, 0.5f, false);  // New fifth diagonal dim
-    setMatrixButtonLED(1, 1, LEDColor::green, 0.5f, false);
-    setMatrixButtonLED(2, 0, LEDColor::green, 0.5f, false);
-    std::this_thread::sleep_for(std::chrono::milliseconds(step_delay_ms));
-    
-    // Step 10:
-    setMatrixButtonLED(1, 3, LEDColor::black, 0.0f, false);  // Turn off third diagonal
-    setMatrixButtonLED(2, 2, LEDColor::black, 0.0f, false);
-    setMatrixButtonLED(3, 1, LEDColor::black, 0.0f, false);
-    setMatrixButtonLED(0, 2, LEDColor::green, 1.0f, false);
-    setMatrixButtonLED(1, 1, LEDColor::green, 1.0f, false);
-    setMatrixButtonLED(2, 0, LEDColor::green, 1.0f, false);
-    std::this_thread::sleep_for(std::chrono::milliseconds(step_delay_ms));
-    
-    // =============================================================================
-    // ANIMATION STEP 11-11,: Sixth diagonal
-    // =============================================================================
-    
-    // Step 11:
-    setMatrixButtonLED(0, 3, LEDColor::green, 0.5f, false);  // Fade main diagonal
-    setMatrixButtonLED(1, 2, LEDColor::green, 0.5f, false);
-    setMatrixButtonLED(2, 1, LEDColor::green, 0.5f, false);
-    setMatrixButtonLED(3, 0, LEDColor::green, 0.5f, false);
-    setMatrixButtonLED(0, 1, LEDColor::green, 0.5f, false);  // New sixth diagonal dim
-    setMatrixButtonLED(1, 0, LEDColor::green, 0.5f, false);
-    std::this_thread::sleep_for(std::chrono::milliseconds(step_delay_ms));
-    
-    // Step 11,:
-    setMatrixButtonLED(0, 3, LEDColor::black, 0.0f, false);
-    setMatrixButtonLED(1, 2, LEDColor::black, 0.0f, false);
-    setMatrixButtonLED(2, 1, LEDColor::black, 0.0f, false);
-    setMatrixButtonLED(3, 0, LEDColor::black, 0.0f, false);
-    setMatrixButtonLED(0, 1, LEDColor::green, 1.0f, false);
-    setMatrixButtonLED(1, 0, LEDColor::green, 1.0f, false);
-    std::this_thread::sleep_for(std::chrono::milliseconds(step_delay_ms));
-    
-    // =============================================================================
-    // ANIMATION STEP 12-14: Seventh diagonal (top-left corner)
-    // =============================================================================
-    
-    // Step 12:
-    setMatrixButtonLED(0, 2, LEDColor::green, 0.5f, false);  // Fade fifth diagonal
-    setMatrixButtonLED(1, 1, LEDColor::green, 0.5f, false);
-    setMatrixButtonLED(2, 0, LEDColor::green, 0.5f, false);
-    setMatrixButtonLED(0, 0, LEDColor::green, 0.5f, false);  // Final corner dim
-    std::this_thread::sleep_for(std::chrono::milliseconds(step_delay_ms));
-    
-    // Step 14:
-    setMatrixButtonLED(0, 2, LEDColor::black, 0.0f, false);
-    setMatrixButtonLED(1, 1, LEDColor::black, 0.0f, false);
-    setMatrixButtonLED(2, 0, LEDColor::black, 0.0f, false);
-    setMatrixButtonLED(0, 0, LEDColor::green, 1.0f, false);
-    std::this_thread::sleep_for(std::chrono::milliseconds(step_delay_ms));
-    
-    // =============================================================================
-    // ANIMATION STEP 15-18: Wave fade out
-    // =============================================================================
-    
-    // Step 15:
-    setMatrixButtonLED(0, 1, LEDColor::green, 0.5f, false);
-    setMatrixButtonLED(1, 0, LEDColor::green, 0.5f, false);
-    std::this_thread::sleep_for(std::chrono::milliseconds(step_delay_ms));
-    
-    // Step 16:
-    setMatrixButtonLED(0, 1, LEDColor::black, 0.0f, false);
-    setMatrixButtonLED(1, 0, LEDColor::black, 0.0f, false);
-    std::this_thread::sleep_for(std::chrono::milliseconds(step_delay_ms));
-    
-    // Step 17: Final fade - corner dims
-    setMatrixButtonLED(0, 0, LEDColor::green, 0.5f, false);
-    std::this_thread::sleep_for(std::chrono::milliseconds(step_delay_ms));
+    // Second diagonal
+    {2, matrixTarget(2, 3), LEDColor::green, 64},
+    {2, matrixTarget(3, 2), LEDColor::green, 64},
+    {3, matrixTarget(2, 3), LEDColor::green, 127},
+    {3, matrixTarget(3, 2), LEDColor::green, 127},
 
-    // Step 18: Final fade - all dims
-    setMatrixButtonLED(0, 0, LEDColor::black, 0.0f, false);
+    // Third diagonal, corner fades out
+    {4, matrixTarget(3, 3), LEDColor::green, 64},
+    {4, matrixTarget(1, 3), LEDColor::green, 64},
+    {4, matrixTarget(2, 2), LEDColor::green, 64},
+    {4, matrixTarget(3, 1), LEDColor::green, 64},
+    {5, matrixTarget(3, 3), LEDColor::black, 0},
+    {5, matrixTarget(1, 3), LEDColor::green, 127},
+    {5, matrixTarget(2, 2), LEDColor::green, 127},
+    {5, matrixTarget(3, 1), LEDColor::green, 127},
 
-    // =============================================================================
-    // FINAL STATE: Turn on all LEDs at specified brightness
-    // =============================================================================
-    
-    std::cout << "  - Animation complete, setting final LED state..." << std::endl;
-    
-    // Set all button LEDs
+    // Fourth diagonal (main diagonal)
+    {6, matrixTarget(2, 3), LEDColor::green, 64},
+    {6, matrixTarget(3, 2), LEDColor::green, 64},
+    {6, matrixTarget(0, 3), LEDColor::green, 64},
+    {6, matrixTarget(1, 2), LEDColor::green, 64},
+    {6, matrixTarget(2, 1), LEDColor::green, 64},
+    {6, matrixTarget(3, 0), LEDColor::green, 64},
+    {7, matrixTarget(2, 3), LEDColor::black, 0},
+    {7, matrixTarget(3, 2), LEDColor::black, 0},
+    {7, matrixTarget(0, 3), LEDColor::green, 127},
+    {7, matrixTarget(1, 2), LEDColor::green, 127},
+    {7, matrixTarget(2, 1), LEDColor::green, 127},
+    {7, matrixTarget(3, 0), LEDColor::green, 127},
+
+    // Fifth diagonal
+    {8, matrixTarget(1, 3), LEDColor::green, 64},
+    {8, matrixTarget(2, 2), LEDColor::green, 64},
+    {8, matrixTarget(3, 1), LEDColor::green, 64},
+    {8, matrixTarget(0, 2), LEDColor::green, 64},
+    {8, matrixTarget(1, 1), LEDColor::green, 64},
+    {8, matrixTarget(2, 0), LEDColor::green, 64},
+    {9, matrixTarget(1, 3), LEDColor::black, 0},
+    {9, matrixTarget(2, 2), LEDColor::black, 0},
+    {9, matrixTarget(3, 1), LEDColor::black, 0},
+    {9, matrixTarget(0, 2), LEDColor::green, 127},
+    {9, matrixTarget(1, 1), LEDColor::green, 127},
+    {9, matrixTarget(2, 0), LEDColor::green, 127},
+
+    // Sixth diagonal
+    {10, matrixTarget(0, 3), LEDColor::green, 64},
+    {10, matrixTarget(1, 2), LEDColor::green, 64},
+    {10, matrixTarget(2, 1), LEDColor::green, 64},
+    {10, matrixTarget(3, 0), LEDColor::green, 64},
+    {10, matrixTarget(0, 1), LEDColor::green, 64},
+    {10, matrixTarget(1, 0), LEDColor::green, 64},
+    {11, matrixTarget(0, 3), LEDColor::black, 0},
+    {11, matrixTarget(1, 2), LEDColor::black, 0},
+    {11, matrixTarget(2, 1), LEDColor::black, 0},
+    {11, matrixTarget(3, 0), LEDColor::black, 0},
+    {11, matrixTarget(0, 1), LEDColor::green, 127},
+    {11, matrixTarget(1, 0), LEDColor::green, 127},
+
+    // Seventh diagonal (top-left corner)
+    {12, matrixTarget(0, 2), LEDColor::green, 64},
+    {12, matrixTarget(1, 1), LEDColor::green, 64},
+    {12, matrixTarget(2, 0), LEDColor::green, 64},
+    {12, matrixTarget(0, 0), LEDColor::green, 64},
+    {13, matrixTarget(0, 2), LEDColor::black, 0},
+    {13, matrixTarget(1, 1), LEDColor::black, 0},
+    {13, matrixTarget(2, 0), LEDColor::black, 0},
+    {13, matrixTarget(0, 0), LEDColor::green, 127},
+
+    // Wave fade out
+    {14, matrixTarget(0, 1), LEDColor::green, 64},
+    {14, matrixTarget(1, 0), LEDColor::green, 64},
+    {15, matrixTarget(0, 1), LEDColor::black, 0},
+    {15, matrixTarget(1, 0), LEDColor::black, 0},
+    {16, matrixTarget(0, 0), LEDColor::green, 64},
+    {17, matrixTarget(0, 0), LEDColor::black, 0},
+};
+
+/*
+* Builds the startup wave as a keyframe animation for LEDAnimationEngine
+*
+* @param tick_ms: Tick length of the engine that will play it, steps are
+*                 rounded to the nearest whole number of ticks (at least one)
+* @return: Keyframe animation, played once
+*/
+LEDAnimation makeStartupAnimation(int tick_ms) {
+    LEDAnimation animation;
+    animation.type = LEDAnimationType::KEYFRAMES;
+    animation.keyframes.assign(std::begin(STARTUP_KEYFRAMES), std::end(STARTUP_KEYFRAMES));
+    animation.period_ticks = tick_ms > 0 ? std::max(1, (STARTUP_STEP_MS + tick_ms / 2) / tick_ms) : 1;
+    animation.repeat = 1;
+    return animation;
+}
+
+/*
+* Sets the button LEDs to their state after the startup wave
+* These are stored, so they can be restored later
+*/
+void applyStartupFinalState() {
     setButtonLED(LEDButton::BROWSE, 0.5f, true);
     setButtonLED(LEDButton::SIZE, 0.0f, true);
     setButtonLED(LEDButton::TYPE, 0.0f, true);
@@ -202,6 +131,53 @@ void startupSequence(hid_device* device) {
     setButtonLED(LEDButton::CAPTURE, 0.0f, true);
     setButtonLED(LEDButton::QUANT, 0.0f, true);
     setButtonLED(LEDButton::SYNC, 0.0f, true);
- 
+}
+
+// =============================================================================
+// START UP SEQUENCE
+// =============================================================================
+
+/*
+* Plays the startup wave on an animation engine and waits until it is done
+* Each animation step is flushed as one LED report
+*
+* @param engine: Running animation engine
+*/
+void playStartupSequence(LEDAnimationEngine& engine) {
+    // Step 1: Start the animation
+    std::cout << "  - Running startup LED sequence..." << std::endl;
+    int id = engine.play(makeStartupAnimation(engine.getTickMs()));
+
+    // Step 2: Wait for the engine to play it
+    while (engine.isPlaying(id)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(engine.getTickMs()));
+    }
+
+    // Step 3: Set the final button state
+    std::cout << "  - Animation complete, setting final LED state..." << std::endl;
+    applyStartupFinalState();
+    flushLEDReport();
+
     std::cout << "  - Startup sequence completed!" << std::endl;
 }
+
+/*
+* Runs the startup wave without an animation engine of the caller
+* Blocks until the animation is complete
+*
+* @param device: Pointer to the opened HID device
+*/
+void startupSequence(hid_device* device) {
+    
+    // Step 1: Check if device is valid
+    if (device == nullptr) {
+        std::cerr << "Error: Invalid device handle for startup sequence" << std::endl;
+        return;
+    }
+
+    // Step 2: Play it on a temporary engine
+    LEDAnimationEngine engine;
+    engine.start();
+    playStartupSequence(engine);
+    engine.stop();
+}